@@ -0,0 +1,37 @@
+#ifndef ALLOC_H
+#define ALLOC_H
+
+#include <stddef.h>
+
+// ====================================================
+// Buffer Allocation
+// ====================================================
+
+// Tensor data, gradients and GEMM workspaces come from here. Buffers are
+// 64-byte aligned. Those of at least huge_threshold bytes are mapped on huge
+// page boundaries and advised for transparent huge pages, or taken from the
+// reserved huge page pool when use_hugetlb is set. Each step falls back to
+// the next, ending at the regular heap.
+typedef struct BufferConfig {
+    size_t huge_threshold;  // bytes, 0 disables huge pages
+    int use_hugetlb;        // try MAP_HUGETLB first
+} BufferConfig;
+
+// Defaults come from BASEDNN_HUGEPAGE_THRESHOLD (bytes) and BASEDNN_HUGETLB
+BufferConfig buffer_config(void);
+void buffer_configure(BufferConfig config);
+
+void* buffer_alloc(size_t bytes);
+void* buffer_calloc(size_t count, size_t size);
+// Accepts any pointer from buffer_alloc/buffer_calloc or malloc
+void buffer_free(void *ptr);
+
+typedef struct BufferStats {
+    size_t huge_buffers;    // live buffers on huge page mappings
+    size_t hugetlb_buffers; // of which from the reserved pool
+    size_t mapped_bytes;
+} BufferStats;
+
+BufferStats buffer_stats(void);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef ASYNC_H
+#define ASYNC_H
+
+#include "network.h"
+
+// ====================================================
+// Asynchronous Execution
+// ====================================================
+
+// Forward passes and train steps can be queued on the library's executor
+// thread instead of run on the caller. Queued work runs one item at a time in
+// submission order, so several submissions against the same network never
+// overlap; each item still spreads its kernels over the default thread pool.
+// Inputs, targets, the network and the optimizer must stay alive and
+// unmodified until the future completes.
+
+typedef struct Future Future;
+
+typedef void (*FutureCallback)(Future *future, void *user_data);
+
+// Returns NULL if the work could not be queued
+Future* network_forward_async(Network *net, Tensor *input);
+Future* network_train_step_async(Network *net, Tensor *input, Tensor *target, Optimizer *opt, const char *loss_name);
+
+// 1 once the result is available, without blocking
+int future_poll(Future *future);
+void future_wait(Future *future);
+
+// Runs callback once the result is available: on the executor thread, or
+// on the caller right away if it already is. One callback per future. The
+// callback may read the result and submit more work, but must not free its
+// future or wait on one queued behind it.
+void future_then(Future *future, FutureCallback callback, void *user_data);
+
+// Wait and return the result. The forward output belongs to the caller, as
+// with network_forward, and is NULL if the pass failed.
+Tensor* future_tensor(Future *future);
+float future_loss(Future *future);
+
+// Waits for the work and its callback, then frees the future
+void future_free(Future *future);
+
+// Finishes queued work and stops the executor thread. Called by basednn_cleanup().
+void async_cleanup(void);
+
+#endif
@@ -1,23 +1,38 @@
 #ifndef BASEDNN_H
 #define BASEDNN_H
 
+#include "alloc.h"
 #include "tensor.h"
 #include "ops.h"
 #include "registry.h"
 #include "layer.h"
 #include "network.h"
 #include "optimizer.h"
+#include "threadpool.h"
+#include "data.h"
+#include "plan.h"
+#include "numerics.h"
+#include "checkpoint.h"
+#include "async.h"
+#include "telemetry.h"
 
-// Initialize the registry with built-in layers, losses, and optimizers
-// Call this once at the start of your program
+// Initialize the registry, apply the numerics mode (see numerics.h) to the
+// calling thread and start telemetry if configured. Built-in layers, losses,
+// and optimizers are constant tables, so this allocates nothing. Call once at
+// program start
 static inline void basednn_init() {
     registry_init();
+    numerics_init();
+    telemetry_init();
 }
 
-// Cleanup registry resources
+// Cleanup registry resources and stop library threads
 // Call this at the end of your program
 static inline void basednn_cleanup() {
+    async_cleanup();
+    telemetry_stop();
     registry_cleanup();
+    threadpool_default_cleanup();
 }
 
 #endif
\ No newline at end of file
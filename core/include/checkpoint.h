@@ -0,0 +1,50 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include "network.h"
+
+// ====================================================
+// Incremental Checkpoints
+// ====================================================
+
+// A checkpoint directory holds full model files (NNNNNNNN.base, written with
+// network_save) and between them delta files (NNNNNNNN.delta) that carry only
+// the parameter blocks that changed since the previous checkpoint. LATEST
+// names the newest base and checkpoint; it is replaced atomically after
+// every save, so readers never see a partial chain.
+
+typedef struct CheckpointConfig {
+    size_t block_size;      // floats per change-detection block
+    size_t full_interval;   // a full base every this many checkpoints
+    int compress;           // XOR changed blocks with their previous contents and run-length encode them
+} CheckpointConfig;
+
+#define CHECKPOINT_DEFAULTS() ((CheckpointConfig){ .block_size = 16384, .full_interval = 10, .compress = 1 })
+
+typedef struct Checkpointer {
+    char *dir;
+    CheckpointConfig config;
+    size_t sequence;         // last checkpoint written, 0 before the first
+    size_t base_sequence;    // base the current chain starts from
+    uint64_t layout;         // parameter shapes the block state belongs to
+    size_t num_blocks;
+    uint64_t *block_hashes;  // per-block hashes of the last checkpoint, NULL until a base is written
+    float *snapshot;         // parameters as of the last checkpoint, only kept when compressing
+    unsigned char *scratch;
+    size_t last_bytes;       // size of the file the last save wrote
+} Checkpointer;
+
+// Continues the sequence of an existing directory; its first save is always a base
+Checkpointer* checkpointer_create(const char *dir, CheckpointConfig config);
+void checkpointer_free(Checkpointer *ckpt);
+
+// Writes the next checkpoint of net: a base every full_interval checkpoints or
+// whenever the parameter shapes change, otherwise a delta. Returns 0 on failure.
+int checkpoint_save(Checkpointer *ckpt, Network *net);
+
+// Reconstructs the newest checkpoint in dir from its base and deltas.
+// Every delta block is verified against its recorded hash.
+Network* checkpoint_load_latest(const char *dir);
+
+#endif
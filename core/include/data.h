@@ -0,0 +1,80 @@
+#ifndef DATA_H
+#define DATA_H
+
+#include "tensor.h"
+#include <stdint.h>
+
+// ====================================================
+// CSV Loading
+// ====================================================
+
+typedef enum LabelEncoding {
+    LABEL_INDEX,
+    LABEL_ONE_HOT
+} LabelEncoding;
+
+typedef struct CSVConfig {
+    char delimiter;                 // defaults to ',' when 0
+    int has_header;
+    const size_t *label_columns;    // columns moved into the label tensor
+    size_t num_label_columns;
+    LabelEncoding encoding;
+    size_t num_classes;             // required for LABEL_ONE_HOT
+} CSVConfig;
+
+#define CSV() (CSVConfig){ .delimiter = ',', .has_header = 0, .label_columns = NULL, .num_label_columns = 0, .encoding = LABEL_INDEX, .num_classes = 0 }
+#define CSV_LABELED(header, label_col, n_classes) (CSVConfig){ .delimiter = ',', .has_header = header, .label_columns = (size_t[]){ label_col }, .num_label_columns = 1, .encoding = (n_classes) > 0 ? LABEL_ONE_HOT : LABEL_INDEX, .num_classes = n_classes }
+
+// Parses the file in parallel into a [rows, features] tensor. When label
+// columns are selected, *labels receives [rows, num_label_columns] (index
+// encoding) or [rows, num_classes] (one-hot). Returns NULL on error.
+Tensor* tensor_load_csv(const char *file_path, CSVConfig config, Tensor **labels);
+
+// ====================================================
+// Image Augmentation Pipeline
+// ====================================================
+
+#define AUGMENT_MAX_CHANNELS 4
+
+typedef struct ImageDataset {
+    const uint8_t *pixels;      // [num_samples, channels, height, width]
+    size_t num_samples;
+    size_t channels;
+    size_t height;
+    size_t width;
+    Tensor *labels;             // [num_samples, ...], gathered per batch
+} ImageDataset;
+
+typedef struct AugmentConfig {
+    size_t crop_h;              // output size, 0 keeps the input size
+    size_t crop_w;
+    size_t max_shift;           // random translation in pixels, zero filled
+    int random_flip;            // horizontal flip with probability 0.5
+    float mean[AUGMENT_MAX_CHANNELS];   // per channel, in [0, 1] pixel units
+    float std[AUGMENT_MAX_CHANNELS];    // per channel, 0 is treated as 1
+} AugmentConfig;
+
+typedef struct DataLoaderConfig {
+    size_t batch_size;
+    size_t num_workers;
+    size_t prefetch;            // batches prepared ahead of the consumer
+    int shuffle;
+    unsigned int seed;
+} DataLoaderConfig;
+
+#define AUGMENT_NONE() (AugmentConfig){ 0, 0, 0, 0, {0}, {0} }
+#define AUGMENT(crop_h, crop_w, shift, flip) (AugmentConfig){ crop_h, crop_w, shift, flip, {0}, {0} }
+#define DATALOADER(batch, workers, prefetch, shuffle, seed) (DataLoaderConfig){ batch, workers, prefetch, shuffle, seed }
+
+typedef struct DataLoader DataLoader;
+
+DataLoader* dataloader_create(ImageDataset dataset, AugmentConfig augment, DataLoaderConfig config);
+void dataloader_free(DataLoader *loader);
+
+// Hands out the next prepared batch. The tensors belong to the loader and
+// stay valid until the following call. Returns 0 at the end of an epoch,
+// after which the next epoch is reshuffled and starts prefetching.
+int dataloader_next(DataLoader *loader, Tensor **inputs, Tensor **targets);
+size_t dataloader_num_batches(DataLoader *loader);
+
+#endif
@@ -0,0 +1,131 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ====================================================
+// CPU Features
+// ====================================================
+
+#define CPU_FEATURE_SSE2    (1u << 0)
+#define CPU_FEATURE_SSE42   (1u << 1)
+#define CPU_FEATURE_AVX     (1u << 2)
+#define CPU_FEATURE_AVX2    (1u << 3)
+#define CPU_FEATURE_FMA     (1u << 4)
+#define CPU_FEATURE_AVX512F (1u << 5)
+
+// Bitmask of CPU_FEATURE_* flags detected at runtime
+uint32_t kernels_cpu_features(void);
+
+// ====================================================
+// Transpose
+// ====================================================
+
+// dst [cols, rows] = src [rows, cols]^T, or dst += src^T for the _add form.
+// The matrix is split recursively until tiles fit in cache, and tiles are
+// transposed 8x8 in registers. Large matrices are split across the default
+// thread pool. src and dst must not overlap.
+void matrix_transpose(size_t rows, size_t cols, const float *src, size_t lds, float *dst, size_t ldd);
+void matrix_transpose_add(size_t rows, size_t cols, const float *src, size_t lds, float *dst, size_t ldd);
+
+// ====================================================
+// Elementwise
+// ====================================================
+
+// out[i] = exp(in[i]) with a Cephes-style polynomial, within 2 ulp of expf
+// on [-87.3, 88]; 0 below and saturating above. out may alias in.
+void vec_expf(float *out, const float *in, size_t n);
+
+// dst = a + b, a - b, a * b, and dst += a * b over n contiguous floats.
+// dst may alias a or b. Large arrays are split across the default thread pool.
+void vec_add(float *dst, const float *a, const float *b, size_t n);
+void vec_sub(float *dst, const float *a, const float *b, size_t n);
+void vec_mul(float *dst, const float *a, const float *b, size_t n);
+void vec_fma(float *dst, const float *a, const float *b, size_t n);
+
+// Row broadcast over a [rows, cols]: dst[i, j] = a[i, j] + row[j]
+void vec_add_rows(float *dst, const float *a, const float *row, size_t rows, size_t cols);
+// Column sums, accumulated: dst[j] += sum over i of a[i, j]
+void vec_sum_rows(float *dst, const float *a, size_t rows, size_t cols);
+
+// ====================================================
+// Checksums
+// ====================================================
+
+// CRC-32C (Castagnoli) of data, continuing from crc; pass 0 to start.
+// Uses the SSE4.2 crc32 instruction when available.
+uint32_t crc32c(uint32_t crc, const void *data, size_t len);
+
+// ====================================================
+// GEMM
+// ====================================================
+
+// Row-major C = alpha * op(A) * op(B) + beta * C where op(X) is X or X^T.
+// op(A) is M x K, op(B) is K x N. Large products are split across the
+// default thread pool.
+void sgemm(int trans_a, int trans_b, size_t M, size_t N, size_t K,
+           float alpha, const float *A, size_t lda,
+           const float *B, size_t ldb,
+           float beta, float *C, size_t ldc);
+
+// Cache blocking of the packed GEMM: mc rows of A, kc depth, nc columns of B
+typedef struct GemmBlocking {
+    size_t mc;
+    size_t kc;
+    size_t nc;
+} GemmBlocking;
+
+GemmBlocking gemm_default_blocking(void);
+
+// sgemm with explicit cache blocking; NULL uses gemm_default_blocking()
+void sgemm_blocked(int trans_a, int trans_b, size_t M, size_t N, size_t K,
+                   float alpha, const float *A, size_t lda,
+                   const float *B, size_t ldb,
+                   float beta, float *C, size_t ldc,
+                   const GemmBlocking *blocking);
+
+// ====================================================
+// GEMV
+// ====================================================
+
+// sgemm handles products with at most this many rows of op(A) and an
+// untransposed B as matrix-vector products: B is streamed once, row by row,
+// into register accumulators for every output row, with column blocks split
+// across the default thread pool.
+#define GEMV_MAX_ROWS 4
+
+// y = alpha * op(A) * x + beta * y with A row-major M x N. trans = 1 gives
+// the y[N] = x[M] * A form of a batch-1 linear layer.
+void sgemv(int trans, size_t M, size_t N, float alpha, const float *A, size_t lda,
+           const float *x, float beta, float *y);
+
+// ====================================================
+// Prepacked Operands
+// ====================================================
+
+// op(B) [K, N] stored in the micro-kernel layout: for each depth block of
+// kc rows, zero-padded column panels of nr floats. Only valid for kernels
+// with the same panel width, see gemm_panel_width().
+typedef struct PackedMatrix {
+    size_t K;
+    size_t N;
+    size_t kc;
+    size_t nr;
+    size_t size;    // floats in data
+    float *data;
+} PackedMatrix;
+
+size_t gemm_panel_width(void);
+
+PackedMatrix* sgemm_pack_b(int trans_b, size_t K, size_t N, const float *B, size_t ldb, size_t kc);
+PackedMatrix* packed_matrix_alloc(size_t K, size_t N, size_t kc);
+void packed_matrix_free(PackedMatrix *P);
+
+// C = alpha * op(A) * B + beta * C with B already packed; skips all B packing.
+// blocking->kc is ignored in favour of the depth B was packed with.
+void sgemm_packed(int trans_a, size_t M, float alpha, const float *A, size_t lda,
+                  const PackedMatrix *B, float beta, float *C, size_t ldc,
+                  const GemmBlocking *blocking);
+
+#endif
@@ -5,12 +5,15 @@
 #include "layer.h"
 #include "optimizer.h"
 
+struct NetworkPlan;
+
 typedef struct Network {
     Layer **layers;
     Tensor **parameters;
     size_t num_layers;
     size_t num_parameters;
     size_t capacity;
+    struct NetworkPlan *plan;   // optional, see plan.h
 } Network; 
 
 // Network management
@@ -21,6 +24,27 @@ void network_free(Network *net);
 // Forward pass 
 Tensor* network_forward(Network *net, Tensor *input);
 
+// Execution contexts let several threads run inference on one network at
+// once. They only read the shared weights and plan, so the network must not
+// be trained, modified or freed while a context is running on it.
+typedef struct ExecContext {
+    Network *net;
+    Tensor *output;     // result of the last pass
+} ExecContext;
+
+ExecContext* exec_context_create(Network *net);
+void exec_context_free(ExecContext *ctx);
+// Runs input through the network on the calling thread without recording
+// gradients. Intermediates are freed as soon as the next layer has read
+// them; the result belongs to the context and stays valid until its next pass.
+Tensor* exec_context_forward(ExecContext *ctx, Tensor *input);
+
+// Inference for variable batch sizes under bucketed plans, see
+// network_plan_cached_buckets(). Each planned layer runs the bucket holding
+// its input rows; the input is not padded, so the result is exactly that of
+// network_forward(). Gradients are not recorded; the caller frees the result.
+Tensor* network_forward_bucketed(Network *net, Tensor *input);
+
 // Training
 void network_train(Network *net, Optimizer *opt, Tensor *inputs, Tensor *targets, size_t epochs, size_t batch_size, const char *loss_name, int verbose);
 float network_train_step(Network *net, Tensor *input, Tensor *target, Optimizer *opt, const char *loss_name);
@@ -31,8 +55,21 @@ void network_print(Network *net);
 Tensor** network_get_parameters(Network *net, size_t *num_params);
 float network_accuracy(Tensor *predictions, Tensor *targets);
 
-// Save/load network
-void network_save(Network *net, const char *file_path);
+// Save/load network. Parameter data is checksummed and transferred in
+// parallel; network_save returns 0 if anything failed to write.
+int network_save(Network *net, const char *file_path);
 Network* network_load(const char *file_path);
 
+// Streaming load: layers are read on a background thread, so inference of
+// early layers can start before the whole file is in memory.
+typedef struct NetworkStream NetworkStream;
+
+NetworkStream* network_stream_open(const char *file_path);
+// Runs input through every layer, waiting for each one to finish loading.
+// Layers are not trainable until the stream is finished.
+Tensor* network_stream_forward(NetworkStream *stream, Tensor *input);
+// Waits for the remaining layers and returns the network, or NULL if any
+// failed to load. Frees the stream.
+Network* network_stream_finish(NetworkStream *stream);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef NUMERICS_H
+#define NUMERICS_H
+
+// ====================================================
+// Numerics Mode
+// ====================================================
+
+typedef struct NumericsConfig {
+    int flush_denormals;    // flush-to-zero and denormals-are-zero
+    int fast_math;          // vectorized polynomial exp in sigmoid and softmax
+} NumericsConfig;
+
+#define NUMERICS_DEFAULTS() ((NumericsConfig){ .flush_denormals = 1, .fast_math = 0 })
+
+// Reads BASEDNN_FLUSH_DENORMALS and BASEDNN_FAST_MATH over the defaults and
+// applies them to the calling thread. Called by basednn_init(), so the thread
+// that initializes the library keeps the mode until it changes it.
+void numerics_init(void);
+
+// Changes the mode for every library thread: the caller immediately, thread
+// pool and loader threads before their next piece of work.
+void numerics_configure(NumericsConfig config);
+NumericsConfig numerics_config(void);
+
+// Applies the current mode to the calling thread if it changed since the
+// thread last did so. Only threads the library owns call this.
+void numerics_sync_thread(void);
+
+// Applies the current mode to a caller's thread for the duration of a call
+// and returns the floating-point control state to hand back to
+// numerics_leave(), which restores it.
+typedef unsigned long long NumericsState;
+NumericsState numerics_enter(void);
+void numerics_leave(NumericsState saved);
+
+// Whether denormal flushing is active on the calling thread
+int numerics_thread_flushes_denormals(void);
+
+#endif
@@ -23,6 +23,18 @@ void backward_mul(Tensor *C);
 Tensor* tensor_matmul(Tensor *A, Tensor *B);
 void backward_matmul(Tensor *C);
 
+// Fused X * W + b for X [M, K] or [K], W [K, N] and b [N]. blocking selects
+// the GEMM cache blocking, or NULL for the default.
+struct GemmBlocking;
+struct PackedMatrix;
+Tensor* tensor_linear(Tensor *X, Tensor *W, Tensor *b, const struct GemmBlocking *blocking);
+
+// Same as tensor_linear but multiplies by W_packed, a prepacked copy of W.
+// W is still used for the backward pass.
+Tensor* tensor_linear_packed(Tensor *X, Tensor *W, Tensor *b, const struct PackedMatrix *W_packed,
+                             const struct GemmBlocking *blocking);
+void backward_linear(Tensor *Z);
+
 Tensor* tensor_transpose2d(Tensor *A);
 void backward_transpose2d(Tensor *C);
 
@@ -55,6 +67,12 @@ void backward_cross_entropy(Tensor *L);
 Tensor* tensor_binary_cross_entropy(Tensor *predictions, Tensor *targets);
 void backward_binary_cross_entropy(Tensor *L);
 
+// Binary cross-entropy of sigmoid(logits) in one stable pass, with the
+// gradient sigmoid(logits) - targets. network_train uses it in place of a
+// final sigmoid layer followed by binary_cross_entropy.
+Tensor* tensor_bce_with_logits(Tensor *logits, Tensor *targets);
+void backward_bce_with_logits(Tensor *L);
+
 // ====================================================
 // Slice
 // ====================================================
@@ -62,7 +80,4 @@ void backward_binary_cross_entropy(Tensor *L);
 // Slice
 Tensor* tensor_slice(Tensor *input, size_t start, size_t end);
 
-// Registration
-void ops_register_builtins(void);
-
 #endif
\ No newline at end of file
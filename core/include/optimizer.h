@@ -44,7 +44,4 @@ void optimizer_step(Optimizer *opt);
 void optimizer_zero_grad(Optimizer *opt);
 void optimizer_free(Optimizer *opt); 
 
-// Registration
-void optimizer_register_builtins(void);
-
 #endif
\ No newline at end of file
@@ -0,0 +1,93 @@
+#ifndef PLAN_H
+#define PLAN_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "network.h"
+#include "kernels.h"
+
+// ====================================================
+// Network Plans
+// ====================================================
+
+typedef enum LayerPlanKind {
+    LAYER_PLAN_NONE = 0,
+    LAYER_PLAN_LINEAR = 1
+} LayerPlanKind;
+
+typedef struct LayerPlan {
+    LayerPlanKind kind;
+    GemmBlocking blocking;
+    PackedMatrix *packed_weights;   // weights in the micro-kernel layout, or NULL
+    int shared_packed;              // packed_weights belongs to a smaller bucket's plan
+    unsigned long weights_version;  // tensor_version() of the weights when packed
+} LayerPlan;
+
+typedef struct NetworkPlan {
+    uint64_t fingerprint;
+    uint32_t cpu_features;
+    size_t batch_size;
+    size_t num_layers;
+    LayerPlan *layers;
+    struct NetworkPlan *next;       // plan for the next larger batch bucket, or NULL
+} NetworkPlan;
+
+// Hash of layer names, parameter shapes and CPU features, which is all a
+// plan's kernel choices depend on. Weight values are not read, so it is cheap
+// and stays the same as a model is retrained.
+uint64_t network_fingerprint(Network *net);
+
+// Hash of every parameter value, for checking stored prepacked weights
+uint64_t network_weights_fingerprint(Network *net);
+
+// Chooses kernels for every supported layer by timing them at batch_size rows
+// and prepacks their weights. Training through network_train() drops the
+// plan. After any other update of the weights (see tensor_mark_modified())
+// the layer runs unpacked with the tuned blocking until repacked.
+NetworkPlan* network_plan_build(Network *net, size_t batch_size);
+// Frees plan and every larger bucket chained after it
+void network_plan_free(NetworkPlan *plan);
+
+// Packs net's current weights for every planned layer of plan (and the
+// buckets after it) that has none yet. Buckets tuned to the same kc share
+// one copy. Returns 0 if plan does not match net.
+int network_plan_pack(Network *net, NetworkPlan *plan);
+
+// Plan files hold the tuned blocking only; the weights they were tuned
+// with may have changed since, so loaded plans need network_plan_pack()
+int network_plan_save(NetworkPlan *plan, const char *file_path);
+NetworkPlan* network_plan_load(const char *file_path);
+
+// Attaches plan to net, which takes ownership. Returns 0 if the layers do not match.
+int network_set_plan(Network *net, NetworkPlan *plan);
+
+// Loads net's plan from cache_dir, or builds it and stores it there, then
+// packs the current weights and attaches it. Plans are keyed by
+// network_fingerprint() and batch_size.
+int network_plan_cached(Network *net, const char *cache_dir, size_t batch_size);
+
+// ====================================================
+// Batch Buckets
+// ====================================================
+
+// Smallest power of two holding rows
+size_t plan_bucket(size_t rows);
+
+// Loads or builds a plan for every power-of-two batch up to the bucket of
+// max_batch and attaches them as one chain. Buckets share prepacked weights
+// whenever their tuned kc agrees. Layers run through the smallest bucket
+// that holds their input rows, or the largest one if none does.
+int network_plan_cached_buckets(Network *net, const char *cache_dir, size_t max_batch);
+
+// Auxiliary model file section holding net's prepacked weights, see
+// network_save(). Only the first plan of a bucket chain is stored, with a
+// fingerprint of the weights, and stale panels are skipped. Reading attaches
+// a plan built from the stored panels; returns 0 if the section is absent,
+// or does not match net or its loaded weights.
+int network_plan_write_packed(Network *net, FILE *file);
+int network_plan_read_packed(Network *net, FILE *file);
+
+// Runs layer index of net through its plan; NULL if that layer is not planned
+Tensor* network_plan_forward_layer(Network *net, size_t index, Tensor *input);
+
+#endif
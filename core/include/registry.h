@@ -55,10 +55,53 @@ OptimizerInitStateFn get_optimizer_init_state_fn(const char *name);
 OptimizerStepFn get_optimizer_step_fn(const char *name);
 OptimizerFreeStateFn get_optimizer_free_state_fn(const char *name);
 
+// ====================================================
+// Builtin Tables
+// ====================================================
+
+// Builtins live in constant tables sorted by name, defined next to their
+// implementations. Lookups check runtime registrations first, so plugins can
+// still override a builtin, then binary search these tables.
+
+typedef struct BuiltinLayer {
+    const char *name;
+    LayerCreateFn create_fn;
+    LayerForwardFn forward_fn;
+} BuiltinLayer;
+
+typedef struct BuiltinOperation {
+    const char *name;
+    OpFn op_fn;
+} BuiltinOperation;
+
+typedef struct BuiltinTensorOp {
+    const char *name;
+    BackwardFn backward_fn;
+} BuiltinTensorOp;
+
+typedef struct BuiltinOptimizer {
+    const char *name;
+    OptimizerInitStateFn init_state_fn;
+    OptimizerStepFn step_fn;
+    OptimizerFreeStateFn free_state_fn;
+} BuiltinOptimizer;
+
+extern const BuiltinLayer builtin_layers[];
+extern const size_t num_builtin_layers;
+extern const BuiltinOperation builtin_operations[];
+extern const size_t num_builtin_operations;
+extern const BuiltinTensorOp builtin_tensor_ops[];
+extern const size_t num_builtin_tensor_ops;
+extern const BuiltinOptimizer builtin_optimizers[];
+extern const size_t num_builtin_optimizers;
+
 // ====================================================
 // Registry Initialization
 // ====================================================
 
+// Lookups are lock-free and may run concurrently with registrations.
+// registry_cleanup() must not race with any other registry call.
+
 void registry_init();
 void registry_cleanup();
 
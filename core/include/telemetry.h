@@ -0,0 +1,47 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stddef.h>
+
+// ====================================================
+// Telemetry
+// ====================================================
+
+// Training and runtime metrics in the Prometheus text exposition format.
+// While telemetry runs, a background thread rewrites a file for the node
+// exporter's textfile collector, through a temporary file and a rename so
+// scrapes never see a partial snapshot. Recording only touches atomic
+// counters, so the training loop never waits on the writer.
+typedef struct TelemetryConfig {
+    const char *path;       // e.g. /var/lib/node_exporter/basednn.prom
+    unsigned interval_ms;   // how often the file is rewritten
+} TelemetryConfig;
+
+#define TELEMETRY_DEFAULTS(file) ((TelemetryConfig){ .path = (file), .interval_ms = 5000 })
+
+// Starts telemetry from BASEDNN_TELEMETRY_FILE and BASEDNN_TELEMETRY_INTERVAL_MS
+// when the former is set. Called by basednn_init().
+void telemetry_init(void);
+
+// Returns 0 if the writer thread could not be started. Restarting with a new
+// config keeps the metrics recorded so far.
+int telemetry_start(TelemetryConfig config);
+// Writes a final snapshot and stops the writer. Called by basednn_cleanup().
+void telemetry_stop(void);
+int telemetry_enabled(void);
+
+// Writes one snapshot now. Returns 0 on failure.
+int telemetry_write(const char *path);
+
+// ====================================================
+// Recording
+// ====================================================
+
+// Library code records these only while telemetry is enabled
+void telemetry_record_step(size_t samples, double seconds, float loss);
+// Time spent in one layer's forward pass or one op's backward
+void telemetry_record_op(const char *op, int backward, double seconds);
+
+double telemetry_now(void);
+
+#endif
@@ -19,6 +19,7 @@ struct Tensor {
     size_t num_inputs;
     void (*backward_fn)(Tensor *self);
     void *extra_data;
+    unsigned long version;      // in-place writes to data, see tensor_mark_modified()
 };
 
 // ====================================================
@@ -39,11 +40,22 @@ void tensor_set_requires_grad(Tensor *T, int requires_grad);
 void tensor_zero_grad(Tensor *T);
 void tensor_backward(Tensor *T);
 
+// Gradient recording, per thread and on by default. While it is off, ops
+// attach no graph and their results never require grad.
+void tensor_set_grad_enabled(int enabled);
+int tensor_grad_enabled(void);
+
 // ====================================================
 // Utilities
 // ====================================================
 
 void tensor_fill(Tensor *T, float value);
+
+// Counts an in-place write to T's data so copies derived from it, such as
+// prepacked weights, can tell they are stale. Optimizer steps and
+// tensor_fill() count themselves; call this after writing data directly.
+void tensor_mark_modified(Tensor *T);
+unsigned long tensor_version(Tensor *T);
 void tensor_print(Tensor *T);
 Tensor* tensor_copy(Tensor *T);
 
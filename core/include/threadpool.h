@@ -0,0 +1,62 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct ThreadPool ThreadPool;
+
+typedef void (*ParallelForFn)(void *ctx, size_t start, size_t end);
+
+// ====================================================
+// Thread Pool Creation and Destruction
+// ====================================================
+
+ThreadPool* threadpool_create(size_t num_threads);
+void threadpool_free(ThreadPool *pool);
+
+// Shared pool used by the library, sized from BASEDNN_NUM_THREADS or the
+// number of online CPUs. Created lazily on first use.
+ThreadPool* threadpool_default(void);
+void threadpool_default_cleanup(void);
+
+// ====================================================
+// Parallel Execution
+// ====================================================
+
+// Split [0, n) into chunks of at least `grain` items and run fn on them.
+// The calling thread participates; nested calls from a worker run serially.
+void threadpool_parallel_for(ThreadPool *pool, size_t n, size_t grain, ParallelForFn fn, void *ctx);
+
+size_t threadpool_num_threads(ThreadPool *pool);
+
+// ====================================================
+// Statistics
+// ====================================================
+
+// Thread 0 stands for every thread that calls threadpool_parallel_for, and
+// threads 1..num_threads-1 are the workers.
+typedef struct ThreadStats {
+    double busy_seconds;    // running chunks
+    double idle_seconds;    // waiting for work, workers only
+    uint64_t chunks;
+    uint64_t excess_chunks; // chunks taken beyond an even share of their region
+} ThreadStats;
+
+typedef struct ThreadPoolStats {
+    uint64_t parallel_regions;
+    uint64_t serial_regions;    // run inline: too small, nested, or no workers
+    uint64_t chunks;
+    uint64_t excess_chunks;
+    double busy_seconds;        // summed over threads
+    double idle_seconds;
+    double utilization;         // share of worker time spent busy
+    double mean_imbalance;      // busiest thread over mean thread time, per parallel region
+    double max_imbalance;
+} ThreadPoolStats;
+
+ThreadPoolStats threadpool_stats(ThreadPool *pool);
+ThreadStats threadpool_thread_stats(ThreadPool *pool, size_t thread);
+void threadpool_reset_stats(ThreadPool *pool);
+
+#endif
@@ -0,0 +1,191 @@
+#include "../include/alloc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
+#define DEFAULT_HUGE_THRESHOLD ((size_t)4 << 20)
+#define BUFFER_ALIGN 64
+
+typedef struct Mapping {
+    void *ptr;
+    size_t len;
+    int hugetlb;
+} Mapping;
+
+static BufferConfig config;
+static pthread_once_t config_once = PTHREAD_ONCE_INIT;
+
+// Live huge page mappings. Heap pointers are almost never huge page aligned,
+// so buffer_free only takes the lock for pointers that could be in here.
+static Mapping *mappings = NULL;
+static size_t num_mappings = 0;
+static size_t mappings_capacity = 0;
+static BufferStats stats;
+static pthread_mutex_t mappings_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// ====================================================
+// Configuration
+// ====================================================
+
+static void config_init(void) {
+    config.huge_threshold = DEFAULT_HUGE_THRESHOLD;
+    config.use_hugetlb = 0;
+
+    const char *env = getenv("BASEDNN_HUGEPAGE_THRESHOLD");
+    if (env) config.huge_threshold = (size_t)strtoull(env, NULL, 10);
+    env = getenv("BASEDNN_HUGETLB");
+    if (env) config.use_hugetlb = atoi(env) != 0;
+}
+
+BufferConfig buffer_config(void) {
+    pthread_once(&config_once, config_init);
+    BufferConfig current;
+    current.huge_threshold = __atomic_load_n(&config.huge_threshold, __ATOMIC_RELAXED);
+    current.use_hugetlb = __atomic_load_n(&config.use_hugetlb, __ATOMIC_RELAXED);
+    return current;
+}
+
+void buffer_configure(BufferConfig new_config) {
+    pthread_once(&config_once, config_init);
+    __atomic_store_n(&config.huge_threshold, new_config.huge_threshold, __ATOMIC_RELAXED);
+    __atomic_store_n(&config.use_hugetlb, new_config.use_hugetlb, __ATOMIC_RELAXED);
+}
+
+// ====================================================
+// Huge Page Mappings
+// ====================================================
+
+static int mapping_add(void *ptr, size_t len, int hugetlb) {
+    pthread_mutex_lock(&mappings_lock);
+    if (num_mappings == mappings_capacity) {
+        size_t capacity = mappings_capacity ? mappings_capacity * 2 : 16;
+        Mapping *grown = (Mapping *)realloc(mappings, capacity * sizeof(Mapping));
+        if (!grown) {
+            pthread_mutex_unlock(&mappings_lock);
+            return 0;
+        }
+        mappings = grown;
+        mappings_capacity = capacity;
+    }
+
+    mappings[num_mappings++] = (Mapping){ ptr, len, hugetlb };
+    stats.huge_buffers++;
+    stats.hugetlb_buffers += hugetlb;
+    stats.mapped_bytes += len;
+    pthread_mutex_unlock(&mappings_lock);
+    return 1;
+}
+
+// Removes ptr from the table; returns 0 if it was not mapped here
+static int mapping_remove(void *ptr, Mapping *out) {
+    pthread_mutex_lock(&mappings_lock);
+    for (size_t i = 0; i < num_mappings; i++) {
+        if (mappings[i].ptr != ptr) continue;
+
+        *out = mappings[i];
+        mappings[i] = mappings[--num_mappings];
+        stats.huge_buffers--;
+        stats.hugetlb_buffers -= out->hugetlb;
+        stats.mapped_bytes -= out->len;
+        pthread_mutex_unlock(&mappings_lock);
+        return 1;
+    }
+    pthread_mutex_unlock(&mappings_lock);
+    return 0;
+}
+
+// Maps len bytes (a multiple of HUGE_PAGE_SIZE) starting on a huge page boundary
+static void* map_huge(size_t len, int use_hugetlb, int *hugetlb) {
+#ifdef MAP_HUGETLB
+    if (use_hugetlb) {
+        void *p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            *hugetlb = 1;
+            return p;
+        }
+    }
+#else
+    (void)use_hugetlb;
+#endif
+
+    // Over-map by one huge page and trim, so transparent huge pages can back it
+    size_t span = len + HUGE_PAGE_SIZE;
+    char *raw = (char *)mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+
+    char *p = (char *)(((uintptr_t)raw + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1));
+    if (p > raw) munmap(raw, (size_t)(p - raw));
+    if (raw + span > p + len) munmap(p + len, (size_t)(raw + span - (p + len)));
+
+#ifdef MADV_HUGEPAGE
+    madvise(p, len, MADV_HUGEPAGE);
+#endif
+    *hugetlb = 0;
+    return p;
+}
+
+// ====================================================
+// Allocation
+// ====================================================
+
+static void* huge_alloc(size_t bytes) {
+    BufferConfig current = buffer_config();
+    if (current.huge_threshold == 0 || bytes < current.huge_threshold) return NULL;
+
+    size_t len = (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    int hugetlb = 0;
+    void *p = map_huge(len, current.use_hugetlb, &hugetlb);
+    if (!p) return NULL;
+
+    if (!mapping_add(p, len, hugetlb)) {
+        munmap(p, len);
+        return NULL;
+    }
+    return p;
+}
+
+static void* heap_alloc(size_t bytes) {
+    void *p;
+    if (posix_memalign(&p, BUFFER_ALIGN, bytes ? bytes : 1) != 0) return NULL;
+    return p;
+}
+
+void* buffer_alloc(size_t bytes) {
+    void *p = huge_alloc(bytes);
+    return p ? p : heap_alloc(bytes);
+}
+
+void* buffer_calloc(size_t count, size_t size) {
+    if (size && count > SIZE_MAX / size) return NULL;
+    size_t bytes = count * size;
+
+    // Fresh mappings are already zeroed
+    void *p = huge_alloc(bytes);
+    if (p) return p;
+
+    p = heap_alloc(bytes);
+    if (p) memset(p, 0, bytes);
+    return p;
+}
+
+void buffer_free(void *ptr) {
+    if (!ptr) return;
+
+    Mapping mapping;
+    if (((uintptr_t)ptr & (HUGE_PAGE_SIZE - 1)) == 0 && mapping_remove(ptr, &mapping)) {
+        munmap(mapping.ptr, mapping.len);
+        return;
+    }
+    free(ptr);
+}
+
+BufferStats buffer_stats(void) {
+    pthread_mutex_lock(&mappings_lock);
+    BufferStats current = stats;
+    pthread_mutex_unlock(&mappings_lock);
+    return current;
+}
@@ -0,0 +1,227 @@
+#include "../include/async.h"
+#include "../include/numerics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+enum { FUTURE_QUEUED, FUTURE_DONE, FUTURE_SETTLED };
+enum { TASK_FORWARD, TASK_TRAIN_STEP };
+
+struct Future {
+    int kind;
+    Network *net;
+    Tensor *input;
+    Tensor *target;
+    Optimizer *opt;
+    char *loss_name;
+
+    Tensor *output;
+    float loss;
+
+    int state;                  // guarded by executor.lock
+    FutureCallback callback;
+    void *user_data;
+    struct Future *next;
+};
+
+typedef struct Executor {
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;
+    pthread_cond_t done_cond;
+    pthread_t thread;
+    int running;
+    int shutdown;
+    Future *head;
+    Future *tail;
+} Executor;
+
+static Executor executor = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+    0, 0, 0, NULL, NULL
+};
+
+// ====================================================
+// Executor
+// ====================================================
+
+static void future_run(Future *future) {
+    switch (future->kind) {
+        case TASK_FORWARD:
+            future->output = network_forward(future->net, future->input);
+            break;
+        case TASK_TRAIN_STEP:
+            future->loss = network_train_step(future->net, future->input, future->target,
+                                              future->opt, future->loss_name);
+            break;
+    }
+}
+
+static void* executor_main(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&executor.lock);
+    for (;;) {
+        while (!executor.head && !executor.shutdown) {
+            pthread_cond_wait(&executor.work_cond, &executor.lock);
+        }
+        if (!executor.head) break;
+
+        Future *future = executor.head;
+        executor.head = future->next;
+        if (!executor.head) executor.tail = NULL;
+        pthread_mutex_unlock(&executor.lock);
+
+        numerics_sync_thread();
+        future_run(future);
+
+        // The callback sees a completed future but runs outside the lock, so
+        // it may query the future or submit more work
+        pthread_mutex_lock(&executor.lock);
+        __atomic_store_n(&future->state, FUTURE_DONE, __ATOMIC_RELEASE);
+        FutureCallback callback = future->callback;
+        pthread_cond_broadcast(&executor.done_cond);
+        pthread_mutex_unlock(&executor.lock);
+
+        if (callback) callback(future, future->user_data);
+
+        pthread_mutex_lock(&executor.lock);
+        __atomic_store_n(&future->state, FUTURE_SETTLED, __ATOMIC_RELEASE);
+        pthread_cond_broadcast(&executor.done_cond);
+    }
+    pthread_mutex_unlock(&executor.lock);
+    return NULL;
+}
+
+static Future* future_submit(Future *future) {
+    pthread_mutex_lock(&executor.lock);
+    if (!executor.running) {
+        executor.shutdown = 0;
+        if (pthread_create(&executor.thread, NULL, executor_main, NULL) != 0) {
+            pthread_mutex_unlock(&executor.lock);
+            fprintf(stderr, "Error: Failed to start executor thread\n");
+            free(future->loss_name);
+            free(future);
+            return NULL;
+        }
+        executor.running = 1;
+    }
+
+    future->state = FUTURE_QUEUED;
+    future->next = NULL;
+    if (executor.tail) {
+        executor.tail->next = future;
+    } else {
+        executor.head = future;
+    }
+    executor.tail = future;
+    pthread_cond_signal(&executor.work_cond);
+    pthread_mutex_unlock(&executor.lock);
+    return future;
+}
+
+void async_cleanup(void) {
+    pthread_mutex_lock(&executor.lock);
+    if (!executor.running) {
+        pthread_mutex_unlock(&executor.lock);
+        return;
+    }
+    executor.shutdown = 1;
+    pthread_cond_signal(&executor.work_cond);
+    pthread_mutex_unlock(&executor.lock);
+
+    pthread_join(executor.thread, NULL);
+
+    pthread_mutex_lock(&executor.lock);
+    executor.running = 0;
+    pthread_mutex_unlock(&executor.lock);
+}
+
+// ====================================================
+// Submission
+// ====================================================
+
+Future* network_forward_async(Network *net, Tensor *input) {
+    if (!net || !input) return NULL;
+
+    Future *future = (Future *)calloc(1, sizeof(Future));
+    if (!future) return NULL;
+
+    future->kind = TASK_FORWARD;
+    future->net = net;
+    future->input = input;
+    return future_submit(future);
+}
+
+Future* network_train_step_async(Network *net, Tensor *input, Tensor *target, Optimizer *opt, const char *loss_name) {
+    if (!net || !input || !target || !opt || !loss_name) return NULL;
+
+    Future *future = (Future *)calloc(1, sizeof(Future));
+    if (!future) return NULL;
+
+    future->kind = TASK_TRAIN_STEP;
+    future->net = net;
+    future->input = input;
+    future->target = target;
+    future->opt = opt;
+    future->loss_name = strdup(loss_name);
+    if (!future->loss_name) {
+        free(future);
+        return NULL;
+    }
+    return future_submit(future);
+}
+
+// ====================================================
+// Completion
+// ====================================================
+
+int future_poll(Future *future) {
+    if (!future) return 1;
+    return __atomic_load_n(&future->state, __ATOMIC_ACQUIRE) != FUTURE_QUEUED;
+}
+
+static void future_wait_state(Future *future, int state) {
+    pthread_mutex_lock(&executor.lock);
+    while (future->state < state) {
+        pthread_cond_wait(&executor.done_cond, &executor.lock);
+    }
+    pthread_mutex_unlock(&executor.lock);
+}
+
+void future_wait(Future *future) {
+    if (future) future_wait_state(future, FUTURE_DONE);
+}
+
+void future_then(Future *future, FutureCallback callback, void *user_data) {
+    if (!future || !callback) return;
+
+    pthread_mutex_lock(&executor.lock);
+    int done = future->state != FUTURE_QUEUED;
+    if (!done) {
+        future->callback = callback;
+        future->user_data = user_data;
+    }
+    pthread_mutex_unlock(&executor.lock);
+
+    if (done) callback(future, user_data);
+}
+
+Tensor* future_tensor(Future *future) {
+    if (!future) return NULL;
+    future_wait(future);
+    return future->output;
+}
+
+float future_loss(Future *future) {
+    if (!future) return 0.0f;
+    future_wait(future);
+    return future->loss;
+}
+
+void future_free(Future *future) {
+    if (!future) return;
+    future_wait_state(future, FUTURE_SETTLED);
+    free(future->loss_name);
+    free(future);
+}
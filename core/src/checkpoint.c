@@ -0,0 +1,471 @@
+#include "../include/checkpoint.h"
+#include "../include/plan.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#define DELTA_MAGIC 0x4B434442 // "BDCK"
+#define DELTA_VERSION 1
+#define MANIFEST_NAME "LATEST"
+
+enum { BLOCK_RAW = 0, BLOCK_XOR_RLE = 1 };
+
+typedef struct DeltaHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sequence;
+    uint64_t base_sequence;
+    uint64_t layout;
+    uint64_t block_size;
+    uint64_t num_records;
+} DeltaHeader;
+
+typedef struct DeltaRecord {
+    uint32_t param;
+    uint32_t encoding;
+    uint64_t offset;        // first float of the block within the parameter
+    uint64_t count;
+    uint64_t hash;          // of the block's new contents
+    uint64_t payload_bytes;
+} DeltaRecord;
+
+// ====================================================
+// Hashing
+// ====================================================
+
+static inline uint64_t hash_mix(uint64_t h, uint64_t w) {
+    h ^= w * 0x9E3779B97F4A7C15ULL;
+    h = (h << 31) | (h >> 33);
+    return h * 0x87C37B91114253D5ULL;
+}
+
+static uint64_t hash_floats(const float *data, size_t count) {
+    const unsigned char *p = (const unsigned char *)data;
+    size_t len = count * sizeof(float), words = len / 8;
+    uint64_t h = 0xCBF29CE484222325ULL;
+
+    for (size_t i = 0; i < words; i++) {
+        uint64_t w;
+        memcpy(&w, p + i * 8, 8);
+        h = hash_mix(h, w);
+    }
+
+    uint64_t tail = 0;
+    memcpy(&tail, p + words * 8, len - words * 8);
+    return hash_mix(h, tail ^ ((uint64_t)len << 56));
+}
+
+static uint64_t layout_hash(Network *net) {
+    uint64_t h = hash_mix(0xCBF29CE484222325ULL, net->num_parameters);
+    for (size_t i = 0; i < net->num_parameters; i++) {
+        Tensor *param = net->parameters[i];
+        h = hash_mix(h, param->ndim);
+        for (size_t d = 0; d < param->ndim; d++) h = hash_mix(h, param->shape[d]);
+    }
+    return h;
+}
+
+static size_t blocks_in(size_t size, size_t block_size) {
+    return (size + block_size - 1) / block_size;
+}
+
+// ====================================================
+// Block Encoding
+// ====================================================
+
+// Small parameter updates leave the sign, exponent and high mantissa bits
+// alone, so the XOR of old and new values is mostly zero bytes. Grouping
+// byte k of every float together turns those into long zero runs.
+static void xor_shuffle(const float *now, const float *before, size_t count, unsigned char *out) {
+    const unsigned char *a = (const unsigned char *)now;
+    const unsigned char *b = (const unsigned char *)before;
+    for (size_t i = 0; i < count; i++) {
+        for (size_t k = 0; k < sizeof(float); k++) {
+            out[k * count + i] = a[i * sizeof(float) + k] ^ b[i * sizeof(float) + k];
+        }
+    }
+}
+
+static void unshuffle_xor(const unsigned char *in, size_t count, float *data) {
+    unsigned char *d = (unsigned char *)data;
+    for (size_t i = 0; i < count; i++) {
+        for (size_t k = 0; k < sizeof(float); k++) {
+            d[i * sizeof(float) + k] ^= in[k * count + i];
+        }
+    }
+}
+
+// Control byte c < 0x80 is followed by c + 1 literal bytes, c >= 0x80 stands
+// for (c & 0x7F) + 1 zero bytes. Returns 0 if the output would not be smaller
+// than limit.
+static size_t rle_encode(const unsigned char *in, size_t len, unsigned char *out, size_t limit) {
+    size_t i = 0, o = 0;
+
+    while (i < len) {
+        size_t run = 0;
+        while (i + run < len && in[i + run] == 0 && run < 128) run++;
+
+        if (run >= 2) {
+            if (o + 1 >= limit) return 0;
+            out[o++] = (unsigned char)(0x80 | (run - 1));
+            i += run;
+            continue;
+        }
+
+        // Literal up to the next zero pair
+        size_t lit = 0;
+        while (i + lit < len && lit < 128 &&
+               !(in[i + lit] == 0 && i + lit + 1 < len && in[i + lit + 1] == 0)) {
+            lit++;
+        }
+        if (lit == 0) lit = 1;
+        if (o + 1 + lit >= limit) return 0;
+        out[o++] = (unsigned char)(lit - 1);
+        memcpy(out + o, in + i, lit);
+        o += lit;
+        i += lit;
+    }
+
+    return o;
+}
+
+static int rle_decode(const unsigned char *in, size_t len, unsigned char *out, size_t expected) {
+    size_t i = 0, o = 0;
+
+    while (i < len) {
+        unsigned char c = in[i++];
+        size_t n = (size_t)(c & 0x7F) + 1;
+        if (o + n > expected) return 0;
+
+        if (c & 0x80) {
+            memset(out + o, 0, n);
+        } else {
+            if (i + n > len) return 0;
+            memcpy(out + o, in + i, n);
+            i += n;
+        }
+        o += n;
+    }
+
+    return o == expected;
+}
+
+// ====================================================
+// Directory Layout
+// ====================================================
+
+static void chain_path(char *buf, size_t len, const char *dir, size_t sequence, const char *ext) {
+    snprintf(buf, len, "%s/%08zu.%s", dir, sequence, ext);
+}
+
+static int read_manifest(const char *dir, size_t *base, size_t *latest) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/" MANIFEST_NAME, dir);
+
+    FILE *file = fopen(path, "r");
+    if (!file) return 0;
+
+    int ok = fscanf(file, "basednn-checkpoint 1\nbase %zu\nlatest %zu\n", base, latest) == 2 && *base <= *latest;
+    fclose(file);
+    return ok;
+}
+
+static int write_manifest(const char *dir, size_t base, size_t latest) {
+    char path[4096], tmp_path[4200];
+    snprintf(path, sizeof(path), "%s/" MANIFEST_NAME, dir);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    FILE *file = fopen(tmp_path, "w");
+    if (!file) return 0;
+
+    int ok = fprintf(file, "basednn-checkpoint 1\nbase %zu\nlatest %zu\n", base, latest) > 0;
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || rename(tmp_path, path) != 0) {
+        remove(tmp_path);
+        return 0;
+    }
+    return 1;
+}
+
+static size_t file_size(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+// ====================================================
+// Checkpointer
+// ====================================================
+
+Checkpointer* checkpointer_create(const char *dir, CheckpointConfig config) {
+    if (!dir || config.block_size == 0) return NULL;
+
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Error: Could not create checkpoint directory %s\n", dir);
+        return NULL;
+    }
+
+    Checkpointer *ckpt = calloc(1, sizeof(Checkpointer));
+    if (!ckpt) return NULL;
+
+    // XOR bytes, their encoding, and one byte of slack per 128 literals
+    size_t bytes = config.block_size * sizeof(float);
+    ckpt->scratch = malloc(2 * bytes + bytes / 128 + 16);
+    ckpt->dir = strdup(dir);
+    if (!ckpt->scratch || !ckpt->dir) {
+        checkpointer_free(ckpt);
+        return NULL;
+    }
+
+    ckpt->config = config;
+    size_t base, latest;
+    if (read_manifest(dir, &base, &latest)) {
+        ckpt->sequence = latest;
+        ckpt->base_sequence = base;
+    }
+
+    return ckpt;
+}
+
+void checkpointer_free(Checkpointer *ckpt) {
+    if (!ckpt) return;
+    free(ckpt->dir);
+    free(ckpt->block_hashes);
+    free(ckpt->snapshot);
+    free(ckpt->scratch);
+    free(ckpt);
+}
+
+static int save_base(Checkpointer *ckpt, Network *net, size_t sequence) {
+    size_t total = 0, num_blocks = 0;
+    for (size_t i = 0; i < net->num_parameters; i++) {
+        total += net->parameters[i]->size;
+        num_blocks += blocks_in(net->parameters[i]->size, ckpt->config.block_size);
+    }
+
+    uint64_t *hashes = malloc((num_blocks ? num_blocks : 1) * sizeof(uint64_t));
+    float *snapshot = ckpt->config.compress ? malloc((total ? total : 1) * sizeof(float)) : NULL;
+    if (!hashes || (ckpt->config.compress && !snapshot)) {
+        free(hashes);
+        free(snapshot);
+        return 0;
+    }
+
+    char path[4096], tmp_path[4200];
+    chain_path(path, sizeof(path), ckpt->dir, sequence, "base");
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    remove(tmp_path);
+    if (!network_save(net, tmp_path) || rename(tmp_path, path) != 0) {
+        remove(tmp_path);
+        free(hashes);
+        free(snapshot);
+        return 0;
+    }
+
+    size_t block = 0, offset = 0;
+    for (size_t i = 0; i < net->num_parameters; i++) {
+        Tensor *param = net->parameters[i];
+        for (size_t start = 0; start < param->size; start += ckpt->config.block_size) {
+            size_t count = param->size - start < ckpt->config.block_size ? param->size - start : ckpt->config.block_size;
+            hashes[block++] = hash_floats(param->data + start, count);
+        }
+        if (snapshot) memcpy(snapshot + offset, param->data, param->size * sizeof(float));
+        offset += param->size;
+    }
+
+    free(ckpt->block_hashes);
+    free(ckpt->snapshot);
+    ckpt->block_hashes = hashes;
+    ckpt->snapshot = snapshot;
+    ckpt->num_blocks = num_blocks;
+    ckpt->layout = layout_hash(net);
+    ckpt->base_sequence = sequence;
+    ckpt->last_bytes = file_size(path);
+    return 1;
+}
+
+static int save_delta(Checkpointer *ckpt, Network *net, size_t sequence) {
+    char path[4096], tmp_path[4200];
+    chain_path(path, sizeof(path), ckpt->dir, sequence, "delta");
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    FILE *file = fopen(tmp_path, "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open file %s for writing\n", tmp_path);
+        return 0;
+    }
+
+    DeltaHeader header = {
+        DELTA_MAGIC, DELTA_VERSION, sequence, ckpt->base_sequence,
+        ckpt->layout, ckpt->config.block_size, 0
+    };
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    size_t block_bytes = ckpt->config.block_size * sizeof(float);
+    unsigned char *xored = ckpt->scratch, *encoded = ckpt->scratch + block_bytes;
+    size_t block = 0, offset = 0;
+
+    // Hashes and the snapshot are only advanced once the file is in place
+    uint64_t *hashes = malloc((ckpt->num_blocks ? ckpt->num_blocks : 1) * sizeof(uint64_t));
+    if (!hashes) ok = 0;
+
+    for (size_t i = 0; ok && i < net->num_parameters; i++) {
+        Tensor *param = net->parameters[i];
+
+        for (size_t start = 0; ok && start < param->size; start += ckpt->config.block_size, block++) {
+            size_t count = param->size - start < ckpt->config.block_size ? param->size - start : ckpt->config.block_size;
+            const float *now = param->data + start;
+            hashes[block] = hash_floats(now, count);
+            if (hashes[block] == ckpt->block_hashes[block]) continue;
+
+            DeltaRecord record = { (uint32_t)i, BLOCK_RAW, start, count, hashes[block], count * sizeof(float) };
+            const void *payload = now;
+
+            if (ckpt->snapshot) {
+                xor_shuffle(now, ckpt->snapshot + offset + start, count, xored);
+                size_t n = rle_encode(xored, count * sizeof(float), encoded, count * sizeof(float));
+                if (n > 0) {
+                    record.encoding = BLOCK_XOR_RLE;
+                    record.payload_bytes = n;
+                    payload = encoded;
+                }
+            }
+
+            ok = fwrite(&record, sizeof(record), 1, file) == 1 &&
+                 fwrite(payload, 1, record.payload_bytes, file) == record.payload_bytes;
+            header.num_records++;
+        }
+        offset += param->size;
+    }
+
+    if (ok) {
+        ok = fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    }
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || rename(tmp_path, path) != 0) {
+        fprintf(stderr, "Error: Could not write checkpoint delta %s\n", path);
+        remove(tmp_path);
+        free(hashes);
+        return 0;
+    }
+
+    if (ckpt->snapshot) {
+        offset = 0;
+        for (size_t i = 0; i < net->num_parameters; i++) {
+            memcpy(ckpt->snapshot + offset, net->parameters[i]->data, net->parameters[i]->size * sizeof(float));
+            offset += net->parameters[i]->size;
+        }
+    }
+    free(ckpt->block_hashes);
+    ckpt->block_hashes = hashes;
+    ckpt->last_bytes = file_size(path);
+    return 1;
+}
+
+int checkpoint_save(Checkpointer *ckpt, Network *net) {
+    if (!ckpt || !net) return 0;
+
+    size_t sequence = ckpt->sequence + 1;
+    int full = !ckpt->block_hashes ||
+               ckpt->layout != layout_hash(net) ||
+               sequence - ckpt->base_sequence >= ckpt->config.full_interval;
+
+    int ok = full ? save_base(ckpt, net, sequence) : save_delta(ckpt, net, sequence);
+    if (!ok || !write_manifest(ckpt->dir, ckpt->base_sequence, sequence)) return 0;
+
+    ckpt->sequence = sequence;
+    return 1;
+}
+
+// ====================================================
+// Loading
+// ====================================================
+
+static int apply_delta(Network *net, const char *path, size_t sequence, size_t base_sequence) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open file %s for reading\n", path);
+        return 0;
+    }
+
+    DeltaHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        header.magic != DELTA_MAGIC || header.version != DELTA_VERSION ||
+        header.sequence != sequence || header.base_sequence != base_sequence ||
+        header.layout != layout_hash(net) || header.block_size == 0) {
+        fprintf(stderr, "Error: Checkpoint delta %s does not continue this chain\n", path);
+        fclose(file);
+        return 0;
+    }
+
+    size_t block_bytes = header.block_size * sizeof(float);
+    unsigned char *payload = malloc(block_bytes);
+    unsigned char *decoded = malloc(block_bytes);
+    int ok = payload && decoded;
+
+    for (uint64_t r = 0; ok && r < header.num_records; r++) {
+        DeltaRecord record;
+        if (fread(&record, sizeof(record), 1, file) != 1 ||
+            record.param >= net->num_parameters ||
+            record.count == 0 || record.count > header.block_size ||
+            record.offset + record.count > net->parameters[record.param]->size ||
+            record.payload_bytes > block_bytes ||
+            fread(payload, 1, record.payload_bytes, file) != record.payload_bytes) {
+            ok = 0;
+            break;
+        }
+
+        float *data = net->parameters[record.param]->data + record.offset;
+        size_t bytes = record.count * sizeof(float);
+
+        if (record.encoding == BLOCK_RAW && record.payload_bytes == bytes) {
+            memcpy(data, payload, bytes);
+        } else if (record.encoding == BLOCK_XOR_RLE && rle_decode(payload, record.payload_bytes, decoded, bytes)) {
+            unshuffle_xor(decoded, record.count, data);
+        } else {
+            ok = 0;
+            break;
+        }
+
+        ok = hash_floats(data, record.count) == record.hash;
+    }
+
+    if (!ok) fprintf(stderr, "Error: Corrupt checkpoint delta %s\n", path);
+    free(payload);
+    free(decoded);
+    fclose(file);
+    return ok;
+}
+
+Network* checkpoint_load_latest(const char *dir) {
+    if (!dir) return NULL;
+
+    size_t base, latest;
+    if (!read_manifest(dir, &base, &latest)) {
+        fprintf(stderr, "Error: No checkpoint found in %s\n", dir);
+        return NULL;
+    }
+
+    char path[4096];
+    chain_path(path, sizeof(path), dir, base, "base");
+    Network *net = network_load(path);
+    if (!net) return NULL;
+
+    for (size_t sequence = base + 1; sequence <= latest; sequence++) {
+        chain_path(path, sizeof(path), dir, sequence, "delta");
+        if (!apply_delta(net, path, sequence, base)) {
+            network_free(net);
+            return NULL;
+        }
+    }
+
+    // Prepacked weights stored with the base no longer match the parameters
+    if (latest > base) {
+        network_plan_free(net->plan);
+        net->plan = NULL;
+    }
+
+    return net;
+}
@@ -0,0 +1,751 @@
+#include "../include/data.h"
+#include "../include/threadpool.h"
+#include "../include/numerics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// ====================================================
+// Fast Float Parsing
+// ====================================================
+
+static const double pow10_table[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static double scale_pow10(double value, int exp10) {
+    while (exp10 > 22) { value *= 1e22; exp10 -= 22; }
+    while (exp10 < -22) { value /= 1e22; exp10 += 22; }
+    return exp10 >= 0 ? value * pow10_table[exp10] : value / pow10_table[-exp10];
+}
+
+// Parses a float from [p, end). Falls back to strtof for anything the fast
+// path does not handle (inf, nan, hex). Returns 0 if the field is malformed.
+static int parse_float(const char *p, const char *end, float *out) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    while (end > p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) end--;
+
+    if (p == end) {
+        *out = NAN;
+        return 1;
+    }
+
+    const char *start = p;
+    int negative = 0;
+    if (*p == '-' || *p == '+') negative = (*p++ == '-');
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exp10 = 0;
+    int seen_digit = 0;
+
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (digits < 19) { mantissa = mantissa * 10 + (uint64_t)(*p - '0'); if (mantissa) digits++; }
+        else exp10++;
+        seen_digit = 1;
+        p++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (digits < 19) { mantissa = mantissa * 10 + (uint64_t)(*p - '0'); if (mantissa) digits++; exp10--; }
+            seen_digit = 1;
+            p++;
+        }
+    }
+    if (seen_digit && p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        int exp_negative = 0;
+        if (p < end && (*p == '-' || *p == '+')) exp_negative = (*p++ == '-');
+        int e = 0;
+        if (p == end || *p < '0' || *p > '9') return 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (e < 10000) e = e * 10 + (*p - '0');
+            p++;
+        }
+        exp10 += exp_negative ? -e : e;
+    }
+
+    if (!seen_digit || p != end) {
+        char buf[64];
+        size_t len = (size_t)(end - start);
+        if (len >= sizeof(buf)) return 0;
+        memcpy(buf, start, len);
+        buf[len] = '\0';
+        char *parse_end;
+        *out = strtof(buf, &parse_end);
+        return parse_end == buf + len;
+    }
+
+    double value = scale_pow10((double)mantissa, exp10);
+    *out = (float)(negative ? -value : value);
+    return 1;
+}
+
+// ====================================================
+// Chunked Parsing
+// ====================================================
+
+typedef struct CSVChunk {
+    const char *begin;
+    const char *end;
+    size_t num_rows;
+    size_t row_offset;
+    long error_row;
+} CSVChunk;
+
+typedef struct CSVParseContext {
+    CSVChunk *chunks;
+    char delimiter;
+    size_t num_columns;
+    long *column_map;   // >= 0: feature index, < 0: -(label index + 1)
+    CSVConfig *config;
+    Tensor *features;
+    Tensor *labels;
+} CSVParseContext;
+
+static int line_is_blank(const char *p, const char *end) {
+    for (; p < end; p++) {
+        if (*p != ' ' && *p != '\t' && *p != '\r') return 0;
+    }
+    return 1;
+}
+
+static void count_chunk(void *ctx, size_t start, size_t end) {
+    CSVParseContext *parse = (CSVParseContext *)ctx;
+
+    for (size_t c = start; c < end; c++) {
+        CSVChunk *chunk = &parse->chunks[c];
+        const char *p = chunk->begin;
+        size_t rows = 0;
+
+        while (p < chunk->end) {
+            const char *nl = memchr(p, '\n', (size_t)(chunk->end - p));
+            const char *line_end = nl ? nl : chunk->end;
+            if (!line_is_blank(p, line_end)) rows++;
+            p = line_end + 1;
+        }
+        chunk->num_rows = rows;
+    }
+}
+
+static void parse_chunk(void *ctx, size_t start, size_t end) {
+    CSVParseContext *parse = (CSVParseContext *)ctx;
+    size_t num_features = parse->features->shape[1];
+    size_t label_width = parse->labels ? parse->labels->shape[1] : 0;
+    int one_hot = parse->config->encoding == LABEL_ONE_HOT;
+
+    for (size_t c = start; c < end; c++) {
+        CSVChunk *chunk = &parse->chunks[c];
+        const char *p = chunk->begin;
+        size_t row = chunk->row_offset;
+        chunk->error_row = -1;
+
+        while (p < chunk->end) {
+            const char *nl = memchr(p, '\n', (size_t)(chunk->end - p));
+            const char *line_end = nl ? nl : chunk->end;
+            if (line_is_blank(p, line_end)) {
+                p = line_end + 1;
+                continue;
+            }
+
+            float *feature_row = parse->features->data + row * num_features;
+            float *label_row = parse->labels ? parse->labels->data + row * label_width : NULL;
+            if (label_row && one_hot) memset(label_row, 0, label_width * sizeof(float));
+
+            size_t col = 0;
+            const char *field = p;
+            for (;;) {
+                const char *field_end = field;
+                while (field_end < line_end && *field_end != parse->delimiter) field_end++;
+
+                if (col >= parse->num_columns) {
+                    col++;
+                    break;
+                }
+
+                float value;
+                if (!parse_float(field, field_end, &value)) break;
+
+                long target = parse->column_map[col];
+                if (target >= 0) {
+                    feature_row[target] = value;
+                } else if (one_hot) {
+                    if (!(value >= 0.0f) || (size_t)value >= label_width) break;
+                    label_row[(size_t)value] = 1.0f;
+                } else {
+                    label_row[-target - 1] = value;
+                }
+
+                col++;
+                if (field_end >= line_end) break;
+                field = field_end + 1;
+            }
+
+            if (col != parse->num_columns) {
+                chunk->error_row = (long)row;
+                return;
+            }
+
+            row++;
+            p = line_end + 1;
+        }
+    }
+}
+
+// ====================================================
+// CSV Loading
+// ====================================================
+
+static size_t count_columns(const char *p, const char *end, char delimiter) {
+    const char *nl = memchr(p, '\n', (size_t)(end - p));
+    const char *line_end = nl ? nl : end;
+    size_t columns = 1;
+    for (; p < line_end; p++) {
+        if (*p == delimiter) columns++;
+    }
+    return columns;
+}
+
+Tensor* tensor_load_csv(const char *file_path, CSVConfig config, Tensor **labels) {
+    if (!file_path) return NULL;
+    if (labels) *labels = NULL;
+
+    char delimiter = config.delimiter ? config.delimiter : ',';
+    if (config.num_label_columns > 0 && !labels) return NULL;
+    if (config.encoding == LABEL_ONE_HOT && (config.num_label_columns != 1 || config.num_classes == 0)) {
+        fprintf(stderr, "Error: One-hot labels require exactly one label column and num_classes > 0\n");
+        return NULL;
+    }
+
+    int fd = open(file_path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Could not open file %s for reading\n", file_path);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        fprintf(stderr, "Error: Could not read %s\n", file_path);
+        close(fd);
+        return NULL;
+    }
+
+    size_t file_size = (size_t)st.st_size;
+    const char *data = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "Error: Could not map %s\n", file_path);
+        return NULL;
+    }
+    madvise((void *)data, file_size, MADV_SEQUENTIAL);
+
+    const char *begin = data;
+    const char *end = data + file_size;
+    if (config.has_header) {
+        const char *nl = memchr(begin, '\n', file_size);
+        begin = nl ? nl + 1 : end;
+    }
+    while (begin < end) {
+        const char *nl = memchr(begin, '\n', (size_t)(end - begin));
+        if (!line_is_blank(begin, nl ? nl : end)) break;
+        begin = nl ? nl + 1 : end;
+    }
+
+    Tensor *features = NULL;
+    CSVChunk *chunks = NULL;
+    long *column_map = NULL;
+    CSVParseContext parse;
+
+    if (begin >= end) {
+        fprintf(stderr, "Error: No data rows in %s\n", file_path);
+        goto cleanup;
+    }
+
+    size_t num_columns = count_columns(begin, end, delimiter);
+    column_map = (long *)malloc(num_columns * sizeof(long));
+    if (!column_map) goto cleanup;
+    for (size_t i = 0; i < num_columns; i++) column_map[i] = 0;
+    for (size_t i = 0; i < config.num_label_columns; i++) {
+        size_t col = config.label_columns[i];
+        if (col >= num_columns || column_map[col] != 0) {
+            fprintf(stderr, "Error: Invalid label column %zu in %s\n", col, file_path);
+            goto cleanup;
+        }
+        column_map[col] = -(long)i - 1;
+    }
+    size_t num_features = 0;
+    for (size_t i = 0; i < num_columns; i++) {
+        if (column_map[i] == 0) column_map[i] = (long)num_features++;
+    }
+
+    // Split into line-aligned chunks, a few per thread for load balance
+    ThreadPool *pool = threadpool_default();
+    size_t num_chunks = threadpool_num_threads(pool) * 4;
+    size_t span = (size_t)(end - begin);
+    if (num_chunks > span / 4096 + 1) num_chunks = span / 4096 + 1;
+
+    chunks = (CSVChunk *)malloc(num_chunks * sizeof(CSVChunk));
+    if (!chunks) goto cleanup;
+    const char *cursor = begin;
+    for (size_t c = 0; c < num_chunks; c++) {
+        const char *chunk_end = (c + 1 == num_chunks) ? end : begin + span * (c + 1) / num_chunks;
+        if (chunk_end < cursor) chunk_end = cursor;
+        if (chunk_end < end) {
+            const char *nl = memchr(chunk_end, '\n', (size_t)(end - chunk_end));
+            chunk_end = nl ? nl + 1 : end;
+        }
+        chunks[c].begin = cursor;
+        chunks[c].end = chunk_end;
+        chunks[c].error_row = -1;
+        cursor = chunk_end;
+    }
+
+    parse.chunks = chunks;
+    parse.delimiter = delimiter;
+    parse.num_columns = num_columns;
+    parse.column_map = column_map;
+    parse.config = &config;
+    parse.labels = NULL;
+
+    threadpool_parallel_for(pool, num_chunks, 1, count_chunk, &parse);
+
+    size_t num_rows = 0;
+    for (size_t c = 0; c < num_chunks; c++) {
+        chunks[c].row_offset = num_rows;
+        num_rows += chunks[c].num_rows;
+    }
+
+    features = tensor_create((size_t[]){num_rows, num_features}, 2);
+    if (!features) goto cleanup;
+    parse.features = features;
+
+    if (config.num_label_columns > 0) {
+        size_t label_width = config.encoding == LABEL_ONE_HOT ? config.num_classes : config.num_label_columns;
+        parse.labels = tensor_create((size_t[]){num_rows, label_width}, 2);
+        if (!parse.labels) {
+            tensor_free(features);
+            features = NULL;
+            goto cleanup;
+        }
+    }
+
+    threadpool_parallel_for(pool, num_chunks, 1, parse_chunk, &parse);
+
+    for (size_t c = 0; c < num_chunks; c++) {
+        if (chunks[c].error_row >= 0) {
+            fprintf(stderr, "Error: Malformed row %ld in %s\n", chunks[c].error_row, file_path);
+            tensor_free(features);
+            tensor_free(parse.labels);
+            features = NULL;
+            parse.labels = NULL;
+            break;
+        }
+    }
+
+    if (labels) *labels = parse.labels;
+
+cleanup:
+    if (chunks) free(chunks);
+    if (column_map) free(column_map);
+    munmap((void *)data, file_size);
+    return features;
+}
+
+// ====================================================
+// Pixel Conversion Kernels
+// ====================================================
+
+// dst[i] = src[i] * scale + bias
+static void convert_row(const uint8_t *src, float *dst, size_t n, float scale, float bias) {
+    size_t i = 0;
+#ifdef __SSE2__
+    __m128i zero = _mm_setzero_si128();
+    __m128 vscale = _mm_set1_ps(scale);
+    __m128 vbias = _mm_set1_ps(bias);
+    for (; i + 16 <= n; i += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+        __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+        __m128 f0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero));
+        __m128 f1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero));
+        __m128 f2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero));
+        __m128 f3 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero));
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_mul_ps(f0, vscale), vbias));
+        _mm_storeu_ps(dst + i + 4, _mm_add_ps(_mm_mul_ps(f1, vscale), vbias));
+        _mm_storeu_ps(dst + i + 8, _mm_add_ps(_mm_mul_ps(f2, vscale), vbias));
+        _mm_storeu_ps(dst + i + 12, _mm_add_ps(_mm_mul_ps(f3, vscale), vbias));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = (float)src[i] * scale + bias;
+    }
+}
+
+// dst[i] = src_last[-i] * scale + bias, used for horizontal flips
+static void convert_row_reversed(const uint8_t *src_last, float *dst, size_t n, float scale, float bias) {
+    size_t i = 0;
+#ifdef __SSE2__
+    __m128i zero = _mm_setzero_si128();
+    __m128 vscale = _mm_set1_ps(scale);
+    __m128 vbias = _mm_set1_ps(bias);
+    for (; i + 16 <= n; i += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)(src_last - i - 15));
+        __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+        __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+        __m128 f0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero));
+        __m128 f1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero));
+        __m128 f2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero));
+        __m128 f3 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero));
+        f0 = _mm_shuffle_ps(f0, f0, _MM_SHUFFLE(0, 1, 2, 3));
+        f1 = _mm_shuffle_ps(f1, f1, _MM_SHUFFLE(0, 1, 2, 3));
+        f2 = _mm_shuffle_ps(f2, f2, _MM_SHUFFLE(0, 1, 2, 3));
+        f3 = _mm_shuffle_ps(f3, f3, _MM_SHUFFLE(0, 1, 2, 3));
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_mul_ps(f3, vscale), vbias));
+        _mm_storeu_ps(dst + i + 4, _mm_add_ps(_mm_mul_ps(f2, vscale), vbias));
+        _mm_storeu_ps(dst + i + 8, _mm_add_ps(_mm_mul_ps(f1, vscale), vbias));
+        _mm_storeu_ps(dst + i + 12, _mm_add_ps(_mm_mul_ps(f0, vscale), vbias));
+    }
+#endif
+    for (; i < n; i++) {
+        dst[i] = (float)src_last[-(ptrdiff_t)i] * scale + bias;
+    }
+}
+
+static uint64_t splitmix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static long random_offset(uint64_t *state, long lo, long hi) {
+    if (hi <= lo) return lo;
+    return lo + (long)(splitmix64(state) % (uint64_t)(hi - lo + 1));
+}
+
+// ====================================================
+// Data Loader
+// ====================================================
+
+enum { SLOT_FREE, SLOT_FILLING, SLOT_READY };
+
+typedef struct BatchSlot {
+    Tensor *inputs;
+    Tensor *targets;
+    size_t batch_index;
+    size_t count;
+    int state;
+} BatchSlot;
+
+struct DataLoader {
+    ImageDataset dataset;
+    AugmentConfig augment;
+    DataLoaderConfig config;
+    size_t out_h;
+    size_t out_w;
+    size_t label_width;
+    float scale[AUGMENT_MAX_CHANNELS];
+    float bias[AUGMENT_MAX_CHANNELS];
+
+    size_t *order;
+    size_t num_batches;
+    size_t epoch;
+    size_t next_claim;
+    size_t next_consume;
+    BatchSlot *slots;
+    BatchSlot *in_use;
+
+    pthread_t *workers;
+    size_t num_workers;
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;
+    pthread_cond_t ready_cond;
+    int shutdown;
+};
+
+static void shuffle_order(DataLoader *loader) {
+    size_t n = loader->dataset.num_samples;
+    for (size_t i = 0; i < n; i++) loader->order[i] = i;
+    if (!loader->config.shuffle) return;
+
+    uint64_t state = ((uint64_t)loader->config.seed << 32) ^ loader->epoch;
+    for (size_t i = n; i > 1; i--) {
+        size_t j = (size_t)(splitmix64(&state) % i);
+        size_t tmp = loader->order[i - 1];
+        loader->order[i - 1] = loader->order[j];
+        loader->order[j] = tmp;
+    }
+}
+
+static void augment_sample(DataLoader *loader, size_t sample, float *dst) {
+    ImageDataset *ds = &loader->dataset;
+    AugmentConfig *aug = &loader->augment;
+    size_t out_h = loader->out_h;
+    size_t out_w = loader->out_w;
+
+    uint64_t state = ((uint64_t)loader->config.seed * 0x100000001B3ULL) ^ ((uint64_t)loader->epoch << 40) ^ sample;
+    long shift = (long)aug->max_shift;
+    long oy = random_offset(&state, 0, (long)(ds->height - out_h)) + random_offset(&state, -shift, shift);
+    long ox = random_offset(&state, 0, (long)(ds->width - out_w)) + random_offset(&state, -shift, shift);
+    int flip = aug->random_flip && (splitmix64(&state) & 1);
+
+    // Columns of the output row that map inside the source image
+    long x0 = flip ? ox + (long)out_w - (long)ds->width : -ox;
+    long x1 = flip ? ox + (long)out_w : (long)ds->width - ox;
+    if (x0 < 0) x0 = 0;
+    if (x1 > (long)out_w) x1 = (long)out_w;
+
+    const uint8_t *src = ds->pixels + sample * ds->channels * ds->height * ds->width;
+
+    for (size_t c = 0; c < ds->channels; c++) {
+        const uint8_t *plane = src + c * ds->height * ds->width;
+        float *out_plane = dst + c * out_h * out_w;
+
+        for (size_t y = 0; y < out_h; y++) {
+            float *out_row = out_plane + y * out_w;
+            long sy = (long)y + oy;
+
+            if (sy < 0 || sy >= (long)ds->height || x0 >= x1) {
+                memset(out_row, 0, out_w * sizeof(float));
+                continue;
+            }
+
+            const uint8_t *row = plane + (size_t)sy * ds->width;
+            if (x0 > 0) memset(out_row, 0, (size_t)x0 * sizeof(float));
+            if (flip) {
+                convert_row_reversed(row + (ox + (long)out_w - 1 - x0), out_row + x0, (size_t)(x1 - x0), loader->scale[c], loader->bias[c]);
+            } else {
+                convert_row(row + (ox + x0), out_row + x0, (size_t)(x1 - x0), loader->scale[c], loader->bias[c]);
+            }
+            if (x1 < (long)out_w) memset(out_row + x1, 0, (size_t)((long)out_w - x1) * sizeof(float));
+        }
+    }
+}
+
+static void fill_batch(DataLoader *loader, BatchSlot *slot) {
+    size_t start = slot->batch_index * loader->config.batch_size;
+    size_t count = loader->dataset.num_samples - start;
+    if (count > loader->config.batch_size) count = loader->config.batch_size;
+    size_t sample_size = loader->dataset.channels * loader->out_h * loader->out_w;
+
+    for (size_t i = 0; i < count; i++) {
+        size_t sample = loader->order[start + i];
+        augment_sample(loader, sample, slot->inputs->data + i * sample_size);
+        if (slot->targets) {
+            memcpy(slot->targets->data + i * loader->label_width,
+                   loader->dataset.labels->data + sample * loader->label_width,
+                   loader->label_width * sizeof(float));
+        }
+    }
+    slot->count = count;
+}
+
+static void* dataloader_worker(void *arg) {
+    DataLoader *loader = (DataLoader *)arg;
+    numerics_sync_thread();
+
+    pthread_mutex_lock(&loader->lock);
+    while (!loader->shutdown) {
+        BatchSlot *slot = NULL;
+        if (loader->next_claim < loader->num_batches) {
+            slot = &loader->slots[loader->next_claim % loader->config.prefetch];
+            if (slot->state != SLOT_FREE) slot = NULL;
+        }
+
+        if (!slot) {
+            pthread_cond_wait(&loader->work_cond, &loader->lock);
+            continue;
+        }
+
+        slot->state = SLOT_FILLING;
+        slot->batch_index = loader->next_claim++;
+        pthread_mutex_unlock(&loader->lock);
+
+        fill_batch(loader, slot);
+
+        pthread_mutex_lock(&loader->lock);
+        slot->state = SLOT_READY;
+        pthread_cond_broadcast(&loader->ready_cond);
+    }
+    pthread_mutex_unlock(&loader->lock);
+    return NULL;
+}
+
+DataLoader* dataloader_create(ImageDataset dataset, AugmentConfig augment, DataLoaderConfig config) {
+    if (!dataset.pixels || dataset.num_samples == 0 || config.batch_size == 0) return NULL;
+    if (dataset.channels == 0 || dataset.channels > AUGMENT_MAX_CHANNELS) {
+        fprintf(stderr, "Error: Data loader supports 1 to %d channels\n", AUGMENT_MAX_CHANNELS);
+        return NULL;
+    }
+    if (augment.crop_h > dataset.height || augment.crop_w > dataset.width) {
+        fprintf(stderr, "Error: Crop size exceeds image size\n");
+        return NULL;
+    }
+    if (dataset.labels && dataset.labels->shape[0] != dataset.num_samples) {
+        fprintf(stderr, "Error: Label count does not match sample count\n");
+        return NULL;
+    }
+
+    DataLoader *loader = (DataLoader *)malloc(sizeof(DataLoader));
+    if (!loader) return NULL;
+
+    if (config.num_workers == 0) config.num_workers = 1;
+    if (config.prefetch == 0) config.prefetch = 2 * config.num_workers;
+
+    loader->dataset = dataset;
+    loader->augment = augment;
+    loader->config = config;
+    loader->out_h = augment.crop_h ? augment.crop_h : dataset.height;
+    loader->out_w = augment.crop_w ? augment.crop_w : dataset.width;
+    loader->label_width = dataset.labels ? dataset.labels->size / dataset.num_samples : 0;
+
+    for (size_t c = 0; c < AUGMENT_MAX_CHANNELS; c++) {
+        float std = augment.std[c] != 0.0f ? augment.std[c] : 1.0f;
+        loader->scale[c] = 1.0f / (255.0f * std);
+        loader->bias[c] = -augment.mean[c] / std;
+    }
+
+    // Everything dataloader_free() looks at is set first, so any failure
+    // below can unwind through it
+    loader->workers = NULL;
+    loader->num_workers = 0;
+    loader->slots = NULL;
+    pthread_mutex_init(&loader->lock, NULL);
+    pthread_cond_init(&loader->work_cond, NULL);
+    pthread_cond_init(&loader->ready_cond, NULL);
+
+    loader->order = (size_t *)malloc(dataset.num_samples * sizeof(size_t));
+    if (!loader->order) {
+        dataloader_free(loader);
+        return NULL;
+    }
+    loader->num_batches = (dataset.num_samples + config.batch_size - 1) / config.batch_size;
+    loader->epoch = 0;
+    loader->next_claim = 0;
+    loader->next_consume = 0;
+    loader->in_use = NULL;
+    loader->shutdown = 0;
+    shuffle_order(loader);
+
+    size_t input_shape[4] = {config.batch_size, dataset.channels, loader->out_h, loader->out_w};
+    loader->slots = (BatchSlot *)calloc(config.prefetch, sizeof(BatchSlot));
+    if (!loader->slots) {
+        dataloader_free(loader);
+        return NULL;
+    }
+    for (size_t i = 0; i < config.prefetch; i++) {
+        loader->slots[i].inputs = tensor_create(input_shape, 4);
+        loader->slots[i].targets = dataset.labels
+            ? tensor_create((size_t[]){config.batch_size, loader->label_width}, 2) : NULL;
+        loader->slots[i].state = SLOT_FREE;
+        loader->slots[i].count = 0;
+        if (!loader->slots[i].inputs || (dataset.labels && !loader->slots[i].targets)) {
+            dataloader_free(loader);
+            return NULL;
+        }
+    }
+
+    loader->workers = (pthread_t *)malloc(config.num_workers * sizeof(pthread_t));
+    if (!loader->workers) {
+        dataloader_free(loader);
+        return NULL;
+    }
+    for (size_t i = 0; i < config.num_workers; i++) {
+        if (pthread_create(&loader->workers[i], NULL, dataloader_worker, loader) != 0) break;
+        loader->num_workers++;
+    }
+
+    if (loader->num_workers == 0) {
+        dataloader_free(loader);
+        return NULL;
+    }
+
+    return loader;
+}
+
+void dataloader_free(DataLoader *loader) {
+    if (!loader) return;
+
+    pthread_mutex_lock(&loader->lock);
+    loader->shutdown = 1;
+    pthread_cond_broadcast(&loader->work_cond);
+    pthread_mutex_unlock(&loader->lock);
+
+    for (size_t i = 0; i < loader->num_workers; i++) {
+        pthread_join(loader->workers[i], NULL);
+    }
+
+    for (size_t i = 0; loader->slots && i < loader->config.prefetch; i++) {
+        tensor_free(loader->slots[i].inputs);
+        tensor_free(loader->slots[i].targets);
+    }
+
+    pthread_mutex_destroy(&loader->lock);
+    pthread_cond_destroy(&loader->work_cond);
+    pthread_cond_destroy(&loader->ready_cond);
+    free(loader->workers);
+    free(loader->slots);
+    free(loader->order);
+    free(loader);
+}
+
+static void set_batch_extent(Tensor *T, size_t count) {
+    if (!T) return;
+    T->size = T->size / T->shape[0] * count;
+    T->shape[0] = count;
+}
+
+int dataloader_next(DataLoader *loader, Tensor **inputs, Tensor **targets) {
+    if (!loader) return 0;
+
+    pthread_mutex_lock(&loader->lock);
+
+    if (loader->in_use) {
+        loader->in_use->state = SLOT_FREE;
+        loader->in_use = NULL;
+        pthread_cond_broadcast(&loader->work_cond);
+    }
+
+    if (loader->next_consume == loader->num_batches) {
+        // Every batch of the epoch has been claimed and consumed, so the
+        // workers are idle and the order can be reshuffled in place.
+        loader->epoch++;
+        shuffle_order(loader);
+        loader->next_claim = 0;
+        loader->next_consume = 0;
+        pthread_cond_broadcast(&loader->work_cond);
+        pthread_mutex_unlock(&loader->lock);
+        return 0;
+    }
+
+    BatchSlot *slot = &loader->slots[loader->next_consume % loader->config.prefetch];
+    while (slot->state != SLOT_READY || slot->batch_index != loader->next_consume) {
+        pthread_cond_wait(&loader->ready_cond, &loader->lock);
+    }
+    loader->next_consume++;
+    loader->in_use = slot;
+    pthread_mutex_unlock(&loader->lock);
+
+    set_batch_extent(slot->inputs, slot->count);
+    set_batch_extent(slot->targets, slot->count);
+    if (inputs) *inputs = slot->inputs;
+    if (targets) *targets = slot->targets;
+    return 1;
+}
+
+size_t dataloader_num_batches(DataLoader *loader) {
+    return loader ? loader->num_batches : 0;
+}
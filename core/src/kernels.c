@@ -0,0 +1,1070 @@
+#include "../include/kernels.h"
+#include "../include/threadpool.h"
+#include "../include/alloc.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define KERNELS_X86 1
+#endif
+
+// ====================================================
+// GEMM Blocking
+// ====================================================
+
+#define GEMM_MC 96
+#define GEMM_KC 256
+#define GEMM_NC 2048
+#define GEMM_NR 16
+#define GEMM_MR_MAX 6
+#define GEMM_SMALL_WORK (32 * 32 * 32)
+#define GEMM_PARALLEL_WORK (128 * 128 * 128)
+
+typedef void (*MicroKernelFn)(size_t kc, const float *Ap, const float *Bp, float *C, size_t ldc, size_t mr, size_t nr);
+
+typedef struct MicroKernel {
+    MicroKernelFn fn;
+    size_t mr;
+} MicroKernel;
+
+static void store_tile(const float *acc, size_t acc_ld, float *C, size_t ldc, size_t mr, size_t nr) {
+    for (size_t i = 0; i < mr; i++) {
+        for (size_t j = 0; j < nr; j++) {
+            C[i * ldc + j] += acc[i * acc_ld + j];
+        }
+    }
+}
+
+// ====================================================
+// Micro-Kernels
+// ====================================================
+
+#define GENERIC_MR 4
+
+static void micro_kernel_generic(size_t kc, const float *Ap, const float *Bp, float *C, size_t ldc, size_t mr, size_t nr) {
+    float acc[GENERIC_MR][GEMM_NR] = {{0.0f}};
+
+    for (size_t k = 0; k < kc; k++) {
+        const float *b = Bp + k * GEMM_NR;
+        for (size_t i = 0; i < GENERIC_MR; i++) {
+            float a = Ap[k * GENERIC_MR + i];
+            for (size_t j = 0; j < GEMM_NR; j++) {
+                acc[i][j] += a * b[j];
+            }
+        }
+    }
+
+    store_tile(&acc[0][0], GEMM_NR, C, ldc, mr, nr);
+}
+
+#ifdef KERNELS_X86
+
+#define AVX2_MR 6
+
+__attribute__((target("avx2,fma")))
+static void micro_kernel_avx2(size_t kc, const float *Ap, const float *Bp, float *C, size_t ldc, size_t mr, size_t nr) {
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+    __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+    __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+    __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+
+    for (size_t k = 0; k < kc; k++) {
+        __m256 b0 = _mm256_loadu_ps(Bp);
+        __m256 b1 = _mm256_loadu_ps(Bp + 8);
+        __m256 a;
+
+        a = _mm256_broadcast_ss(Ap + 0); c00 = _mm256_fmadd_ps(a, b0, c00); c01 = _mm256_fmadd_ps(a, b1, c01);
+        a = _mm256_broadcast_ss(Ap + 1); c10 = _mm256_fmadd_ps(a, b0, c10); c11 = _mm256_fmadd_ps(a, b1, c11);
+        a = _mm256_broadcast_ss(Ap + 2); c20 = _mm256_fmadd_ps(a, b0, c20); c21 = _mm256_fmadd_ps(a, b1, c21);
+        a = _mm256_broadcast_ss(Ap + 3); c30 = _mm256_fmadd_ps(a, b0, c30); c31 = _mm256_fmadd_ps(a, b1, c31);
+        a = _mm256_broadcast_ss(Ap + 4); c40 = _mm256_fmadd_ps(a, b0, c40); c41 = _mm256_fmadd_ps(a, b1, c41);
+        a = _mm256_broadcast_ss(Ap + 5); c50 = _mm256_fmadd_ps(a, b0, c50); c51 = _mm256_fmadd_ps(a, b1, c51);
+
+        Ap += AVX2_MR;
+        Bp += GEMM_NR;
+    }
+
+    if (mr == AVX2_MR && nr == GEMM_NR) {
+        float *c = C;
+        _mm256_storeu_ps(c, _mm256_add_ps(_mm256_loadu_ps(c), c00)); _mm256_storeu_ps(c + 8, _mm256_add_ps(_mm256_loadu_ps(c + 8), c01)); c += ldc;
+        _mm256_storeu_ps(c, _mm256_add_ps(_mm256_loadu_ps(c), c10)); _mm256_storeu_ps(c + 8, _mm256_add_ps(_mm256_loadu_ps(c + 8), c11)); c += ldc;
+        _mm256_storeu_ps(c, _mm256_add_ps(_mm256_loadu_ps(c), c20)); _mm256_storeu_ps(c + 8, _mm256_add_ps(_mm256_loadu_ps(c + 8), c21)); c += ldc;
+        _mm256_storeu_ps(c, _mm256_add_ps(_mm256_loadu_ps(c), c30)); _mm256_storeu_ps(c + 8, _mm256_add_ps(_mm256_loadu_ps(c + 8), c31)); c += ldc;
+        _mm256_storeu_ps(c, _mm256_add_ps(_mm256_loadu_ps(c), c40)); _mm256_storeu_ps(c + 8, _mm256_add_ps(_mm256_loadu_ps(c + 8), c41)); c += ldc;
+        _mm256_storeu_ps(c, _mm256_add_ps(_mm256_loadu_ps(c), c50)); _mm256_storeu_ps(c + 8, _mm256_add_ps(_mm256_loadu_ps(c + 8), c51));
+        return;
+    }
+
+    float acc[AVX2_MR * GEMM_NR];
+    _mm256_storeu_ps(acc + 0 * GEMM_NR, c00); _mm256_storeu_ps(acc + 0 * GEMM_NR + 8, c01);
+    _mm256_storeu_ps(acc + 1 * GEMM_NR, c10); _mm256_storeu_ps(acc + 1 * GEMM_NR + 8, c11);
+    _mm256_storeu_ps(acc + 2 * GEMM_NR, c20); _mm256_storeu_ps(acc + 2 * GEMM_NR + 8, c21);
+    _mm256_storeu_ps(acc + 3 * GEMM_NR, c30); _mm256_storeu_ps(acc + 3 * GEMM_NR + 8, c31);
+    _mm256_storeu_ps(acc + 4 * GEMM_NR, c40); _mm256_storeu_ps(acc + 4 * GEMM_NR + 8, c41);
+    _mm256_storeu_ps(acc + 5 * GEMM_NR, c50); _mm256_storeu_ps(acc + 5 * GEMM_NR + 8, c51);
+    store_tile(acc, GEMM_NR, C, ldc, mr, nr);
+}
+
+#endif
+
+uint32_t kernels_cpu_features(void) {
+    uint32_t features = 0;
+#ifdef KERNELS_X86
+    if (__builtin_cpu_supports("sse2")) features |= CPU_FEATURE_SSE2;
+    if (__builtin_cpu_supports("sse4.2")) features |= CPU_FEATURE_SSE42;
+    if (__builtin_cpu_supports("avx")) features |= CPU_FEATURE_AVX;
+    if (__builtin_cpu_supports("avx2")) features |= CPU_FEATURE_AVX2;
+    if (__builtin_cpu_supports("fma")) features |= CPU_FEATURE_FMA;
+    if (__builtin_cpu_supports("avx512f")) features |= CPU_FEATURE_AVX512F;
+#endif
+    return features;
+}
+
+static const MicroKernel* select_micro_kernel(void) {
+    static const MicroKernel generic = { micro_kernel_generic, GENERIC_MR };
+#ifdef KERNELS_X86
+    static const MicroKernel avx2 = { micro_kernel_avx2, AVX2_MR };
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return &avx2;
+#endif
+    return &generic;
+}
+
+// ====================================================
+// Packing
+// ====================================================
+
+// Packs op(B)[pc:pc+kc, jc:jc+nc] into zero-padded kc x NR column panels
+static void pack_b(int trans_b, const float *B, size_t ldb, size_t pc, size_t kc, size_t jc, size_t nc, float *Bp) {
+    for (size_t jp = 0; jp < nc; jp += GEMM_NR) {
+        size_t nr = nc - jp < GEMM_NR ? nc - jp : GEMM_NR;
+        float *dst = Bp + jp * kc;
+
+        for (size_t k = 0; k < kc; k++) {
+            float *row = dst + k * GEMM_NR;
+            if (trans_b) {
+                for (size_t j = 0; j < nr; j++) row[j] = B[(jc + jp + j) * ldb + pc + k];
+            } else {
+                memcpy(row, B + (pc + k) * ldb + jc + jp, nr * sizeof(float));
+            }
+            for (size_t j = nr; j < GEMM_NR; j++) row[j] = 0.0f;
+        }
+    }
+}
+
+// Packs alpha * op(A)[ic:ic+mc, pc:pc+kc] into zero-padded mr x kc row panels
+static void pack_a(int trans_a, const float *A, size_t lda, size_t ic, size_t mc, size_t pc, size_t kc, float alpha, size_t mr, float *Ap) {
+    for (size_t ip = 0; ip < mc; ip += mr) {
+        size_t rows = mc - ip < mr ? mc - ip : mr;
+        float *dst = Ap + ip * kc;
+
+        for (size_t i = 0; i < rows; i++) {
+            for (size_t k = 0; k < kc; k++) {
+                float a = trans_a ? A[(pc + k) * lda + ic + ip + i] : A[(ic + ip + i) * lda + pc + k];
+                dst[k * mr + i] = alpha * a;
+            }
+        }
+        for (size_t i = rows; i < mr; i++) {
+            for (size_t k = 0; k < kc; k++) dst[k * mr + i] = 0.0f;
+        }
+    }
+}
+
+// ====================================================
+// GEMM
+// ====================================================
+
+typedef struct GemmBlock {
+    const MicroKernel *kernel;
+    int trans_a;
+    const float *A;
+    size_t lda;
+    const float *Bp;
+    float *C;
+    size_t ldc;
+    float alpha;
+    size_t M;
+    size_t mc;
+    size_t jc, nc, pc, kc;
+    size_t num_panels;
+    size_t num_groups;
+} GemmBlock;
+
+// Tile of gemm_tiles straight from A, for when its A scratch is unavailable
+static void gemm_tile_unpacked(const GemmBlock *blk, size_t ic, size_t mc, size_t p0, size_t p1) {
+    for (size_t i = ic; i < ic + mc; i++) {
+        float *c = blk->C + i * blk->ldc + blk->jc;
+        for (size_t p = p0; p < p1; p++) {
+            size_t jp = p * GEMM_NR;
+            size_t cols = blk->nc - jp < GEMM_NR ? blk->nc - jp : GEMM_NR;
+            const float *panel = blk->Bp + jp * blk->kc;
+            for (size_t k = 0; k < blk->kc; k++) {
+                size_t col = blk->pc + k;
+                float a = blk->alpha * (blk->trans_a ? blk->A[col * blk->lda + i] : blk->A[i * blk->lda + col]);
+                for (size_t j = 0; j < cols; j++) c[jp + j] += a * panel[k * GEMM_NR + j];
+            }
+        }
+    }
+}
+
+static void gemm_tiles(void *ctx, size_t start, size_t end) {
+    GemmBlock *blk = (GemmBlock *)ctx;
+    size_t mr = blk->kernel->mr;
+    float *Ap = (float *)malloc(((blk->mc + GEMM_MR_MAX) * blk->kc) * sizeof(float));
+    size_t packed_block = (size_t)-1;
+
+    if (!Ap) {
+        for (size_t t = start; t < end; t++) {
+            size_t ic = t / blk->num_groups * blk->mc;
+            size_t group = t % blk->num_groups;
+            gemm_tile_unpacked(blk, ic, blk->M - ic < blk->mc ? blk->M - ic : blk->mc,
+                               blk->num_panels * group / blk->num_groups,
+                               blk->num_panels * (group + 1) / blk->num_groups);
+        }
+        return;
+    }
+
+    for (size_t t = start; t < end; t++) {
+        size_t mb = t / blk->num_groups;
+        size_t group = t % blk->num_groups;
+        size_t ic = mb * blk->mc;
+        size_t mc = blk->M - ic < blk->mc ? blk->M - ic : blk->mc;
+        size_t p0 = blk->num_panels * group / blk->num_groups;
+        size_t p1 = blk->num_panels * (group + 1) / blk->num_groups;
+
+        if (packed_block != mb) {
+            pack_a(blk->trans_a, blk->A, blk->lda, ic, mc, blk->pc, blk->kc, blk->alpha, mr, Ap);
+            packed_block = mb;
+        }
+
+        for (size_t ip = 0; ip < mc; ip += mr) {
+            size_t rows = mc - ip < mr ? mc - ip : mr;
+            for (size_t p = p0; p < p1; p++) {
+                size_t jp = p * GEMM_NR;
+                size_t cols = blk->nc - jp < GEMM_NR ? blk->nc - jp : GEMM_NR;
+                blk->kernel->fn(blk->kc, Ap + ip * blk->kc, blk->Bp + jp * blk->kc,
+                                blk->C + (ic + ip) * blk->ldc + blk->jc + jp, blk->ldc, rows, cols);
+            }
+        }
+    }
+
+    free(Ap);
+}
+
+static void gemm_small(int trans_a, int trans_b, size_t M, size_t N, size_t K, float alpha,
+                       const float *A, size_t lda, const float *B, size_t ldb, float *C, size_t ldc) {
+    for (size_t i = 0; i < M; i++) {
+        float *c = C + i * ldc;
+        if (trans_b) {
+            for (size_t j = 0; j < N; j++) {
+                float acc = 0.0f;
+                for (size_t k = 0; k < K; k++) {
+                    float a = trans_a ? A[k * lda + i] : A[i * lda + k];
+                    acc += a * B[j * ldb + k];
+                }
+                c[j] += alpha * acc;
+            }
+        } else {
+            for (size_t k = 0; k < K; k++) {
+                float a = alpha * (trans_a ? A[k * lda + i] : A[i * lda + k]);
+                const float *b = B + k * ldb;
+                for (size_t j = 0; j < N; j++) c[j] += a * b[j];
+            }
+        }
+    }
+}
+
+static void scale_c(size_t M, size_t N, float beta, float *C, size_t ldc) {
+    if (beta == 1.0f) return;
+    for (size_t i = 0; i < M; i++) {
+        float *c = C + i * ldc;
+        if (beta == 0.0f) {
+            memset(c, 0, N * sizeof(float));
+        } else {
+            for (size_t j = 0; j < N; j++) c[j] *= beta;
+        }
+    }
+}
+
+// Room for one packed (kc, nc) block of B, see gemm_driver
+static float* gemm_alloc_scratch(size_t N, size_t K, size_t KC, size_t NC) {
+    size_t max_nc = N < NC ? N : NC;
+    size_t max_kc = K < KC ? K : KC;
+    return (float *)buffer_alloc((max_nc + GEMM_NR) * max_kc * sizeof(float));
+}
+
+// Runs the blocked loops. With packed set, B panels are read in place from
+// the prepacked operand; otherwise each (jc, pc) block is packed into the
+// caller's Bp scratch from gemm_alloc_scratch().
+static void gemm_driver(int trans_a, int trans_b, size_t M, size_t N, size_t K,
+                        float alpha, const float *A, size_t lda,
+                        const float *B, size_t ldb, const PackedMatrix *packed, float *Bp,
+                        float *C, size_t ldc, size_t MC, size_t KC, size_t NC) {
+    size_t work = M * N * K;
+    ThreadPool *pool = work >= GEMM_PARALLEL_WORK ? threadpool_default() : NULL;
+    size_t num_threads = threadpool_num_threads(pool);
+    size_t padded_n = (N + GEMM_NR - 1) / GEMM_NR * GEMM_NR;
+
+    // Column blocks must start on a panel boundary
+    NC = (NC + GEMM_NR - 1) / GEMM_NR * GEMM_NR;
+
+    GemmBlock blk;
+    blk.kernel = select_micro_kernel();
+    blk.trans_a = trans_a;
+    blk.A = A;
+    blk.lda = lda;
+    blk.C = C;
+    blk.ldc = ldc;
+    blk.alpha = alpha;
+    blk.M = M;
+    blk.mc = MC;
+
+    size_t num_mblocks = (M + MC - 1) / MC;
+
+    for (size_t jc = 0; jc < N; jc += NC) {
+        size_t nc = N - jc < NC ? N - jc : NC;
+        blk.jc = jc;
+        blk.nc = nc;
+        blk.num_panels = (nc + GEMM_NR - 1) / GEMM_NR;
+
+        // With few row blocks, also split the column panels across threads
+        blk.num_groups = 1;
+        if (num_mblocks < 2 * num_threads) {
+            blk.num_groups = (2 * num_threads + num_mblocks - 1) / num_mblocks;
+            if (blk.num_groups > blk.num_panels) blk.num_groups = blk.num_panels;
+        }
+
+        for (size_t pc = 0; pc < K; pc += KC) {
+            size_t kc = K - pc < KC ? K - pc : KC;
+            blk.pc = pc;
+            blk.kc = kc;
+
+            if (packed) {
+                blk.Bp = packed->data + pc * padded_n + jc * kc;
+            } else {
+                pack_b(trans_b, B, ldb, pc, kc, jc, nc, Bp);
+                blk.Bp = Bp;
+            }
+            threadpool_parallel_for(pool, num_mblocks * blk.num_groups, 1, gemm_tiles, &blk);
+        }
+    }
+}
+
+// ====================================================
+// GEMV
+// ====================================================
+
+#define GEMV_COL_BLOCK 64
+#define GEMV_PARALLEL_WORK ((size_t)1 << 16)
+#define GEMV_MIN_CHUNK ((size_t)1 << 15)    // floats of B per parallel chunk
+
+// C[MR, n0:n1] += xs[MR, K] * B[K, n0:n1] with xs already scaled by alpha
+typedef struct GemvTask {
+    size_t M, N, K;
+    const float *xs;
+    const float *B;
+    size_t ldb;
+    float *C;
+    size_t ldc;
+} GemvTask;
+
+static void gemv_cols_scalar(const GemvTask *t, size_t n0, size_t n1) {
+    for (size_t m = 0; m < t->M; m++) {
+        float *c = t->C + m * t->ldc;
+        const float *x = t->xs + m * t->K;
+        for (size_t k = 0; k < t->K; k++) {
+            const float *b = t->B + k * t->ldb;
+            for (size_t j = n0; j < n1; j++) c[j] += x[k] * b[j];
+        }
+    }
+}
+
+#ifdef KERNELS_X86
+// Every row of B is loaded once per column block and feeds all MR outputs.
+// MR and NV are constants at each call site, so the accumulators stay in registers.
+__attribute__((target("avx2,fma"), always_inline))
+static inline void gemv_tile_avx2(size_t MR, size_t NV, size_t K, const float *xs,
+                                  const float *B, size_t ldb, float *C, size_t ldc) {
+    __m256 acc[GEMV_MAX_ROWS][8];
+#pragma GCC unroll 4
+    for (size_t m = 0; m < MR; m++) {
+#pragma GCC unroll 8
+        for (size_t v = 0; v < NV; v++) acc[m][v] = _mm256_setzero_ps();
+    }
+
+    for (size_t k = 0; k < K; k++) {
+        const float *b = B + k * ldb;
+        __m256 bv[8];
+#pragma GCC unroll 8
+        for (size_t v = 0; v < NV; v++) bv[v] = _mm256_loadu_ps(b + 8 * v);
+#pragma GCC unroll 4
+        for (size_t m = 0; m < MR; m++) {
+            __m256 a = _mm256_broadcast_ss(xs + m * K + k);
+#pragma GCC unroll 8
+            for (size_t v = 0; v < NV; v++) acc[m][v] = _mm256_fmadd_ps(a, bv[v], acc[m][v]);
+        }
+    }
+
+#pragma GCC unroll 4
+    for (size_t m = 0; m < MR; m++) {
+#pragma GCC unroll 8
+        for (size_t v = 0; v < NV; v++) {
+            float *c = C + m * ldc + 8 * v;
+            _mm256_storeu_ps(c, _mm256_add_ps(_mm256_loadu_ps(c), acc[m][v]));
+        }
+    }
+}
+
+// One output row has too few accumulators to hide FMA latency at 32 columns,
+// so it takes 64 at a time
+#define GEMV_TILE(MR, NV) gemv_tile_avx2(MR, NV, t->K, t->xs, t->B + j, t->ldb, t->C + j, t->ldc)
+
+__attribute__((target("avx2,fma")))
+static void gemv_cols_avx2(const GemvTask *t, size_t n0, size_t n1) {
+    size_t j = n0;
+    switch (t->M) {
+        case 1:
+            for (; j + 64 <= n1; j += 64) GEMV_TILE(1, 8);
+            for (; j + 8 <= n1; j += 8) GEMV_TILE(1, 1);
+            break;
+        case 2:
+            for (; j + 32 <= n1; j += 32) GEMV_TILE(2, 4);
+            for (; j + 8 <= n1; j += 8) GEMV_TILE(2, 1);
+            break;
+        case 3:
+            for (; j + 32 <= n1; j += 32) GEMV_TILE(3, 4);
+            for (; j + 8 <= n1; j += 8) GEMV_TILE(3, 1);
+            break;
+        default:
+            for (; j + 32 <= n1; j += 32) GEMV_TILE(4, 4);
+            for (; j + 8 <= n1; j += 8) GEMV_TILE(4, 1);
+            break;
+    }
+    if (j < n1) gemv_cols_scalar(t, j, n1);
+}
+#endif
+
+static void gemv_chunk(void *ctx, size_t start, size_t end) {
+    const GemvTask *t = (const GemvTask *)ctx;
+    size_t n0 = start * GEMV_COL_BLOCK;
+    size_t n1 = end * GEMV_COL_BLOCK < t->N ? end * GEMV_COL_BLOCK : t->N;
+#ifdef KERNELS_X86
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        gemv_cols_avx2(t, n0, n1);
+        return;
+    }
+#endif
+    gemv_cols_scalar(t, n0, n1);
+}
+
+// C[M, N] += alpha * op(A)[M, K] * B[K, N] for M <= GEMV_MAX_ROWS. op(A) is
+// copied out scaled, so the kernel reads it contiguously whatever its layout.
+static void gemv_driver(int trans_a, size_t M, size_t N, size_t K, float alpha,
+                        const float *A, size_t lda, const float *B, size_t ldb, float *C, size_t ldc) {
+    float xs_stack[1024];
+    float *xs = M * K <= 1024 ? xs_stack : (float *)malloc(M * K * sizeof(float));
+    if (!xs) {
+        gemm_small(trans_a, 0, M, N, K, alpha, A, lda, B, ldb, C, ldc);
+        return;
+    }
+
+    for (size_t m = 0; m < M; m++) {
+        for (size_t k = 0; k < K; k++) {
+            xs[m * K + k] = alpha * (trans_a ? A[k * lda + m] : A[m * lda + k]);
+        }
+    }
+
+    GemvTask task = { M, N, K, xs, B, ldb, C, ldc };
+    size_t blocks = (N + GEMV_COL_BLOCK - 1) / GEMV_COL_BLOCK;
+    if (K * N < GEMV_PARALLEL_WORK) {
+        gemv_chunk(&task, 0, blocks);
+    } else {
+        size_t grain = (GEMV_MIN_CHUNK + K * GEMV_COL_BLOCK - 1) / (K * GEMV_COL_BLOCK);
+        threadpool_parallel_for(threadpool_default(), blocks, grain, gemv_chunk, &task);
+    }
+
+    if (xs != xs_stack) free(xs);
+}
+
+typedef struct DotTask {
+    const float *A;
+    size_t lda;
+    size_t N;
+    const float *x;
+    float alpha;
+    float *y;
+} DotTask;
+
+static float dot_scalar(const float *a, const float *x, size_t n) {
+    float acc = 0.0f;
+    for (size_t j = 0; j < n; j++) acc += a[j] * x[j];
+    return acc;
+}
+
+#ifdef KERNELS_X86
+__attribute__((target("avx2,fma")))
+static float dot_avx2(const float *a, const float *x, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+    size_t j = 0;
+    for (; j + 32 <= n; j += 32) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + j), _mm256_loadu_ps(x + j), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + j + 8), _mm256_loadu_ps(x + j + 8), acc1);
+        acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + j + 16), _mm256_loadu_ps(x + j + 16), acc2);
+        acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + j + 24), _mm256_loadu_ps(x + j + 24), acc3);
+    }
+    for (; j + 8 <= n; j += 8) acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + j), _mm256_loadu_ps(x + j), acc0);
+
+    __m256 sum = _mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3));
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s) + dot_scalar(a + j, x + j, n - j);
+}
+#endif
+
+static void dot_rows(void *ctx, size_t start, size_t end) {
+    const DotTask *t = (const DotTask *)ctx;
+    float (*dot)(const float *, const float *, size_t) = dot_scalar;
+#ifdef KERNELS_X86
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) dot = dot_avx2;
+#endif
+    for (size_t i = start; i < end; i++) t->y[i] += t->alpha * dot(t->A + i * t->lda, t->x, t->N);
+}
+
+void sgemv(int trans, size_t M, size_t N, float alpha, const float *A, size_t lda,
+           const float *x, float beta, float *y) {
+    size_t out = trans ? N : M;
+    if (out == 0) return;
+
+    scale_c(1, out, beta, y, out);
+    if (M == 0 || N == 0 || alpha == 0.0f) return;
+
+    if (trans) {
+        // y[N] += alpha * x[M] * A: one output row streaming A
+        gemv_driver(0, 1, N, M, alpha, x, M, A, lda, y, N);
+        return;
+    }
+
+    DotTask task = { A, lda, N, x, alpha, y };
+    if (M * N < GEMV_PARALLEL_WORK) {
+        dot_rows(&task, 0, M);
+    } else {
+        size_t grain = (GEMV_MIN_CHUNK + N - 1) / N;
+        threadpool_parallel_for(threadpool_default(), M, grain, dot_rows, &task);
+    }
+}
+
+GemmBlocking gemm_default_blocking(void) {
+    GemmBlocking blocking = { GEMM_MC, GEMM_KC, GEMM_NC };
+    return blocking;
+}
+
+void sgemm(int trans_a, int trans_b, size_t M, size_t N, size_t K,
+           float alpha, const float *A, size_t lda,
+           const float *B, size_t ldb,
+           float beta, float *C, size_t ldc) {
+    sgemm_blocked(trans_a, trans_b, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc, NULL);
+}
+
+void sgemm_blocked(int trans_a, int trans_b, size_t M, size_t N, size_t K,
+                   float alpha, const float *A, size_t lda,
+                   const float *B, size_t ldb,
+                   float beta, float *C, size_t ldc,
+                   const GemmBlocking *blocking) {
+    if (M == 0 || N == 0) return;
+
+    size_t MC = blocking && blocking->mc ? blocking->mc : GEMM_MC;
+    size_t KC = blocking && blocking->kc ? blocking->kc : GEMM_KC;
+    size_t NC = blocking && blocking->nc ? blocking->nc : GEMM_NC;
+
+    // The scratch is taken before C is scaled, so if it cannot be had the
+    // unblocked loops still compute the full product
+    size_t work = M * N * K;
+    int blocked = K > 0 && alpha != 0.0f && work > GEMM_SMALL_WORK && !(M <= GEMV_MAX_ROWS && !trans_b);
+    float *Bp = blocked ? gemm_alloc_scratch(N, K, KC, NC) : NULL;
+
+    scale_c(M, N, beta, C, ldc);
+    if (K == 0 || alpha == 0.0f) return;
+
+    if (work <= GEMM_SMALL_WORK || (blocked && !Bp)) {
+        gemm_small(trans_a, trans_b, M, N, K, alpha, A, lda, B, ldb, C, ldc);
+    } else if (!blocked) {
+        gemv_driver(trans_a, M, N, K, alpha, A, lda, B, ldb, C, ldc);
+    } else {
+        gemm_driver(trans_a, trans_b, M, N, K, alpha, A, lda, B, ldb, NULL, Bp, C, ldc, MC, KC, NC);
+    }
+
+    buffer_free(Bp);
+}
+
+// ====================================================
+// Prepacked Operands
+// ====================================================
+
+size_t gemm_panel_width(void) {
+    return GEMM_NR;
+}
+
+PackedMatrix* packed_matrix_alloc(size_t K, size_t N, size_t kc) {
+    if (K == 0 || N == 0 || kc == 0) return NULL;
+
+    PackedMatrix *P = (PackedMatrix *)malloc(sizeof(PackedMatrix));
+    if (!P) return NULL;
+
+    P->K = K;
+    P->N = N;
+    P->kc = kc;
+    P->nr = GEMM_NR;
+    P->size = K * ((N + GEMM_NR - 1) / GEMM_NR * GEMM_NR);
+    P->data = (float *)buffer_alloc(P->size * sizeof(float));
+    if (!P->data) {
+        free(P);
+        return NULL;
+    }
+    return P;
+}
+
+PackedMatrix* sgemm_pack_b(int trans_b, size_t K, size_t N, const float *B, size_t ldb, size_t kc) {
+    PackedMatrix *P = packed_matrix_alloc(K, N, kc);
+    if (!P) return NULL;
+
+    size_t padded_n = P->size / K;
+    for (size_t pc = 0; pc < K; pc += kc) {
+        size_t depth = K - pc < kc ? K - pc : kc;
+        pack_b(trans_b, B, ldb, pc, depth, 0, N, P->data + pc * padded_n);
+    }
+    return P;
+}
+
+void packed_matrix_free(PackedMatrix *P) {
+    if (!P) return;
+    buffer_free(P->data);
+    free(P);
+}
+
+void sgemm_packed(int trans_a, size_t M, float alpha, const float *A, size_t lda,
+                  const PackedMatrix *B, float beta, float *C, size_t ldc,
+                  const GemmBlocking *blocking) {
+    if (!B || B->nr != GEMM_NR || M == 0) return;
+
+    scale_c(M, B->N, beta, C, ldc);
+    if (alpha == 0.0f) return;
+
+    size_t MC = blocking && blocking->mc ? blocking->mc : GEMM_MC;
+    size_t NC = blocking && blocking->nc ? blocking->nc : GEMM_NC;
+
+    gemm_driver(trans_a, 0, M, B->N, B->K, alpha, A, lda, NULL, 0, B, NULL, C, ldc, MC, B->kc, NC);
+}
+
+// ====================================================
+// Transpose
+// ====================================================
+
+#define TRANSPOSE_TILE 32
+#define TRANSPOSE_PARALLEL_SIZE (1 << 20)
+#define TRANSPOSE_PANEL 256
+
+typedef struct TransposeTask {
+    size_t rows, cols;
+    const float *src;
+    size_t lds;
+    float *dst;
+    size_t ldd;
+    int accumulate;
+} TransposeTask;
+
+static void transpose_tile_scalar(size_t rows, size_t cols, const float *src, size_t lds,
+                                  float *dst, size_t ldd, int accumulate) {
+    for (size_t i = 0; i < rows; i++) {
+        for (size_t j = 0; j < cols; j++) {
+            if (accumulate) {
+                dst[j * ldd + i] += src[i * lds + j];
+            } else {
+                dst[j * ldd + i] = src[i * lds + j];
+            }
+        }
+    }
+}
+
+#ifdef KERNELS_X86
+__attribute__((target("avx")))
+static void transpose_8x8_avx(const float *src, size_t lds, float *dst, size_t ldd, int accumulate) {
+    __m256 r0 = _mm256_loadu_ps(src + 0 * lds), r1 = _mm256_loadu_ps(src + 1 * lds);
+    __m256 r2 = _mm256_loadu_ps(src + 2 * lds), r3 = _mm256_loadu_ps(src + 3 * lds);
+    __m256 r4 = _mm256_loadu_ps(src + 4 * lds), r5 = _mm256_loadu_ps(src + 5 * lds);
+    __m256 r6 = _mm256_loadu_ps(src + 6 * lds), r7 = _mm256_loadu_ps(src + 7 * lds);
+
+    __m256 t0 = _mm256_unpacklo_ps(r0, r1), t1 = _mm256_unpackhi_ps(r0, r1);
+    __m256 t2 = _mm256_unpacklo_ps(r2, r3), t3 = _mm256_unpackhi_ps(r2, r3);
+    __m256 t4 = _mm256_unpacklo_ps(r4, r5), t5 = _mm256_unpackhi_ps(r4, r5);
+    __m256 t6 = _mm256_unpacklo_ps(r6, r7), t7 = _mm256_unpackhi_ps(r6, r7);
+
+    __m256 s0 = _mm256_shuffle_ps(t0, t2, 0x44), s1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+    __m256 s2 = _mm256_shuffle_ps(t1, t3, 0x44), s3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+    __m256 s4 = _mm256_shuffle_ps(t4, t6, 0x44), s5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+    __m256 s6 = _mm256_shuffle_ps(t5, t7, 0x44), s7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+
+    __m256 out[8];
+    out[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+    out[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+    out[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+    out[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+    out[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+    out[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+    out[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+    out[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+
+    for (size_t k = 0; k < 8; k++) {
+        __m256 v = accumulate ? _mm256_add_ps(_mm256_loadu_ps(dst + k * ldd), out[k]) : out[k];
+        _mm256_storeu_ps(dst + k * ldd, v);
+    }
+}
+
+__attribute__((target("avx")))
+static void transpose_tile_avx(size_t rows, size_t cols, const float *src, size_t lds,
+                               float *dst, size_t ldd, int accumulate) {
+    size_t full_rows = rows & ~(size_t)7, full_cols = cols & ~(size_t)7;
+
+    for (size_t i = 0; i < full_rows; i += 8) {
+        for (size_t j = 0; j < full_cols; j += 8) {
+            transpose_8x8_avx(src + i * lds + j, lds, dst + j * ldd + i, ldd, accumulate);
+        }
+    }
+
+    // Ragged right and bottom edges
+    transpose_tile_scalar(full_rows, cols - full_cols, src + full_cols, lds, dst + full_cols * ldd, ldd, accumulate);
+    transpose_tile_scalar(rows - full_rows, cols, src + full_rows * lds, lds, dst + full_rows, ldd, accumulate);
+}
+#endif
+
+// Halves the longer side, on a multiple of 8 so register tiles stay whole
+static void transpose_recursive(size_t rows, size_t cols, const float *src, size_t lds,
+                                float *dst, size_t ldd, int accumulate, int simd) {
+    if (rows <= TRANSPOSE_TILE && cols <= TRANSPOSE_TILE) {
+#ifdef KERNELS_X86
+        if (simd) {
+            transpose_tile_avx(rows, cols, src, lds, dst, ldd, accumulate);
+            return;
+        }
+#endif
+        transpose_tile_scalar(rows, cols, src, lds, dst, ldd, accumulate);
+        return;
+    }
+
+    if (rows >= cols) {
+        size_t half = (rows / 2 + 7) & ~(size_t)7;
+        transpose_recursive(half, cols, src, lds, dst, ldd, accumulate, simd);
+        transpose_recursive(rows - half, cols, src + half * lds, lds, dst + half, ldd, accumulate, simd);
+    } else {
+        size_t half = (cols / 2 + 7) & ~(size_t)7;
+        transpose_recursive(rows, half, src, lds, dst, ldd, accumulate, simd);
+        transpose_recursive(rows, cols - half, src + half, lds, dst + half * ldd, ldd, accumulate, simd);
+    }
+}
+
+static int transpose_simd(void) {
+#ifdef KERNELS_X86
+    return __builtin_cpu_supports("avx");
+#else
+    return 0;
+#endif
+}
+
+static void transpose_panels(void *ctx, size_t start, size_t end) {
+    TransposeTask *t = (TransposeTask *)ctx;
+    size_t first = start * TRANSPOSE_PANEL;
+    size_t last = end * TRANSPOSE_PANEL < t->rows ? end * TRANSPOSE_PANEL : t->rows;
+    transpose_recursive(last - first, t->cols, t->src + first * t->lds, t->lds,
+                        t->dst + first, t->ldd, t->accumulate, transpose_simd());
+}
+
+static void transpose_driver(size_t rows, size_t cols, const float *src, size_t lds,
+                             float *dst, size_t ldd, int accumulate) {
+    if (rows == 0 || cols == 0) return;
+
+    if (rows * cols < TRANSPOSE_PARALLEL_SIZE) {
+        transpose_recursive(rows, cols, src, lds, dst, ldd, accumulate, transpose_simd());
+        return;
+    }
+
+    TransposeTask task = { rows, cols, src, lds, dst, ldd, accumulate };
+    size_t panels = (rows + TRANSPOSE_PANEL - 1) / TRANSPOSE_PANEL;
+    threadpool_parallel_for(threadpool_default(), panels, 1, transpose_panels, &task);
+}
+
+void matrix_transpose(size_t rows, size_t cols, const float *src, size_t lds, float *dst, size_t ldd) {
+    transpose_driver(rows, cols, src, lds, dst, ldd, 0);
+}
+
+void matrix_transpose_add(size_t rows, size_t cols, const float *src, size_t lds, float *dst, size_t ldd) {
+    transpose_driver(rows, cols, src, lds, dst, ldd, 1);
+}
+
+// ====================================================
+// Exponential
+// ====================================================
+
+#define EXP_HI 88.0f
+#define EXP_LO -87.3365447504019f
+#define EXP_LOG2E 1.44269504088896341f
+#define EXP_C1 0.693359375f
+#define EXP_C2 -2.12194440e-4f
+
+static inline float expf_poly(float x) {
+    if (x != x) return x;
+    if (x < EXP_LO) return 0.0f;
+    if (x > EXP_HI) x = EXP_HI;
+
+    float n = floorf(x * EXP_LOG2E + 0.5f);
+    float r = x - n * EXP_C1 - n * EXP_C2;
+
+    float p = 1.9875691500e-4f;
+    p = p * r + 1.3981999507e-3f;
+    p = p * r + 8.3334519073e-3f;
+    p = p * r + 4.1665795894e-2f;
+    p = p * r + 1.6666665459e-1f;
+    p = p * r + 5.0000001201e-1f;
+    p = p * r * r + r + 1.0f;
+
+    union { uint32_t u; float f; } scale;
+    scale.u = (uint32_t)((int32_t)n + 127) << 23;
+    return p * scale.f;
+}
+
+#ifdef KERNELS_X86
+__attribute__((target("avx2,fma")))
+static void vec_expf_avx2(float *out, const float *in, size_t n) {
+    const __m256 hi = _mm256_set1_ps(EXP_HI), lo = _mm256_set1_ps(EXP_LO);
+    const __m256 log2e = _mm256_set1_ps(EXP_LOG2E), half = _mm256_set1_ps(0.5f);
+    const __m256 c1 = _mm256_set1_ps(EXP_C1), c2 = _mm256_set1_ps(EXP_C2);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(in + i);
+        __m256 underflow = _mm256_cmp_ps(x, lo, _CMP_LT_OQ);
+        // min/max return their second operand when either is NaN, so
+        // keeping x second lets NaN inputs propagate to the output
+        x = _mm256_min_ps(hi, x);
+        x = _mm256_max_ps(lo, x);
+
+        __m256 k = _mm256_floor_ps(_mm256_fmadd_ps(x, log2e, half));
+        __m256 r = _mm256_fnmadd_ps(k, c1, x);
+        r = _mm256_fnmadd_ps(k, c2, r);
+
+        __m256 p = _mm256_set1_ps(1.9875691500e-4f);
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.3981999507e-3f));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(8.3334519073e-3f));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(4.1665795894e-2f));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.6666665459e-1f));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.0000001201e-1f));
+        p = _mm256_fmadd_ps(_mm256_mul_ps(p, r), r, _mm256_add_ps(r, one));
+
+        __m256i e = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(k), _mm256_set1_epi32(127)), 23);
+        __m256 y = _mm256_mul_ps(p, _mm256_castsi256_ps(e));
+        _mm256_storeu_ps(out + i, _mm256_andnot_ps(underflow, y));
+    }
+    for (; i < n; i++) out[i] = expf_poly(in[i]);
+}
+#endif
+
+void vec_expf(float *out, const float *in, size_t n) {
+#ifdef KERNELS_X86
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        vec_expf_avx2(out, in, n);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < n; i++) out[i] = expf_poly(in[i]);
+}
+
+// ====================================================
+// Binary Elementwise
+// ====================================================
+
+#define EWISE_PARALLEL_SIZE ((size_t)1 << 16)
+#define EWISE_GRAIN ((size_t)1 << 14)
+
+typedef void (*EwiseKernel)(float *dst, const float *a, const float *b, size_t n);
+
+typedef struct EwiseTask {
+    EwiseKernel kernel;
+    float *dst;
+    const float *a;
+    const float *b;
+    size_t rows;    // row-wise tasks only
+    size_t cols;
+} EwiseTask;
+
+static int ewise_use_avx2(void) {
+#ifdef KERNELS_X86
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return 0;
+#endif
+}
+
+static EwiseKernel ewise_pick(EwiseKernel avx2, EwiseKernel scalar) {
+    return avx2 && ewise_use_avx2() ? avx2 : scalar;
+}
+
+static void ewise_chunk(void *ctx, size_t start, size_t end) {
+    EwiseTask *t = (EwiseTask *)ctx;
+    t->kernel(t->dst + start, t->a + start, t->b + start, end - start);
+}
+
+static void ewise_run(EwiseKernel kernel, float *dst, const float *a, const float *b, size_t n) {
+    if (n < EWISE_PARALLEL_SIZE) {
+        kernel(dst, a, b, n);
+        return;
+    }
+
+    EwiseTask task = { kernel, dst, a, b, 0, 0 };
+    threadpool_parallel_for(threadpool_default(), n, EWISE_GRAIN, ewise_chunk, &task);
+}
+
+// Each operation gets its own loops, so the compiler sees the arithmetic
+// instead of a call per element. OP and VOP see the current destination d
+// and the inputs x and y; unused loads of d are dropped by the compiler.
+#define EWISE_SCALAR(name, OP)                                                          \
+    static void name##_scalar(float *dst, const float *a, const float *b, size_t n) {    \
+        for (size_t i = 0; i < n; i++) {                                                 \
+            float d = dst[i], x = a[i], y = b[i];                                        \
+            (void)d;                                                                     \
+            dst[i] = OP(d, x, y);                                                        \
+        }                                                                                \
+    }
+
+#ifdef KERNELS_X86
+#define EWISE_STEP(VOP, off)                                                             \
+    _mm256_storeu_ps(dst + i + (off), VOP(_mm256_loadu_ps(dst + i + (off)),              \
+                                          _mm256_loadu_ps(a + i + (off)),                \
+                                          _mm256_loadu_ps(b + i + (off))))
+
+#define EWISE_AVX2(name, VOP)                                                            \
+    __attribute__((target("avx2,fma")))                                                  \
+    static void name##_avx2(float *dst, const float *a, const float *b, size_t n) {      \
+        size_t i = 0;                                                                    \
+        for (; i + 32 <= n; i += 32) {                                                   \
+            EWISE_STEP(VOP, 0);                                                          \
+            EWISE_STEP(VOP, 8);                                                          \
+            EWISE_STEP(VOP, 16);                                                         \
+            EWISE_STEP(VOP, 24);                                                         \
+        }                                                                                \
+        for (; i + 8 <= n; i += 8) EWISE_STEP(VOP, 0);                                   \
+        name##_scalar(dst + i, a + i, b + i, n - i);                                     \
+    }
+#else
+#define EWISE_AVX2(name, VOP) static const EwiseKernel name##_avx2 = NULL;
+#endif
+
+#define EWISE_DEFINE(name, OP, VOP)                                                      \
+    EWISE_SCALAR(name, OP)                                                               \
+    EWISE_AVX2(name, VOP)                                                                \
+    void name(float *dst, const float *a, const float *b, size_t n) {                    \
+        ewise_run(ewise_pick(name##_avx2, name##_scalar), dst, a, b, n);                 \
+    }
+
+#define OP_ADD(d, x, y) ((x) + (y))
+#define OP_SUB(d, x, y) ((x) - (y))
+#define OP_MUL(d, x, y) ((x) * (y))
+#define OP_FMA(d, x, y) ((d) + (x) * (y))
+#define VOP_ADD(d, x, y) _mm256_add_ps(x, y)
+#define VOP_SUB(d, x, y) _mm256_sub_ps(x, y)
+#define VOP_MUL(d, x, y) _mm256_mul_ps(x, y)
+#define VOP_FMA(d, x, y) _mm256_fmadd_ps(x, y, d)
+
+EWISE_DEFINE(vec_add, OP_ADD, VOP_ADD)
+EWISE_DEFINE(vec_sub, OP_SUB, VOP_SUB)
+EWISE_DEFINE(vec_mul, OP_MUL, VOP_MUL)
+EWISE_DEFINE(vec_fma, OP_FMA, VOP_FMA)
+
+static void add_rows_chunk(void *ctx, size_t start, size_t end) {
+    EwiseTask *t = (EwiseTask *)ctx;
+    for (size_t i = start; i < end; i++) {
+        t->kernel(t->dst + i * t->cols, t->a + i * t->cols, t->b, t->cols);
+    }
+}
+
+void vec_add_rows(float *dst, const float *a, const float *row, size_t rows, size_t cols) {
+    EwiseTask task = { ewise_pick(vec_add_avx2, vec_add_scalar), dst, a, row, rows, cols };
+    if (rows * cols < EWISE_PARALLEL_SIZE) {
+        add_rows_chunk(&task, 0, rows);
+        return;
+    }
+
+    size_t grain = cols >= EWISE_GRAIN ? 1 : EWISE_GRAIN / cols;
+    threadpool_parallel_for(threadpool_default(), rows, grain, add_rows_chunk, &task);
+}
+
+// Threads take disjoint column ranges and walk every row of them
+static void sum_rows_chunk(void *ctx, size_t start, size_t end) {
+    EwiseTask *t = (EwiseTask *)ctx;
+    for (size_t i = 0; i < t->rows; i++) {
+        t->kernel(t->dst + start, t->dst + start, t->a + i * t->cols + start, end - start);
+    }
+}
+
+void vec_sum_rows(float *dst, const float *a, size_t rows, size_t cols) {
+    EwiseTask task = { ewise_pick(vec_add_avx2, vec_add_scalar), dst, a, NULL, rows, cols };
+    if (rows * cols < EWISE_PARALLEL_SIZE || cols < 64) {
+        sum_rows_chunk(&task, 0, cols);
+        return;
+    }
+
+    threadpool_parallel_for(threadpool_default(), cols, 64, sum_rows_chunk, &task);
+}
+
+// ====================================================
+// CRC-32C
+// ====================================================
+
+#define CRC32C_POLY 0x82F63B78u // reflected Castagnoli polynomial
+
+static uint32_t crc32c_table[256];
+static pthread_once_t crc32c_table_once = PTHREAD_ONCE_INIT;
+
+static void crc32c_table_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) c = (c >> 1) ^ (CRC32C_POLY & (0u - (c & 1u)));
+        crc32c_table[i] = c;
+    }
+}
+
+static uint32_t crc32c_generic(uint32_t crc, const unsigned char *p, size_t len) {
+    pthread_once(&crc32c_table_once, crc32c_table_init);
+    while (len--) crc = crc32c_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+#if defined(KERNELS_X86) && defined(__x86_64__)
+#define CRC32C_HW 1
+
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t crc, const unsigned char *p, size_t len) {
+    uint64_t c = crc;
+    while (len >= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        c = _mm_crc32_u64(c, w);
+        p += 8;
+        len -= 8;
+    }
+    while (len--) c = _mm_crc32_u8((uint32_t)c, *p++);
+    return (uint32_t)c;
+}
+#endif
+
+uint32_t crc32c(uint32_t crc, const void *data, size_t len) {
+    const unsigned char *p = (const unsigned char *)data;
+#ifdef CRC32C_HW
+    if (__builtin_cpu_supports("sse4.2")) return ~crc32c_sse42(~crc, p, len);
+#endif
+    return ~crc32c_generic(~crc, p, len);
+}
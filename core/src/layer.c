@@ -60,9 +60,7 @@ static Layer* activation_create(LayerConfig *config) {
 
 static Tensor* linear_forward(Layer *self, Tensor *input) {
     if (!self || !input || !self->weights || !self->bias) return NULL;
-    Tensor *Z_0 = tensor_matmul(input, self->weights);
-    Tensor *Z = tensor_add(Z_0, self->bias);
-    return Z;
+    return tensor_linear(input, self->weights, self->bias, NULL);
 }
 
 static Tensor* relu_forward(Layer *self, Tensor *input) {
@@ -85,13 +83,15 @@ static Tensor* softmax_forward(Layer *self, Tensor *input) {
 // Layer Registration
 // ====================================================
 
-void layer_register_builtins(void) {
-    register_layer("linear", linear_create, linear_forward);
-    register_layer("relu", activation_create, relu_forward);
-    register_layer("sigmoid", activation_create, sigmoid_forward);
-    register_layer("tanh", activation_create, tanh_forward);
-    register_layer("softmax", activation_create, softmax_forward);
-}
+// Sorted by name
+const BuiltinLayer builtin_layers[] = {
+    { "linear", linear_create, linear_forward },
+    { "relu", activation_create, relu_forward },
+    { "sigmoid", activation_create, sigmoid_forward },
+    { "softmax", activation_create, softmax_forward },
+    { "tanh", activation_create, tanh_forward },
+};
+const size_t num_builtin_layers = sizeof(builtin_layers) / sizeof(builtin_layers[0]);
 
 // ====================================================
 // Layer Management
@@ -1,9 +1,18 @@
 #include "../include/network.h"
 #include "../include/registry.h"
+#include "../include/plan.h"
+#include "../include/kernels.h"
+#include "../include/threadpool.h"
+#include "../include/numerics.h"
+#include "../include/telemetry.h"
 #include <stdio.h> 
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <errno.h>
+#include <unistd.h>
 
 #define INITIAL_CAPACITY 8
 
@@ -20,6 +29,7 @@ Network* network_create() {
     net->num_layers = 0; 
     net->num_parameters = 0;
     net->capacity = INITIAL_CAPACITY;
+    net->plan = NULL;
 
     return net;
 }
@@ -34,6 +44,10 @@ void network_add_layer(Network *net, Layer *layer) {
 
     net->layers[net->num_layers++] = layer;
 
+    // The architecture changed, so any plan no longer applies
+    network_plan_free(net->plan);
+    net->plan = NULL;
+
     if (layer->num_parameters > 0) {
         for (size_t i = 0; i < layer->num_parameters; i++) {
             tensor_set_requires_grad(layer->parameters[i], 1);
@@ -54,6 +68,7 @@ void network_free(Network *net) {
     }
 
     free(net->layers);
+    network_plan_free(net->plan);
     if (net->parameters) {
         free(net->parameters);
     }
@@ -64,29 +79,117 @@ void network_free(Network *net) {
 // Forward
 // ====================================================
 
+static Tensor* forward_layer(Network *net, size_t index, Tensor *input) {
+    double start = telemetry_enabled() ? telemetry_now() : 0.0;
+
+    Tensor *output = net->plan ? network_plan_forward_layer(net, index, input) : NULL;
+    if (!output) output = layer_forward(net->layers[index], input);
+
+    if (start > 0.0) telemetry_record_op(net->layers[index]->name, 0, telemetry_now() - start);
+    return output;
+}
+
+static Tensor* forward_layers(Network *net, Tensor *input, size_t count) {
+    Tensor *output = input; 
+
+    for (size_t i = 0; i < count; i++) {
+        output = forward_layer(net, i, output);
+    }
+
+    return output;
+}
+
 Tensor* network_forward(Network *net, Tensor *input) {
     if (!net || !input) return NULL; 
+    return forward_layers(net, input, net->num_layers);
+}
 
-    Tensor *output = input; 
+// ====================================================
+// Execution Contexts
+// ====================================================
 
-    for (size_t i = 0; i < net->num_layers; i++) {
-        Tensor *new_output = layer_forward(net->layers[i], output); 
-        output = new_output;
+ExecContext* exec_context_create(Network *net) {
+    if (!net) return NULL;
+
+    ExecContext *ctx = (ExecContext *)malloc(sizeof(ExecContext));
+    if (!ctx) return NULL;
+
+    ctx->net = net;
+    ctx->output = NULL;
+    return ctx;
+}
+
+void exec_context_free(ExecContext *ctx) {
+    if (!ctx) return;
+    tensor_free(ctx->output);
+    free(ctx);
+}
+
+// Without a graph no result refers to the one before it, so each can go as
+// soon as the next layer is done with it
+static Tensor* forward_inference(Network *net, Tensor *input) {
+    int grad_enabled = tensor_grad_enabled();
+    tensor_set_grad_enabled(0);
+
+    Tensor *output = input;
+    for (size_t i = 0; i < net->num_layers && output; i++) {
+        Tensor *next = forward_layer(net, i, output);
+        if (output != input) tensor_free(output);
+        output = next;
     }
 
+    tensor_set_grad_enabled(grad_enabled);
     return output;
 }
 
+Tensor* exec_context_forward(ExecContext *ctx, Tensor *input) {
+    if (!ctx || !input) return NULL;
+
+    tensor_free(ctx->output);
+    ctx->output = NULL;
+
+    Tensor *output = forward_inference(ctx->net, input);
+    if (output != input) ctx->output = output;
+    return output;
+}
+
+// No padding: the kernels take any row count and the layers pick their
+// bucket's plan from the rows they see, while layers such as the transformer
+// encoder treat a 2D input as one sequence, so padding rows would change
+// the real rows' outputs
+Tensor* network_forward_bucketed(Network *net, Tensor *input) {
+    if (!net || !input || input->ndim == 0 || net->num_layers == 0) return NULL;
+    return forward_inference(net, input);
+}
+
 // ====================================================
 // Network Training
 // ====================================================
 
+// A final sigmoid followed by binary cross-entropy is folded into
+// bce_with_logits, which skips the sigmoid's forward and backward passes and
+// stays finite for saturated outputs. Returns what the loss should be taken
+// of and sets loss_fn, or NULL if the loss is unknown or the forward failed.
+static Tensor* training_forward(Network *net, Tensor *input, const char *loss_name, LossFn *loss_fn) {
+    int fuse = net->num_layers > 1 && loss_name && strcmp(loss_name, "binary_cross_entropy") == 0
+            && strcmp(net->layers[net->num_layers - 1]->name, "sigmoid") == 0;
+
+    *loss_fn = get_loss_fn(fuse ? "bce_with_logits" : loss_name);
+    if (!*loss_fn) return NULL;
+
+    return forward_layers(net, input, fuse ? net->num_layers - 1 : net->num_layers);
+}
+
 void network_train(Network *net, Optimizer *opt,  Tensor *input, Tensor *target, size_t epochs, size_t batch_size, const char *loss_name, int verbose) {
     if (!net || !opt || !input || !target) return; 
 
     size_t num_samples = input->shape[0]; 
     size_t num_batches = (num_samples + batch_size - 1) / batch_size; 
 
+    // Training changes the weights a plan was built from
+    network_plan_free(net->plan);
+    net->plan = NULL;
+
     for (size_t epoch = 0; epoch < epochs; epoch++) {
         float total_loss = 0.0f; 
 
@@ -103,20 +206,14 @@ void network_train(Network *net, Optimizer *opt,  Tensor *input, Tensor *target,
                 continue; 
             }
 
-            Tensor *predictions = network_forward(net, batch_input);
+            double step_start = telemetry_enabled() ? telemetry_now() : 0.0;
+            LossFn loss_fn;
+            Tensor *predictions = training_forward(net, batch_input, loss_name, &loss_fn);
             if (!predictions) {
                 tensor_free(batch_input);
                 tensor_free(batch_target);
                 continue; 
             }
-
-            LossFn loss_fn = get_loss_fn(loss_name);
-            if (!loss_fn) {
-                tensor_free(batch_input);
-                tensor_free(batch_target);
-                tensor_free(predictions);
-                continue;
-            }
             
             Tensor *loss_tensor = loss_fn(predictions, batch_target);
 
@@ -129,6 +226,7 @@ void network_train(Network *net, Optimizer *opt,  Tensor *input, Tensor *target,
 
                 optimizer_step(opt);
 
+                if (step_start > 0.0) telemetry_record_step(end - start, telemetry_now() - step_start, loss);
                 tensor_free(loss_tensor);
             }
 
@@ -144,14 +242,13 @@ void network_train(Network *net, Optimizer *opt,  Tensor *input, Tensor *target,
 float network_train_step(Network *net, Tensor *input, Tensor *target, Optimizer *opt, const char *loss_name) {
     if (!net || !opt || !input || !target) return 0.0f;
 
-    Tensor *predictions = network_forward(net, input);
-    if (!predictions) return 0.0f;
+    network_plan_free(net->plan);
+    net->plan = NULL;
 
-    LossFn loss_fn = get_loss_fn(loss_name);
-    if (!loss_fn) {
-        tensor_free(predictions);
-        return 0.0f;
-    }
+    double start = telemetry_enabled() ? telemetry_now() : 0.0;
+    LossFn loss_fn;
+    Tensor *predictions = training_forward(net, input, loss_name, &loss_fn);
+    if (!predictions) return 0.0f;
     
     Tensor *loss_tensor = loss_fn(predictions, target);
 
@@ -166,6 +263,7 @@ float network_train_step(Network *net, Tensor *input, Tensor *target, Optimizer
     tensor_backward(loss_tensor);
     optimizer_step(opt);
 
+    if (start > 0.0) telemetry_record_step(input->shape[0], telemetry_now() - start, loss);
     tensor_free(loss_tensor);
     tensor_free(predictions);
 
@@ -280,52 +378,207 @@ float network_accuracy(Tensor *predictions, Tensor *targets) {
 // Save/Load
 // ====================================================
 
-static void layer_save(Layer *layer, FILE *file) {
-    if (!layer || !file) return;
+// Version 2 files open with a table of contents: each layer's name, config
+// and parameter shapes, and for every parameter the offset, length and
+// CRC-32C of its payload. Payloads follow at aligned offsets, so they are
+// written and read in parallel with pwrite/pread. Optional sections (see
+// plan.h) start at data_end. Version 1 files interleave the payloads with
+// the layer records and carry no checksums; they are still read.
+
+#define MODEL_MAGIC 0x42444E4E // "bDDN"
+#define MODEL_VERSION 2
+#define PAYLOAD_ALIGN 64
+
+typedef struct TensorPayload {
+    float *data;
+    uint64_t offset;
+    uint64_t bytes;
+    uint32_t crc;
+} TensorPayload;
+
+typedef struct PayloadList {
+    TensorPayload *items;
+    size_t count;
+    size_t capacity;
+} PayloadList;
+
+typedef struct PayloadIO {
+    int fd;
+    TensorPayload *items;
+    int failed;
+} PayloadIO;
+
+static int payload_push(PayloadList *list, TensorPayload payload) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 16;
+        TensorPayload *items = (TensorPayload *)realloc(list->items, capacity * sizeof(TensorPayload));
+        if (!items) return 0;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = payload;
+    return 1;
+}
 
-    size_t name_len = strlen(layer->name) + 1;
-    fwrite(&name_len, sizeof(size_t), 1, file);
-    fwrite(layer->name, sizeof(char), name_len, file);
+static int write_all(int fd, const void *buf, size_t len, off_t offset) {
+    const char *p = (const char *)buf;
+    while (len > 0) {
+        ssize_t n = pwrite(fd, p, len, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        p += n;
+        len -= (size_t)n;
+        offset += n;
+    }
+    return 1;
+}
 
-    fwrite(&layer->config_data_size, sizeof(size_t), 1, file);
-    if (layer->config_data_size > 0 && layer->config_data) {
-        fwrite(layer->config_data, 1, layer->config_data_size, file);
+static int read_all(int fd, void *buf, size_t len, off_t offset) {
+    char *p = (char *)buf;
+    while (len > 0) {
+        ssize_t n = pread(fd, p, len, offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        p += n;
+        len -= (size_t)n;
+        offset += n;
+    }
+    return 1;
+}
+
+static void write_payloads(void *ctx, size_t start, size_t end) {
+    PayloadIO *io = (PayloadIO *)ctx;
+    for (size_t i = start; i < end; i++) {
+        TensorPayload *p = &io->items[i];
+        p->crc = crc32c(0, p->data, p->bytes);
+        if (!write_all(io->fd, p->data, p->bytes, (off_t)p->offset)) {
+            __atomic_store_n(&io->failed, 1, __ATOMIC_RELAXED);
+        }
     }
+}
 
-    fwrite(&layer->num_parameters, sizeof(size_t), 1, file);
-    
-    for (size_t i = 0; i < layer->num_parameters; i++) {
+static void read_payloads(void *ctx, size_t start, size_t end) {
+    PayloadIO *io = (PayloadIO *)ctx;
+    for (size_t i = start; i < end; i++) {
+        TensorPayload *p = &io->items[i];
+        if (!read_all(io->fd, p->data, p->bytes, (off_t)p->offset) ||
+            crc32c(0, p->data, p->bytes) != p->crc) {
+            __atomic_store_n(&io->failed, 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Reads payloads on the default pool and checks their CRCs. Returns 0 on failure.
+static int payloads_read(int fd, TensorPayload *items, size_t count) {
+    PayloadIO io = { fd, items, 0 };
+    threadpool_parallel_for(threadpool_default(), count, 1, read_payloads, &io);
+    return !io.failed;
+}
+
+static size_t align_payload(size_t offset) {
+    return (offset + PAYLOAD_ALIGN - 1) & ~(size_t)(PAYLOAD_ALIGN - 1);
+}
+
+static size_t layer_config_size(Layer *layer) {
+    return layer->config_data ? layer->config_data_size : 0;
+}
+
+static int layer_save(Layer *layer, const TensorPayload *payloads, FILE *file) {
+    size_t name_len = strlen(layer->name) + 1;
+    size_t config_size = layer_config_size(layer);
+
+    int ok = fwrite(&name_len, sizeof(size_t), 1, file) == 1
+          && fwrite(layer->name, sizeof(char), name_len, file) == name_len
+          && fwrite(&config_size, sizeof(size_t), 1, file) == 1
+          && fwrite(layer->config_data, 1, config_size, file) == config_size
+          && fwrite(&layer->num_parameters, sizeof(size_t), 1, file) == 1;
+
+    for (size_t i = 0; ok && i < layer->num_parameters; i++) {
         Tensor *param = layer->parameters[i];
-        fwrite(&param->ndim, sizeof(size_t), 1, file);
-        fwrite(param->shape, sizeof(size_t), param->ndim, file);
-        fwrite(param->data, sizeof(float), param->size, file);
+        uint64_t extent[2] = { payloads[i].offset, payloads[i].bytes };
+        uint32_t check[2] = { payloads[i].crc, 0 };
+
+        ok = fwrite(&param->ndim, sizeof(size_t), 1, file) == 1
+          && fwrite(param->shape, sizeof(size_t), param->ndim, file) == param->ndim
+          && fwrite(extent, sizeof(uint64_t), 2, file) == 2
+          && fwrite(check, sizeof(uint32_t), 2, file) == 2;
     }
+
+    return ok;
 }
 
-void network_save(Network *net, const char *file_path) {
-    if (!net || !file_path) return; 
+int network_save(Network *net, const char *file_path) {
+    if (!net || !file_path) return 0; 
+
+    // Size the table of contents, then place every payload after it
+    size_t toc_bytes = 2 * sizeof(uint32_t) + sizeof(size_t) + sizeof(uint64_t);
+    size_t num_payloads = 0;
+    for (size_t i = 0; i < net->num_layers; i++) {
+        Layer *layer = net->layers[i];
+        toc_bytes += 3 * sizeof(size_t) + strlen(layer->name) + 1 + layer_config_size(layer);
+        for (size_t j = 0; j < layer->num_parameters; j++) {
+            toc_bytes += (1 + layer->parameters[j]->ndim) * sizeof(size_t) + 2 * sizeof(uint64_t) + 2 * sizeof(uint32_t);
+        }
+        num_payloads += layer->num_parameters;
+    }
+
+    TensorPayload *payloads = (TensorPayload *)malloc((num_payloads ? num_payloads : 1) * sizeof(TensorPayload));
+    if (!payloads) return 0;
+
+    uint64_t data_end = toc_bytes;
+    size_t idx = 0;
+    for (size_t i = 0; i < net->num_layers; i++) {
+        for (size_t j = 0; j < net->layers[i]->num_parameters; j++) {
+            Tensor *param = net->layers[i]->parameters[j];
+            TensorPayload *p = &payloads[idx++];
+            p->data = param->data;
+            p->offset = align_payload(data_end);
+            p->bytes = param->size * sizeof(float);
+            p->crc = 0;
+            data_end = p->offset + p->bytes;
+        }
+    }
 
     FILE *file = fopen(file_path, "wb"); 
     if (!file) {
         fprintf(stderr, "Error: Could not open file %s for writing\n", file_path);
-        return;
+        free(payloads);
+        return 0;
     }
 
-    uint32_t magic_number = 0x42444E4E; // "bDDN"
-    uint32_t version = 1;
-    fwrite(&magic_number, sizeof(uint32_t), 1, file);
-    fwrite(&version, sizeof(uint32_t), 1, file);
+    PayloadIO io = { fileno(file), payloads, 0 };
+    threadpool_parallel_for(threadpool_default(), num_payloads, 1, write_payloads, &io);
 
-    fwrite(&net->num_layers, sizeof(size_t), 1, file);
-    for (size_t i = 0; i < net->num_layers; i++) {
-        layer_save(net->layers[i], file);
+    uint32_t header[2] = { MODEL_MAGIC, MODEL_VERSION };
+    int ok = !io.failed
+          && fwrite(header, sizeof(uint32_t), 2, file) == 2
+          && fwrite(&net->num_layers, sizeof(size_t), 1, file) == 1;
+
+    idx = 0;
+    for (size_t i = 0; ok && i < net->num_layers; i++) {
+        ok = layer_save(net->layers[i], payloads + idx, file);
+        idx += net->layers[i]->num_parameters;
+    }
+    ok = ok && fwrite(&data_end, sizeof(uint64_t), 1, file) == 1;
+
+    // Optional trailing section; readers that stop after the payloads ignore it
+    if (ok && net->plan) {
+        ok = fseeko(file, (off_t)data_end, SEEK_SET) == 0 && network_plan_write_packed(net, file);
+    }
+
+    ok = (fclose(file) == 0) && ok;
+    free(payloads);
+    if (!ok) {
+        fprintf(stderr, "Error: Could not write %s\n", file_path);
+        return 0;
     }
 
-    fclose(file);
     printf("Network saved to %s\n", file_path);
+    return 1;
 }
 
-static Layer* layer_load(FILE *file) {
+// Version 1 reads the parameter data inline; later versions queue it on payloads
+static Layer* layer_load(FILE *file, uint32_t version, PayloadList *payloads) {
     if (!file) return NULL; 
 
     size_t name_len;
@@ -402,8 +655,28 @@ static Layer* layer_load(FILE *file) {
             size *= shape[j];
         }
         free(shape);
+
+        if (size != param->size) {
+            fprintf(stderr, "Error: Shape mismatch for parameter %zu of layer %s\n", i, name);
+            layer_free(layer);
+            if (config_data) free(config_data);
+            free(name);
+            return NULL;
+        }
+
+        int ok;
+        if (version == 1) {
+            ok = fread(param->data, sizeof(float), size, file) == size;
+        } else {
+            uint64_t extent[2];
+            uint32_t check[2];
+            ok = fread(extent, sizeof(uint64_t), 2, file) == 2
+              && fread(check, sizeof(uint32_t), 2, file) == 2
+              && extent[1] == size * sizeof(float)
+              && payload_push(payloads, (TensorPayload){ param->data, extent[0], extent[1], check[0] });
+        }
         
-        if (fread(param->data, sizeof(float), size, file) != size) {
+        if (!ok) {
             layer_free(layer);
             if (config_data) free(config_data);
             free(name);
@@ -416,9 +689,8 @@ static Layer* layer_load(FILE *file) {
     return layer;
 }
 
-Network* network_load(const char *file_path) {
-    if (!file_path) return NULL; 
-
+// Opens a model file and reads its header, leaving the file at the first layer
+static FILE* model_open(const char *file_path, uint32_t *version, size_t *num_layers) {
     FILE *file = fopen(file_path, "rb");
     if (!file) {
         fprintf(stderr, "Error: Could not open file %s for reading\n", file_path);
@@ -426,36 +698,47 @@ Network* network_load(const char *file_path) {
     }
 
     uint32_t magic_number;
-    if (fread(&magic_number, sizeof(uint32_t), 1, file) != 1 || magic_number != 0x42444E4E) { // "bDDN"
+    if (fread(&magic_number, sizeof(uint32_t), 1, file) != 1 || magic_number != MODEL_MAGIC) {
         fprintf(stderr, "Error: Invalid file format for %s\n", file_path);
         fclose(file);
         return NULL;
     }
 
-    uint32_t version; 
-    if (fread(&version, sizeof(uint32_t), 1, file) != 1 || version != 1) {
-        fprintf(stderr, "Error: Unsupported version %u in file %s\n", version, file_path);
+    if (fread(version, sizeof(uint32_t), 1, file) != 1 || *version < 1 || *version > MODEL_VERSION) {
+        fprintf(stderr, "Error: Unsupported version %u in file %s\n", *version, file_path);
         fclose(file);
         return NULL;
     }
 
-    size_t num_layers;
-    if (fread(&num_layers, sizeof(size_t), 1, file) != 1) {
+    if (fread(num_layers, sizeof(size_t), 1, file) != 1) {
         fprintf(stderr, "Error: Could not read number of layers from %s\n", file_path);
         fclose(file);
         return NULL;
     }
 
+    return file;
+}
+
+Network* network_load(const char *file_path) {
+    if (!file_path) return NULL; 
+
+    uint32_t version;
+    size_t num_layers;
+    FILE *file = model_open(file_path, &version, &num_layers);
+    if (!file) return NULL;
+
     Network *net = network_create();
     if (!net) {
         fclose(file);
         return NULL;
     }
 
+    PayloadList payloads = { NULL, 0, 0 };
     for (size_t i = 0; i < num_layers; i++) {
-        Layer *layer = layer_load(file); 
+        Layer *layer = layer_load(file, version, &payloads); 
         if (!layer) {
             fprintf(stderr, "Error: Could not load layer %zu from %s\n", i, file_path);
+            free(payloads.items);
             network_free(net);
             fclose(file);
             return NULL;
@@ -463,7 +746,220 @@ Network* network_load(const char *file_path) {
         network_add_layer(net, layer); 
     }
 
+    if (version >= 2) {
+        uint64_t data_end;
+        int ok = fread(&data_end, sizeof(uint64_t), 1, file) == 1
+              && payloads_read(fileno(file), payloads.items, payloads.count)
+              && fseeko(file, (off_t)data_end, SEEK_SET) == 0;
+        if (!ok) {
+            fprintf(stderr, "Error: Corrupt parameter data in %s\n", file_path);
+            free(payloads.items);
+            network_free(net);
+            fclose(file);
+            return NULL;
+        }
+    }
+    free(payloads.items);
+
+    // Attaches a plan when the file carries prepacked weights for this machine
+    network_plan_read_packed(net, file);
+
     fclose(file);
     printf("Network loaded from %s\n", file_path);
     return net;
-}
\ No newline at end of file
+}
+
+// ====================================================
+// Streaming Load
+// ====================================================
+
+#define STREAM_READAHEAD ((off_t)32 << 20)
+
+struct NetworkStream {
+    FILE *file;
+    char *file_path;
+    uint32_t version;
+    size_t num_layers;
+    uint64_t data_end;
+    Layer **layers;
+    size_t loaded;      // layers [0, loaded) are ready to run
+    int failed;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+};
+
+// Makes layer index available, or marks the stream failed when layer is NULL
+static void stream_publish(NetworkStream *stream, size_t index, Layer *layer) {
+    pthread_mutex_lock(&stream->lock);
+    if (layer) {
+        stream->layers[index] = layer;
+        stream->loaded = index + 1;
+    } else {
+        stream->failed = 1;
+    }
+    pthread_cond_broadcast(&stream->ready);
+    pthread_mutex_unlock(&stream->lock);
+}
+
+// Version 1: payloads sit between the layer records
+static void stream_load_interleaved(NetworkStream *stream) {
+    int fd = fileno(stream->file);
+
+    for (size_t i = 0; i < stream->num_layers; i++) {
+        // Have the kernel fetch the following layers while this one is parsed
+        posix_fadvise(fd, ftello(stream->file), STREAM_READAHEAD, POSIX_FADV_WILLNEED);
+
+        Layer *layer = layer_load(stream->file, stream->version, NULL);
+        if (!layer) fprintf(stderr, "Error: Could not load layer %zu from %s\n", i, stream->file_path);
+        stream_publish(stream, i, layer);
+        if (!layer) return;
+    }
+}
+
+// Later versions: build every layer from the table of contents, then read
+// and verify the payloads one layer at a time
+static void stream_load_toc(NetworkStream *stream) {
+    size_t n = stream->num_layers;
+    int fd = fileno(stream->file);
+    PayloadList payloads = { NULL, 0, 0 };
+    size_t *first = (size_t *)malloc((n + 1) * sizeof(size_t));
+    Layer **pending = (Layer **)calloc(n ? n : 1, sizeof(Layer *));
+    int ok = first && pending;
+
+    for (size_t i = 0; ok && i < n; i++) {
+        first[i] = payloads.count;
+        pending[i] = layer_load(stream->file, stream->version, &payloads);
+        if (!pending[i]) {
+            fprintf(stderr, "Error: Could not load layer %zu from %s\n", i, stream->file_path);
+            ok = 0;
+        }
+    }
+    ok = ok && fread(&stream->data_end, sizeof(uint64_t), 1, stream->file) == 1;
+    if (ok) first[n] = payloads.count;
+
+    for (size_t i = 0; ok && i < n; i++) {
+        TensorPayload *items = payloads.items + first[i];
+        size_t count = first[i + 1] - first[i];
+        if (count > 0) posix_fadvise(fd, (off_t)items[0].offset, STREAM_READAHEAD, POSIX_FADV_WILLNEED);
+
+        if (!payloads_read(fd, items, count)) {
+            fprintf(stderr, "Error: Corrupt parameter data for layer %zu in %s\n", i, stream->file_path);
+            ok = 0;
+            break;
+        }
+        stream_publish(stream, i, pending[i]);
+        pending[i] = NULL;
+    }
+
+    if (!ok) {
+        for (size_t i = 0; pending && i < n; i++) layer_free(pending[i]);
+        stream_publish(stream, 0, NULL);
+    }
+    free(payloads.items);
+    free(pending);
+    free(first);
+}
+
+static void* stream_loader(void *arg) {
+    NetworkStream *stream = (NetworkStream *)arg;
+    numerics_sync_thread();
+    posix_fadvise(fileno(stream->file), 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    if (stream->version == 1) {
+        stream_load_interleaved(stream);
+    } else {
+        stream_load_toc(stream);
+    }
+    return NULL;
+}
+
+NetworkStream* network_stream_open(const char *file_path) {
+    if (!file_path) return NULL;
+
+    uint32_t version;
+    size_t num_layers;
+    FILE *file = model_open(file_path, &version, &num_layers);
+    if (!file) return NULL;
+
+    NetworkStream *stream = (NetworkStream *)calloc(1, sizeof(NetworkStream));
+    if (!stream) {
+        fclose(file);
+        return NULL;
+    }
+
+    stream->file = file;
+    stream->version = version;
+    stream->num_layers = num_layers;
+    stream->file_path = strdup(file_path);
+    stream->layers = (Layer **)calloc(num_layers ? num_layers : 1, sizeof(Layer *));
+    pthread_mutex_init(&stream->lock, NULL);
+    pthread_cond_init(&stream->ready, NULL);
+
+    if (!stream->file_path || !stream->layers ||
+        pthread_create(&stream->thread, NULL, stream_loader, stream) != 0) {
+        fprintf(stderr, "Error: Could not start loading %s\n", file_path);
+        pthread_mutex_destroy(&stream->lock);
+        pthread_cond_destroy(&stream->ready);
+        free(stream->layers);
+        free(stream->file_path);
+        free(stream);
+        fclose(file);
+        return NULL;
+    }
+
+    return stream;
+}
+
+static Layer* stream_wait_layer(NetworkStream *stream, size_t index) {
+    pthread_mutex_lock(&stream->lock);
+    while (stream->loaded <= index && !stream->failed) {
+        pthread_cond_wait(&stream->ready, &stream->lock);
+    }
+    Layer *layer = stream->loaded > index ? stream->layers[index] : NULL;
+    pthread_mutex_unlock(&stream->lock);
+    return layer;
+}
+
+Tensor* network_stream_forward(NetworkStream *stream, Tensor *input) {
+    if (!stream || !input) return NULL;
+
+    Tensor *output = input;
+
+    for (size_t i = 0; i < stream->num_layers; i++) {
+        Layer *layer = stream_wait_layer(stream, i);
+        if (!layer) return NULL;
+        output = layer_forward(layer, output);
+    }
+
+    return output;
+}
+
+Network* network_stream_finish(NetworkStream *stream) {
+    if (!stream) return NULL;
+
+    pthread_join(stream->thread, NULL);
+
+    Network *net = stream->failed ? NULL : network_create();
+    if (net) {
+        for (size_t i = 0; i < stream->num_layers; i++) {
+            network_add_layer(net, stream->layers[i]);
+        }
+        if (stream->version == 1 || fseeko(stream->file, (off_t)stream->data_end, SEEK_SET) == 0) {
+            network_plan_read_packed(net, stream->file);
+        }
+        printf("Network loaded from %s\n", stream->file_path);
+    } else {
+        for (size_t i = 0; i < stream->loaded; i++) {
+            layer_free(stream->layers[i]);
+        }
+    }
+
+    fclose(stream->file);
+    pthread_mutex_destroy(&stream->lock);
+    pthread_cond_destroy(&stream->ready);
+    free(stream->layers);
+    free(stream->file_path);
+    free(stream);
+    return net;
+}
@@ -0,0 +1,118 @@
+#include "../include/numerics.h"
+#include <stdlib.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <xmmintrin.h>
+#define NUMERICS_X86 1
+#define MXCSR_DAZ (1u << 6)
+#define MXCSR_FTZ (1u << 15)
+#elif defined(__aarch64__)
+#define NUMERICS_ARM64 1
+#define FPCR_FZ (1ull << 24)
+#endif
+
+static NumericsConfig config = { 1, 0 };
+
+// Bumped on every change; threads compare it with the last one they applied
+static unsigned generation = 1;
+static __thread unsigned applied_generation = 0;
+
+// ====================================================
+// Floating-Point Control
+// ====================================================
+
+static void set_flush_denormals(int enable) {
+#if defined(NUMERICS_X86)
+    unsigned csr = _mm_getcsr();
+    csr = enable ? (csr | MXCSR_DAZ | MXCSR_FTZ) : (csr & ~(MXCSR_DAZ | MXCSR_FTZ));
+    _mm_setcsr(csr);
+#elif defined(NUMERICS_ARM64)
+    unsigned long long fpcr;
+    __asm__ volatile("mrs %0, fpcr" : "=r"(fpcr));
+    fpcr = enable ? (fpcr | FPCR_FZ) : (fpcr & ~FPCR_FZ);
+    __asm__ volatile("msr fpcr, %0" : : "r"(fpcr));
+#else
+    (void)enable;
+#endif
+}
+
+static NumericsState read_control(void) {
+#if defined(NUMERICS_X86)
+    return _mm_getcsr();
+#elif defined(NUMERICS_ARM64)
+    unsigned long long fpcr;
+    __asm__ volatile("mrs %0, fpcr" : "=r"(fpcr));
+    return fpcr;
+#else
+    return 0;
+#endif
+}
+
+static void write_control(NumericsState state) {
+#if defined(NUMERICS_X86)
+    _mm_setcsr((unsigned)state);
+#elif defined(NUMERICS_ARM64)
+    __asm__ volatile("msr fpcr, %0" : : "r"(state));
+#else
+    (void)state;
+#endif
+}
+
+int numerics_thread_flushes_denormals(void) {
+#if defined(NUMERICS_X86)
+    return (_mm_getcsr() & (MXCSR_DAZ | MXCSR_FTZ)) == (MXCSR_DAZ | MXCSR_FTZ);
+#elif defined(NUMERICS_ARM64)
+    unsigned long long fpcr;
+    __asm__ volatile("mrs %0, fpcr" : "=r"(fpcr));
+    return (fpcr & FPCR_FZ) != 0;
+#else
+    return 0;
+#endif
+}
+
+// ====================================================
+// Configuration
+// ====================================================
+
+NumericsConfig numerics_config(void) {
+    NumericsConfig current;
+    current.flush_denormals = __atomic_load_n(&config.flush_denormals, __ATOMIC_RELAXED);
+    current.fast_math = __atomic_load_n(&config.fast_math, __ATOMIC_RELAXED);
+    return current;
+}
+
+void numerics_sync_thread(void) {
+    unsigned current = __atomic_load_n(&generation, __ATOMIC_ACQUIRE);
+    if (applied_generation == current) return;
+
+    set_flush_denormals(__atomic_load_n(&config.flush_denormals, __ATOMIC_RELAXED));
+    applied_generation = current;
+}
+
+NumericsState numerics_enter(void) {
+    NumericsState saved = read_control();
+    set_flush_denormals(__atomic_load_n(&config.flush_denormals, __ATOMIC_RELAXED));
+    return saved;
+}
+
+void numerics_leave(NumericsState saved) {
+    write_control(saved);
+}
+
+void numerics_configure(NumericsConfig new_config) {
+    __atomic_store_n(&config.flush_denormals, new_config.flush_denormals, __ATOMIC_RELAXED);
+    __atomic_store_n(&config.fast_math, new_config.fast_math, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&generation, 1, __ATOMIC_RELEASE);
+    numerics_sync_thread();
+}
+
+void numerics_init(void) {
+    NumericsConfig initial = NUMERICS_DEFAULTS();
+
+    const char *env = getenv("BASEDNN_FLUSH_DENORMALS");
+    if (env) initial.flush_denormals = atoi(env) != 0;
+    env = getenv("BASEDNN_FAST_MATH");
+    if (env) initial.fast_math = atoi(env) != 0;
+
+    numerics_configure(initial);
+}
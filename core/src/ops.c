@@ -1,5 +1,8 @@
 #include "../include/ops.h"
 #include "../include/registry.h"
+#include "../include/kernels.h"
+#include "../include/alloc.h"
+#include "../include/numerics.h"
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
@@ -9,7 +12,7 @@
 // ====================================================
 
 static void grad_update_three_vars(Tensor *W, Tensor *X, Tensor *b, Tensor *Z, float (*func)(float, float), const char *op_name, void (*backward_fn)(Tensor *)) {
-    if (W->requires_grad || X->requires_grad || b->requires_grad) {
+    if (tensor_grad_enabled() && (W->requires_grad || X->requires_grad || b->requires_grad)) {
         Z->requires_grad = 1;
         Z->op_name = op_name ? strdup(op_name) : NULL;
         Z->num_inputs = 3;
@@ -22,7 +25,7 @@ static void grad_update_three_vars(Tensor *W, Tensor *X, Tensor *b, Tensor *Z, f
 }
 
 static void grad_update_two_vars(Tensor *A, Tensor *B, Tensor *C, float (*func)(float, float), const char *op_name, void (*backward_fn)(Tensor *)) {
-    if (A->requires_grad || B->requires_grad) {
+    if (tensor_grad_enabled() && (A->requires_grad || B->requires_grad)) {
         C->requires_grad = 1;
         C->op_name = op_name ? strdup(op_name) : NULL;
         C->num_inputs = 2;
@@ -34,7 +37,7 @@ static void grad_update_two_vars(Tensor *A, Tensor *B, Tensor *C, float (*func)(
 }
 
 static void grad_update_one_var(Tensor *A, Tensor *C, float (*func)(float, float), const char *op_name, void (*backward_fn)(Tensor *)) {
-    if (A->requires_grad) {
+    if (tensor_grad_enabled() && A->requires_grad) {
         C->requires_grad = 1;
         C->op_name = op_name ? strdup(op_name) : NULL;
         C->num_inputs = 1;
@@ -48,24 +51,20 @@ static void grad_update_one_var(Tensor *A, Tensor *C, float (*func)(float, float
 // Elementwise Operations
 // ====================================================
 
-static void tensor_ewise(Tensor *A, Tensor *B, Tensor *C, float (*func)(float, float), const char *op_name, void (*backward_fn)(Tensor *)) {
+typedef void (*EwiseFn)(float *dst, const float *a, const float *b, size_t n);
+
+static void tensor_ewise(Tensor *A, Tensor *B, Tensor *C, EwiseFn kernel, const char *op_name, void (*backward_fn)(Tensor *)) {
     if (!A || !B || !C) return; 
     if (A->ndim != B->ndim || A->ndim != C->ndim) return; 
     for (size_t i = 0; i < A->ndim; i++) {
         if (A->shape[i] != B->shape[i] || A->shape[i] != C->shape[i]) return;
     }
 
-    for (size_t i = 0; i < A->size; i++) {
-        C->data[i] = func(A->data[i], B->data[i]); 
-    }
+    kernel(C->data, A->data, B->data, A->size);
 
-    grad_update_two_vars(A, B, C, func, op_name, backward_fn);
+    grad_update_two_vars(A, B, C, NULL, op_name, backward_fn);
 }
 
-static float add_func(float x, float y) { return x + y; }
-static float sub_func(float x, float y) { return x - y; }
-static float mul_func(float x, float y) { return x * y; }
-
 Tensor* tensor_add(Tensor *A, Tensor *B) {
     if (!A || !B) return NULL;
     
@@ -73,20 +72,12 @@ Tensor* tensor_add(Tensor *A, Tensor *B) {
     if (!C) return NULL;
 
     if (A->ndim == 2 && B->ndim == 1 && A->shape[1] == B->shape[0]) {
-        Tensor *C = tensor_create(A->shape, A->ndim);
-        if (!C) return NULL;
-        
-        for (size_t i = 0; i < A->shape[0]; i++) {
-            for (size_t j = 0; j < A->shape[1]; j++) {
-                C->data[i * A->shape[1] + j] = A->data[i * A->shape[1] + j] + B->data[j];
-            }
-        }
-        
+        vec_add_rows(C->data, A->data, B->data, A->shape[0], A->shape[1]);
         grad_update_two_vars(A, B, C, NULL, "add", backward_add);
         return C;
     }
 
-    tensor_ewise(A, B, C, add_func, "add", backward_add);
+    tensor_ewise(A, B, C, vec_add, "add", backward_add);
     return C;
 }
 
@@ -97,26 +88,18 @@ void backward_add(Tensor *C) {
     Tensor *B = C->inputs[1];
     
     if (A->requires_grad) {
-        if (!A->grad) A->grad = (float *)calloc(A->size, sizeof(float));
-        for (size_t i = 0; i < A->size; i++) {
-            A->grad[i] += C->grad[i];
-        }
+        if (!A->grad) A->grad = (float *)buffer_calloc(A->size, sizeof(float));
+        vec_add(A->grad, A->grad, C->grad, A->size);
     }
     
     if (B->requires_grad) {
-        if (!B->grad) B->grad = (float *)calloc(B->size, sizeof(float));
+        if (!B->grad) B->grad = (float *)buffer_calloc(B->size, sizeof(float));
 
         if (A->ndim == 2 && B->ndim == 1 && A->shape[1] == B->shape[0]) {
             // also a temporary fix, should add broadcasting support properly
-            for (size_t i = 0; i < A->shape[0]; i++) {
-                for (size_t j = 0; j < B->shape[0]; j++) {
-                    B->grad[j] += C->grad[i * A->shape[1] + j];
-                }
-            }
+            vec_sum_rows(B->grad, C->grad, A->shape[0], A->shape[1]);
         } else {
-            for (size_t i = 0; i < B->size; i++) {
-                B->grad[i] += C->grad[i];
-            }
+            vec_add(B->grad, B->grad, C->grad, B->size);
         }
     }
 }
@@ -127,7 +110,7 @@ Tensor* tensor_sub(Tensor *A, Tensor *B) {
     Tensor *C = tensor_create(A->shape, A->ndim);
     if (!C) return NULL;
 
-    tensor_ewise(A, B, C, sub_func, "sub", backward_sub);
+    tensor_ewise(A, B, C, vec_sub, "sub", backward_sub);
     return C;
 }
 
@@ -139,17 +122,13 @@ void backward_sub(Tensor *C) {
     Tensor *B = C->inputs[1];
     
     if (A->requires_grad) {
-        if (!A->grad) A->grad = (float *)calloc(A->size, sizeof(float));
-        for (size_t i = 0; i < A->size; i++) {
-            A->grad[i] += C->grad[i];
-        }
+        if (!A->grad) A->grad = (float *)buffer_calloc(A->size, sizeof(float));
+        vec_add(A->grad, A->grad, C->grad, A->size);
     }
     
     if (B->requires_grad) {
-        if (!B->grad) B->grad = (float *)calloc(B->size, sizeof(float));
-        for (size_t i = 0; i < B->size; i++) {
-            B->grad[i] -= C->grad[i];
-        }
+        if (!B->grad) B->grad = (float *)buffer_calloc(B->size, sizeof(float));
+        vec_sub(B->grad, B->grad, C->grad, B->size);
     }
 }
 
@@ -159,7 +138,7 @@ Tensor* tensor_mul(Tensor *A, Tensor *B) {
     Tensor *C = tensor_create(A->shape, A->ndim);
     if (!C) return NULL;
 
-    tensor_ewise(A, B, C, mul_func, "mul", backward_mul);
+    tensor_ewise(A, B, C, vec_mul, "mul", backward_mul);
     return C;
 }
 
@@ -170,17 +149,13 @@ void backward_mul(Tensor *C) {
     Tensor *B = C->inputs[1];
     
     if (A->requires_grad) {
-        if (!A->grad) A->grad = (float *)calloc(A->size, sizeof(float));
-        for (size_t i = 0; i < A->size; i++) {
-            A->grad[i] += C->grad[i] * B->data[i];
-        }
+        if (!A->grad) A->grad = (float *)buffer_calloc(A->size, sizeof(float));
+        vec_fma(A->grad, C->grad, B->data, A->size);
     }
     
     if (B->requires_grad) {
-        if (!B->grad) B->grad = (float *)calloc(B->size, sizeof(float));
-        for (size_t i = 0; i < B->size; i++) {
-            B->grad[i] += C->grad[i] * A->data[i];
-        }
+        if (!B->grad) B->grad = (float *)buffer_calloc(B->size, sizeof(float));
+        vec_fma(B->grad, C->grad, A->data, B->size);
     }
 }
 
@@ -211,13 +186,7 @@ Tensor* tensor_matmul(Tensor *A, Tensor *B) {
         Tensor *C = tensor_create((size_t[]){A->shape[0]}, 1);
         if (!C) return NULL;
         
-        for (size_t i = 0; i < A->shape[0]; i++) {
-            float acc = 0.0f;
-            for (size_t k = 0; k < A->shape[1]; k++) {
-                acc += A->data[i * A->shape[1] + k] * B->data[k];
-            }
-            C->data[i] = acc;
-        }
+        sgemv(0, A->shape[0], A->shape[1], 1.0f, A->data, A->shape[1], B->data, 0.0f, C->data);
         
         grad_update_two_vars(A, B, C, NULL, "matmul", backward_matmul);
         return C;
@@ -227,13 +196,7 @@ Tensor* tensor_matmul(Tensor *A, Tensor *B) {
         Tensor *C = tensor_create((size_t[]){B->shape[1]}, 1);
         if (!C) return NULL;
         
-        for (size_t j = 0; j < B->shape[1]; j++) {
-            float acc = 0.0f;
-            for (size_t k = 0; k < A->shape[0]; k++) {
-                acc += A->data[k] * B->data[k * B->shape[1] + j];
-            }
-            C->data[j] = acc;
-        }
+        sgemv(1, B->shape[0], B->shape[1], 1.0f, B->data, B->shape[1], A->data, 0.0f, C->data);
         
         grad_update_two_vars(A, B, C, NULL, "matmul", backward_matmul);
         return C;
@@ -244,15 +207,8 @@ Tensor* tensor_matmul(Tensor *A, Tensor *B) {
         Tensor *C = tensor_create(C_shape, 2);
         if (!C) return NULL; 
 
-        for (size_t i = 0; i < A->shape[0]; i++) {
-            for (size_t j = 0; j < B->shape[1]; j++) {
-                float acc = 0.0f;
-                for (size_t k = 0; k < A->shape[1]; k++) {
-                    acc += A->data[i * A->shape[1] + k] * B->data[k * B->shape[1] + j];
-                }
-                C->data[i * C->shape[1] + j] = acc; 
-            }
-        }
+        sgemm(0, 0, A->shape[0], B->shape[1], A->shape[1],
+              1.0f, A->data, A->shape[1], B->data, B->shape[1], 0.0f, C->data, C->shape[1]);
 
         grad_update_two_vars(A, B, C, NULL, "matmul", backward_matmul);
 
@@ -270,13 +226,13 @@ void backward_matmul(Tensor *output) {
     
     if (A->ndim == 1 && B->ndim == 1) {
         if (A->requires_grad) {
-            if (!A->grad) A->grad = (float *)calloc(A->size, sizeof(float));
+            if (!A->grad) A->grad = (float *)buffer_calloc(A->size, sizeof(float));
             for (size_t i = 0; i < A->size; i++) {
                 A->grad[i] += output->grad[0] * B->data[i];
             }
         }
         if (B->requires_grad) {
-            if (!B->grad) B->grad = (float *)calloc(B->size, sizeof(float));
+            if (!B->grad) B->grad = (float *)buffer_calloc(B->size, sizeof(float));
             for (size_t i = 0; i < B->size; i++) {
                 B->grad[i] += output->grad[0] * A->data[i];
             }
@@ -285,7 +241,7 @@ void backward_matmul(Tensor *output) {
     
     else if (A->ndim == 2 && B->ndim == 1) {
         if (A->requires_grad) {
-            if (!A->grad) A->grad = (float *)calloc(A->size, sizeof(float));
+            if (!A->grad) A->grad = (float *)buffer_calloc(A->size, sizeof(float));
             for (size_t i = 0; i < A->shape[0]; i++) {
                 for (size_t j = 0; j < A->shape[1]; j++) {
                     A->grad[i * A->shape[1] + j] += output->grad[i] * B->data[j];
@@ -293,30 +249,18 @@ void backward_matmul(Tensor *output) {
             }
         }
         if (B->requires_grad) {
-            if (!B->grad) B->grad = (float *)calloc(B->size, sizeof(float));
-            for (size_t j = 0; j < B->shape[0]; j++) {
-                float acc = 0.0f;
-                for (size_t i = 0; i < A->shape[0]; i++) {
-                    acc += A->data[i * A->shape[1] + j] * output->grad[i];
-                }
-                B->grad[j] += acc;
-            }
+            if (!B->grad) B->grad = (float *)buffer_calloc(B->size, sizeof(float));
+            sgemv(1, A->shape[0], A->shape[1], 1.0f, A->data, A->shape[1], output->grad, 1.0f, B->grad);
         }
     }
     
     else if (A->ndim == 1 && B->ndim == 2) {
         if (A->requires_grad) {
-            if (!A->grad) A->grad = (float *)calloc(A->size, sizeof(float));
-            for (size_t i = 0; i < A->shape[0]; i++) {
-                float acc = 0.0f;
-                for (size_t j = 0; j < B->shape[1]; j++) {
-                    acc += output->grad[j] * B->data[i * B->shape[1] + j];
-                }
-                A->grad[i] += acc;
-            }
+            if (!A->grad) A->grad = (float *)buffer_calloc(A->size, sizeof(float));
+            sgemv(0, B->shape[0], B->shape[1], 1.0f, B->data, B->shape[1], output->grad, 1.0f, A->grad);
         }
         if (B->requires_grad) {
-            if (!B->grad) B->grad = (float *)calloc(B->size, sizeof(float));
+            if (!B->grad) B->grad = (float *)buffer_calloc(B->size, sizeof(float));
             for (size_t i = 0; i < B->shape[0]; i++) {
                 for (size_t j = 0; j < B->shape[1]; j++) {
                     B->grad[i * B->shape[1] + j] += A->data[i] * output->grad[j];
@@ -326,28 +270,78 @@ void backward_matmul(Tensor *output) {
     }
     
     else if (A->ndim == 2 && B->ndim == 2) {
+        // dA += dC * B^T, dB += A^T * dC
         if (A->requires_grad) {
-            if (!A->grad) A->grad = (float *)calloc(A->size, sizeof(float));
-            for (size_t i = 0; i < A->shape[0]; i++) {
-                for (size_t j = 0; j < A->shape[1]; j++) {
-                    float acc = 0.0f;
-                    for (size_t k = 0; k < B->shape[1]; k++) {
-                        acc += output->grad[i * output->shape[1] + k] * B->data[j * B->shape[1] + k];
-                    }
-                    A->grad[i * A->shape[1] + j] += acc;
-                }
-            }
+            if (!A->grad) A->grad = (float *)buffer_calloc(A->size, sizeof(float));
+            sgemm(0, 1, A->shape[0], A->shape[1], B->shape[1],
+                  1.0f, output->grad, output->shape[1], B->data, B->shape[1], 1.0f, A->grad, A->shape[1]);
         }
         if (B->requires_grad) {
-            if (!B->grad) B->grad = (float *)calloc(B->size, sizeof(float));
-            for (size_t i = 0; i < B->shape[0]; i++) {
-                for (size_t j = 0; j < B->shape[1]; j++) {
-                    float acc = 0.0f;
-                    for (size_t k = 0; k < A->shape[0]; k++) {
-                        acc += A->data[k * A->shape[1] + i] * output->grad[k * output->shape[1] + j];
-                    }
-                    B->grad[i * B->shape[1] + j] += acc;
-                }
+            if (!B->grad) B->grad = (float *)buffer_calloc(B->size, sizeof(float));
+            sgemm(1, 0, B->shape[0], B->shape[1], A->shape[0],
+                  1.0f, A->data, A->shape[1], output->grad, output->shape[1], 1.0f, B->grad, B->shape[1]);
+        }
+    }
+}
+
+static Tensor* linear_impl(Tensor *X, Tensor *W, Tensor *b, const PackedMatrix *W_packed, const GemmBlocking *blocking) {
+    if (!X || !W || !b) return NULL;
+    if (W->ndim != 2 || (X->ndim != 1 && X->ndim != 2)) return NULL;
+
+    size_t K = W->shape[0], N = W->shape[1];
+    size_t M = X->ndim == 2 ? X->shape[0] : 1;
+    if (X->shape[X->ndim - 1] != K || b->size != N) return NULL;
+    if (W_packed && (W_packed->K != K || W_packed->N != N || W_packed->nr != gemm_panel_width())) return NULL;
+
+    Tensor *Z = X->ndim == 2 ? tensor_create((size_t[]){M, N}, 2) : tensor_create((size_t[]){N}, 1);
+    if (!Z) return NULL;
+
+    for (size_t i = 0; i < M; i++) {
+        memcpy(Z->data + i * N, b->data, N * sizeof(float));
+    }
+    // A few rows are matrix-vector products, which stream W faster unpacked
+    if (W_packed && M > GEMV_MAX_ROWS) {
+        sgemm_packed(0, M, 1.0f, X->data, K, W_packed, 1.0f, Z->data, N, blocking);
+    } else {
+        sgemm_blocked(0, 0, M, N, K, 1.0f, X->data, K, W->data, N, 1.0f, Z->data, N, blocking);
+    }
+
+    grad_update_three_vars(X, W, b, Z, NULL, "linear", backward_linear);
+    return Z;
+}
+
+Tensor* tensor_linear(Tensor *X, Tensor *W, Tensor *b, const GemmBlocking *blocking) {
+    return linear_impl(X, W, b, NULL, blocking);
+}
+
+Tensor* tensor_linear_packed(Tensor *X, Tensor *W, Tensor *b, const PackedMatrix *W_packed, const GemmBlocking *blocking) {
+    if (!W_packed) return NULL;
+    return linear_impl(X, W, b, W_packed, blocking);
+}
+
+void backward_linear(Tensor *Z) {
+    if (!Z || Z->num_inputs != 3) return;
+
+    Tensor *X = Z->inputs[0];
+    Tensor *W = Z->inputs[1];
+    Tensor *b = Z->inputs[2];
+    size_t K = W->shape[0], N = W->shape[1];
+    size_t M = X->ndim == 2 ? X->shape[0] : 1;
+
+    // dX += dZ * W^T, dW += X^T * dZ, db += column sums of dZ
+    if (X->requires_grad) {
+        if (!X->grad) X->grad = (float *)buffer_calloc(X->size, sizeof(float));
+        sgemm(0, 1, M, K, N, 1.0f, Z->grad, N, W->data, N, 1.0f, X->grad, K);
+    }
+    if (W->requires_grad) {
+        if (!W->grad) W->grad = (float *)buffer_calloc(W->size, sizeof(float));
+        sgemm(1, 0, K, N, M, 1.0f, X->data, K, Z->grad, N, 1.0f, W->grad, N);
+    }
+    if (b->requires_grad) {
+        if (!b->grad) b->grad = (float *)buffer_calloc(b->size, sizeof(float));
+        for (size_t i = 0; i < M; i++) {
+            for (size_t j = 0; j < N; j++) {
+                b->grad[j] += Z->grad[i * N + j];
             }
         }
     }
@@ -361,11 +355,7 @@ Tensor* tensor_transpose2d(Tensor *A) {
     Tensor *C = tensor_create(C_shape, 2);
     if (!C) return NULL;
 
-    for (size_t i = 0; i < A->shape[0]; i++) {
-        for (size_t j = 0; j < A->shape[1]; j++) {
-            C->data[j * C->shape[1] + i] = A->data[i * A->shape[1] + j]; 
-        }
-    }
+    matrix_transpose(A->shape[0], A->shape[1], A->data, A->shape[1], C->data, C->shape[1]);
 
     grad_update_one_var(A, C, NULL, "transpose2d", backward_transpose2d);
 
@@ -376,12 +366,8 @@ void backward_transpose2d(Tensor *C) {
     Tensor *A = C->inputs[0];
     
     if (A->requires_grad) {
-        if (!A->grad) A->grad = (float *)calloc(A->size, sizeof(float));
-        for (size_t i = 0; i < A->shape[0]; i++) {
-            for (size_t j = 0; j < A->shape[1]; j++) {
-                A->grad[i * A->shape[1] + j] += C->grad[j * A->shape[0] + i];
-            }
-        }
+        if (!A->grad) A->grad = (float *)buffer_calloc(A->size, sizeof(float));
+        matrix_transpose_add(A->shape[1], A->shape[0], C->grad, A->shape[0], A->grad, A->shape[1]);
     }
 }
 
@@ -410,8 +396,14 @@ Tensor* tensor_sigmoid(Tensor *Z) {
     Tensor *A = tensor_create(Z->shape, Z->ndim);
     if (!A) return NULL;
 
-    for (size_t i = 0; i < Z->size; i++) {
-        A->data[i] = 1.0f / (1.0f + expf(-Z->data[i])); 
+    if (numerics_config().fast_math) {
+        for (size_t i = 0; i < Z->size; i++) A->data[i] = -Z->data[i];
+        vec_expf(A->data, A->data, A->size);
+        for (size_t i = 0; i < Z->size; i++) A->data[i] = 1.0f / (1.0f + A->data[i]);
+    } else {
+        for (size_t i = 0; i < Z->size; i++) {
+            A->data[i] = 1.0f / (1.0f + expf(-Z->data[i])); 
+        }
     }
 
     grad_update_one_var(Z, A, NULL, "sigmoid", backward_sigmoid);
@@ -423,7 +415,7 @@ void backward_relu(Tensor *A) {
     Tensor *Z = A->inputs[0];
     
     if (Z->requires_grad) {
-        if (!Z->grad) Z->grad = (float *)calloc(Z->size, sizeof(float));
+        if (!Z->grad) Z->grad = (float *)buffer_calloc(Z->size, sizeof(float));
         for (size_t i = 0; i < Z->size; i++) {
             Z->grad[i] += A->grad[i] * (Z->data[i] > 0 ? 1.0f : 0.0f);
         }
@@ -449,7 +441,7 @@ void backward_tanh(Tensor *A) {
     Tensor *Z = A->inputs[0];
     
     if (Z->requires_grad) {
-        if (!Z->grad) Z->grad = (float *)calloc(Z->size, sizeof(float));
+        if (!Z->grad) Z->grad = (float *)buffer_calloc(Z->size, sizeof(float));
         for (size_t i = 0; i < Z->size; i++) {
             float t = A->data[i];
             Z->grad[i] += A->grad[i] * (1.0f - t * t);
@@ -461,7 +453,7 @@ void backward_sigmoid(Tensor *A) {
     Tensor *Z = A->inputs[0];
     
     if (Z->requires_grad) {
-        if (!Z->grad) Z->grad = (float *)calloc(Z->size, sizeof(float));
+        if (!Z->grad) Z->grad = (float *)buffer_calloc(Z->size, sizeof(float));
         for (size_t i = 0; i < Z->size; i++) {
             float sig = A->data[i];
             Z->grad[i] += A->grad[i] * sig * (1.0f - sig);
@@ -478,6 +470,8 @@ Tensor* tensor_softmax(Tensor *Z) {
     size_t batch_size = (Z->ndim == 2) ? Z->shape[0] : 1;
     size_t num_classes = (Z->ndim == 2) ? Z->shape[1] : Z->size;
 
+    int fast_math = numerics_config().fast_math;
+
     for (size_t b = 0; b < batch_size; b++) {
         size_t offset = b * num_classes;
         
@@ -487,9 +481,15 @@ Tensor* tensor_softmax(Tensor *Z) {
         }
 
         float sum = 0.0f;
-        for (size_t i = 0; i < num_classes; i++) {
-            A->data[offset + i] = expf(Z->data[offset + i] - max_val);
-            sum += A->data[offset + i];
+        if (fast_math) {
+            for (size_t i = 0; i < num_classes; i++) A->data[offset + i] = Z->data[offset + i] - max_val;
+            vec_expf(A->data + offset, A->data + offset, num_classes);
+            for (size_t i = 0; i < num_classes; i++) sum += A->data[offset + i];
+        } else {
+            for (size_t i = 0; i < num_classes; i++) {
+                A->data[offset + i] = expf(Z->data[offset + i] - max_val);
+                sum += A->data[offset + i];
+            }
         }
 
         for (size_t i = 0; i < num_classes; i++) {
@@ -506,7 +506,7 @@ void backward_softmax(Tensor *A) {
     Tensor *Z = A->inputs[0];
     
     if (Z->requires_grad) {
-        if (!Z->grad) Z->grad = (float *)calloc(Z->size, sizeof(float));
+        if (!Z->grad) Z->grad = (float *)buffer_calloc(Z->size, sizeof(float));
         
         size_t batch_size = (Z->ndim == 2) ? Z->shape[0] : 1;
         size_t num_classes = (Z->ndim == 2) ? Z->shape[1] : Z->size;
@@ -549,7 +549,7 @@ Tensor* tensor_mse(Tensor *predictions, Tensor *targets) {
     }
     loss->data[0] = sum_sq_error / predictions->size;
     
-    if (predictions->requires_grad || targets->requires_grad) {
+    if (tensor_grad_enabled() && (predictions->requires_grad || targets->requires_grad)) {
         loss->requires_grad = 1;
         loss->op_name = strdup("mse");
         loss->num_inputs = 2;
@@ -568,7 +568,7 @@ void backward_mse(Tensor *L) {
 
     if (predictions->requires_grad) {
         if (!predictions->grad) 
-            predictions->grad = (float *)calloc(predictions->size, sizeof(float));
+            predictions->grad = (float *)buffer_calloc(predictions->size, sizeof(float));
         for (size_t i = 0; i < predictions->size; i++) {
             predictions->grad[i] += 
                 (2.0f / predictions->size) * (predictions->data[i] - targets->data[i]) * L->grad[0];
@@ -577,7 +577,7 @@ void backward_mse(Tensor *L) {
 
     if (targets->requires_grad) {
         if (!targets->grad) 
-            targets->grad = (float *)calloc(targets->size, sizeof(float));
+            targets->grad = (float *)buffer_calloc(targets->size, sizeof(float));
         for (size_t i = 0; i < targets->size; i++) {
             targets->grad[i] -= 
                 (2.0f / targets->size) * (predictions->data[i] - targets->data[i]) * L->grad[0];
@@ -601,7 +601,7 @@ Tensor* tensor_cross_entropy(Tensor *predictions, Tensor *targets) {
     }
     loss->data[0] = sum_ce_loss / predictions->size;
     
-    if (predictions->requires_grad || targets->requires_grad) {
+    if (tensor_grad_enabled() && (predictions->requires_grad || targets->requires_grad)) {
         loss->requires_grad = 1;
         loss->op_name = strdup("cross_entropy");
         loss->num_inputs = 2;
@@ -621,7 +621,7 @@ void backward_cross_entropy(Tensor *L) {
 
     if (predictions->requires_grad) {
         if (!predictions->grad) 
-            predictions->grad = (float *)calloc(predictions->size, sizeof(float));
+            predictions->grad = (float *)buffer_calloc(predictions->size, sizeof(float));
         for (size_t i = 0; i < predictions->size; i++) {
             float pred = predictions->data[i];
             pred = pred < epsilon ? epsilon : (pred > 1.0f - epsilon ? 1.0f - epsilon : pred);
@@ -632,7 +632,7 @@ void backward_cross_entropy(Tensor *L) {
 
     if (targets->requires_grad) {
         if (!targets->grad) 
-            targets->grad = (float *)calloc(targets->size, sizeof(float));
+            targets->grad = (float *)buffer_calloc(targets->size, sizeof(float));
         for (size_t i = 0; i < targets->size; i++) {
             float pred = predictions->data[i];
             pred = pred < epsilon ? epsilon : pred;
@@ -658,7 +658,7 @@ Tensor* tensor_binary_cross_entropy(Tensor *predictions, Tensor *targets) {
     }
     loss->data[0] = sum_bce_loss / predictions->size;
     
-    if (predictions->requires_grad || targets->requires_grad) {
+    if (tensor_grad_enabled() && (predictions->requires_grad || targets->requires_grad)) {
         loss->requires_grad = 1;
         loss->op_name = strdup("binary_cross_entropy");
         loss->num_inputs = 2;
@@ -678,7 +678,7 @@ void backward_binary_cross_entropy(Tensor *L) {
 
     if (predictions->requires_grad) {
         if (!predictions->grad) 
-            predictions->grad = (float *)calloc(predictions->size, sizeof(float));
+            predictions->grad = (float *)buffer_calloc(predictions->size, sizeof(float));
         for (size_t i = 0; i < predictions->size; i++) {
             float pred = predictions->data[i];
             pred = pred < epsilon ? epsilon : (pred > 1.0f - epsilon ? 1.0f - epsilon : pred);
@@ -690,7 +690,7 @@ void backward_binary_cross_entropy(Tensor *L) {
 
     if (targets->requires_grad) {
         if (!targets->grad) 
-            targets->grad = (float *)calloc(targets->size, sizeof(float));
+            targets->grad = (float *)buffer_calloc(targets->size, sizeof(float));
         for (size_t i = 0; i < targets->size; i++) {
             float pred = predictions->data[i];
             pred = pred < epsilon ? epsilon : (pred > 1.0f - epsilon ? 1.0f - epsilon : pred);
@@ -700,6 +700,56 @@ void backward_binary_cross_entropy(Tensor *L) {
     }
 }
 
+Tensor* tensor_bce_with_logits(Tensor *logits, Tensor *targets) {
+    if (!check_pred_target(logits, targets)) return NULL;
+
+    Tensor *loss = tensor_create((size_t[]){1}, 1);
+    if (!loss) return NULL;
+
+    // -y log s(x) - (1 - y) log(1 - s(x)) = max(x, 0) - x y + log(1 + e^-|x|)
+    float sum_bce_loss = 0.0f;
+    for (size_t i = 0; i < logits->size; i++) {
+        float x = logits->data[i];
+        sum_bce_loss += fmaxf(x, 0.0f) - x * targets->data[i] + log1pf(expf(-fabsf(x)));
+    }
+    loss->data[0] = sum_bce_loss / logits->size;
+
+    if (tensor_grad_enabled() && (logits->requires_grad || targets->requires_grad)) {
+        loss->requires_grad = 1;
+        loss->op_name = strdup("bce_with_logits");
+        loss->num_inputs = 2;
+        loss->inputs = (Tensor **)malloc(2 * sizeof(Tensor *));
+        loss->inputs[0] = logits;
+        loss->inputs[1] = targets;
+        loss->backward_fn = backward_bce_with_logits;
+    }
+
+    return loss;
+}
+
+void backward_bce_with_logits(Tensor *L) {
+    Tensor *logits = L->inputs[0];
+    Tensor *targets = L->inputs[1];
+    float scale = L->grad[0] / logits->size;
+
+    if (logits->requires_grad) {
+        if (!logits->grad) logits->grad = (float *)buffer_calloc(logits->size, sizeof(float));
+        for (size_t i = 0; i < logits->size; i++) {
+            float x = logits->data[i];
+            float e = expf(-fabsf(x));
+            float s = x >= 0.0f ? 1.0f / (1.0f + e) : e / (1.0f + e);
+            logits->grad[i] += (s - targets->data[i]) * scale;
+        }
+    }
+
+    if (targets->requires_grad) {
+        if (!targets->grad) targets->grad = (float *)buffer_calloc(targets->size, sizeof(float));
+        for (size_t i = 0; i < targets->size; i++) {
+            targets->grad[i] -= logits->data[i] * scale;
+        }
+    }
+}
+
 // ====================================================
 // Slice
 // ====================================================
@@ -735,13 +785,14 @@ Tensor* tensor_slice(Tensor *input, size_t start, size_t end) {
 
     slice->owns_data = 0; 
     
-    slice->requires_grad = input->requires_grad; 
+    slice->requires_grad = tensor_grad_enabled() && input->requires_grad; 
 
     slice->op_name = NULL; 
     slice->inputs = NULL; 
     slice->num_inputs = 0; 
     slice->backward_fn = NULL; 
     slice->extra_data = NULL; 
+    slice->version = 0;
 
     return slice;
 }
@@ -750,20 +801,30 @@ Tensor* tensor_slice(Tensor *input, size_t start, size_t end) {
 // Operation Registration
 // ====================================================
 
-void ops_register_builtins(void) {
-    register_loss("mse", tensor_mse);
-    register_loss("cross_entropy", tensor_cross_entropy);
-    register_loss("binary_cross_entropy", tensor_binary_cross_entropy);
-    register_tensor_op("add", backward_add);
-    register_tensor_op("sub", backward_sub);
-    register_tensor_op("mul", backward_mul);
-    register_tensor_op("matmul", backward_matmul);
-    register_tensor_op("transpose2d", backward_transpose2d);
-    register_tensor_op("relu", backward_relu);
-    register_tensor_op("sigmoid", backward_sigmoid);
-    register_tensor_op("tanh", backward_tanh);
-    register_tensor_op("softmax", backward_softmax);
-    register_tensor_op("mse", backward_mse);
-    register_tensor_op("cross_entropy", backward_cross_entropy);
-    register_tensor_op("binary_cross_entropy", backward_binary_cross_entropy);
-}
\ No newline at end of file
+// Sorted by name
+const BuiltinOperation builtin_operations[] = {
+    { "bce_with_logits", tensor_bce_with_logits },
+    { "binary_cross_entropy", tensor_binary_cross_entropy },
+    { "cross_entropy", tensor_cross_entropy },
+    { "mse", tensor_mse },
+};
+const size_t num_builtin_operations = sizeof(builtin_operations) / sizeof(builtin_operations[0]);
+
+// Sorted by name
+const BuiltinTensorOp builtin_tensor_ops[] = {
+    { "add", backward_add },
+    { "bce_with_logits", backward_bce_with_logits },
+    { "binary_cross_entropy", backward_binary_cross_entropy },
+    { "cross_entropy", backward_cross_entropy },
+    { "linear", backward_linear },
+    { "matmul", backward_matmul },
+    { "mse", backward_mse },
+    { "mul", backward_mul },
+    { "relu", backward_relu },
+    { "sigmoid", backward_sigmoid },
+    { "softmax", backward_softmax },
+    { "sub", backward_sub },
+    { "tanh", backward_tanh },
+    { "transpose2d", backward_transpose2d },
+};
+const size_t num_builtin_tensor_ops = sizeof(builtin_tensor_ops) / sizeof(builtin_tensor_ops[0]);
\ No newline at end of file
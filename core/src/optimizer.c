@@ -146,10 +146,12 @@ static void adam_free_state(void *state, size_t num_parameters) {
 // Optimizer Registration
 // ====================================================
 
-void optimizer_register_builtins(void) {
-    register_optimizer("sgd", sgd_init_state, sgd_step, sgd_free_state);
-    register_optimizer("adam", adam_init_state, adam_step, adam_free_state);
-}
+// Sorted by name
+const BuiltinOptimizer builtin_optimizers[] = {
+    { "adam", adam_init_state, adam_step, adam_free_state },
+    { "sgd", sgd_init_state, sgd_step, sgd_free_state },
+};
+const size_t num_builtin_optimizers = sizeof(builtin_optimizers) / sizeof(builtin_optimizers[0]);
 
 // ====================================================
 // Optimizer Operations
@@ -189,6 +191,10 @@ Optimizer* optimizer_create(Tensor **parameters, size_t num_parameters, Optimize
 void optimizer_step(Optimizer *opt) {
     if (!opt || !opt->step) return;
     opt->step(opt);
+
+    for (size_t i = 0; i < opt->num_parameters; i++) {
+        tensor_mark_modified(opt->parameters[i]);
+    }
 }
 
 void optimizer_zero_grad(Optimizer *opt) {
@@ -0,0 +1,539 @@
+#include "../include/plan.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PLAN_MAGIC 0x4C504442 // "BDPL"
+#define PLAN_VERSION 3
+#define PACKED_SECTION_MAGIC 0x4B434150 // "PACK"
+#define PACKED_SECTION_VERSION 2
+#define PLAN_TUNE_REPEATS 3
+
+static const size_t tune_mc[] = { 48, 96, 192 };
+static const size_t tune_kc[] = { 128, 256, 512 };
+
+// ====================================================
+// Fingerprinting
+// ====================================================
+
+static inline uint64_t hash_mix(uint64_t h, uint64_t w) {
+    h ^= w * 0x9E3779B97F4A7C15ULL;
+    h = (h << 31) | (h >> 33);
+    return h * 0x87C37B91114253D5ULL;
+}
+
+static uint64_t hash_bytes(uint64_t h, const void *data, size_t len) {
+    const unsigned char *p = (const unsigned char *)data;
+    size_t words = len / 8;
+
+    for (size_t i = 0; i < words; i++) {
+        uint64_t w;
+        memcpy(&w, p + i * 8, 8);
+        h = hash_mix(h, w);
+    }
+
+    uint64_t tail = 0;
+    memcpy(&tail, p + words * 8, len - words * 8);
+    return hash_mix(h, tail ^ ((uint64_t)len << 56));
+}
+
+uint64_t network_fingerprint(Network *net) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    if (!net) return h;
+
+    h = hash_mix(h, kernels_cpu_features());
+    h = hash_mix(h, net->num_layers);
+
+    // Raw config structs are left out: their padding bytes are indeterminate,
+    // and whatever in them shapes a plan already shows in the parameter shapes
+    for (size_t i = 0; i < net->num_layers; i++) {
+        Layer *layer = net->layers[i];
+        h = hash_bytes(h, layer->name, strlen(layer->name));
+        h = hash_mix(h, layer->num_parameters);
+
+        for (size_t p = 0; p < layer->num_parameters; p++) {
+            Tensor *param = layer->parameters[p];
+            h = hash_mix(h, param->ndim);
+            for (size_t d = 0; d < param->ndim; d++) h = hash_mix(h, param->shape[d]);
+        }
+    }
+
+    return h;
+}
+
+uint64_t network_weights_fingerprint(Network *net) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    if (!net) return h;
+
+    for (size_t i = 0; i < net->num_parameters; i++) {
+        Tensor *param = net->parameters[i];
+        h = hash_bytes(h, param->data, param->size * sizeof(float));
+    }
+    return h;
+}
+
+// ====================================================
+// Planning
+// ====================================================
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int layer_is_linear(Layer *layer) {
+    return strcmp(layer->name, "linear") == 0 && layer->weights && layer->bias && layer->weights->ndim == 2;
+}
+
+// Picks the fastest blocking for X [M, K] * W [K, N]. Candidates beyond the
+// problem size behave identically, so only the first of those is timed.
+static GemmBlocking tune_gemm(size_t M, size_t K, size_t N, const float *W) {
+    GemmBlocking best = gemm_default_blocking();
+    float *X = (float *)malloc(M * K * sizeof(float));
+    float *C = (float *)malloc(M * N * sizeof(float));
+    if (!X || !C) {
+        free(X);
+        free(C);
+        return best;
+    }
+    for (size_t i = 0; i < M * K; i++) X[i] = (float)(i % 7) * 0.25f - 0.75f;
+
+    double best_time = -1.0;
+    for (size_t a = 0; a < sizeof(tune_mc) / sizeof(tune_mc[0]); a++) {
+        if (a > 0 && tune_mc[a - 1] >= M) break;
+
+        for (size_t b = 0; b < sizeof(tune_kc) / sizeof(tune_kc[0]); b++) {
+            if (b > 0 && tune_kc[b - 1] >= K) break;
+
+            GemmBlocking candidate = { tune_mc[a], tune_kc[b], best.nc };
+            double fastest = -1.0;
+            for (int r = 0; r < PLAN_TUNE_REPEATS; r++) {
+                double start = now_seconds();
+                sgemm_blocked(0, 0, M, N, K, 1.0f, X, K, W, N, 0.0f, C, N, &candidate);
+                double elapsed = now_seconds() - start;
+                if (fastest < 0.0 || elapsed < fastest) fastest = elapsed;
+            }
+
+            if (best_time < 0.0 || fastest < best_time) {
+                best_time = fastest;
+                best = candidate;
+            }
+        }
+    }
+
+    free(X);
+    free(C);
+    return best;
+}
+
+static NetworkPlan* plan_build(Network *net, size_t batch_size) {
+    NetworkPlan *plan = (NetworkPlan *)malloc(sizeof(NetworkPlan));
+    if (!plan) return NULL;
+
+    plan->fingerprint = network_fingerprint(net);
+    plan->cpu_features = kernels_cpu_features();
+    plan->batch_size = batch_size;
+    plan->num_layers = net->num_layers;
+    plan->next = NULL;
+    plan->layers = (LayerPlan *)calloc(net->num_layers ? net->num_layers : 1, sizeof(LayerPlan));
+    if (!plan->layers) {
+        free(plan);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < net->num_layers; i++) {
+        Layer *layer = net->layers[i];
+        if (!layer_is_linear(layer)) continue;
+
+        size_t K = layer->weights->shape[0], N = layer->weights->shape[1];
+        LayerPlan *lp = &plan->layers[i];
+        lp->kind = LAYER_PLAN_LINEAR;
+        lp->blocking = tune_gemm(batch_size, K, N, layer->weights->data);
+    }
+
+    return plan;
+}
+
+NetworkPlan* network_plan_build(Network *net, size_t batch_size) {
+    if (!net || batch_size == 0) return NULL;
+
+    NetworkPlan *plan = plan_build(net, batch_size);
+    if (plan && !network_plan_pack(net, plan)) {
+        network_plan_free(plan);
+        return NULL;
+    }
+    return plan;
+}
+
+int network_plan_pack(Network *net, NetworkPlan *plan) {
+    if (!net || !plan) return 0;
+
+    for (NetworkPlan *p = plan; p; p = p->next) {
+        if (p->num_layers != net->num_layers) return 0;
+
+        for (size_t i = 0; i < p->num_layers; i++) {
+            LayerPlan *lp = &p->layers[i];
+            if (lp->kind != LAYER_PLAN_LINEAR || lp->packed_weights) continue;
+            if (!layer_is_linear(net->layers[i])) return 0;
+
+            Tensor *W = net->layers[i]->weights;
+            unsigned long version = tensor_version(W);
+
+            // A smaller bucket tuned to the same kc already holds these panels
+            for (NetworkPlan *q = plan; q != p && !lp->packed_weights; q = q->next) {
+                LayerPlan *other = &q->layers[i];
+                if (other->packed_weights && !other->shared_packed && other->blocking.kc == lp->blocking.kc &&
+                    other->weights_version == version) {
+                    lp->packed_weights = other->packed_weights;
+                    lp->shared_packed = 1;
+                }
+            }
+
+            size_t K = W->shape[0], N = W->shape[1];
+            if (!lp->packed_weights) lp->packed_weights = sgemm_pack_b(0, K, N, W->data, N, lp->blocking.kc);
+            lp->weights_version = version;
+        }
+    }
+    return 1;
+}
+
+void network_plan_free(NetworkPlan *plan) {
+    while (plan) {
+        NetworkPlan *next = plan->next;
+        for (size_t i = 0; i < plan->num_layers; i++) {
+            if (!plan->layers[i].shared_packed) packed_matrix_free(plan->layers[i].packed_weights);
+        }
+        free(plan->layers);
+        free(plan);
+        plan = next;
+    }
+}
+
+int network_set_plan(Network *net, NetworkPlan *plan) {
+    if (!net || !plan) return 0;
+
+    for (NetworkPlan *p = plan; p; p = p->next) {
+        if (p->num_layers != net->num_layers) return 0;
+
+        for (size_t i = 0; i < net->num_layers; i++) {
+            LayerPlan *lp = &p->layers[i];
+            if (lp->kind != LAYER_PLAN_LINEAR) continue;
+            if (!layer_is_linear(net->layers[i])) return 0;
+
+            Tensor *W = net->layers[i]->weights;
+            if (lp->packed_weights && (lp->packed_weights->K != W->shape[0] || lp->packed_weights->N != W->shape[1])) {
+                return 0;
+            }
+        }
+    }
+
+    if (net->plan && net->plan != plan) network_plan_free(net->plan);
+    net->plan = plan;
+    return 1;
+}
+
+// The smallest bucket holding rows, or the largest bucket
+static NetworkPlan* plan_for_rows(NetworkPlan *plan, size_t rows) {
+    while (plan->next && plan->batch_size < rows) plan = plan->next;
+    return plan;
+}
+
+Tensor* network_plan_forward_layer(Network *net, size_t index, Tensor *input) {
+    if (!net || !net->plan || !input || index >= net->plan->num_layers) return NULL;
+
+    size_t rows = input->ndim > 1 ? input->size / input->shape[input->ndim - 1] : 1;
+    LayerPlan *lp = &plan_for_rows(net->plan, rows)->layers[index];
+    Layer *layer = net->layers[index];
+
+    // Panels packed before the last weight update are stale, but the tuned
+    // blocking still applies
+    switch (lp->kind) {
+        case LAYER_PLAN_LINEAR:
+            if (lp->packed_weights && lp->weights_version == tensor_version(layer->weights)) {
+                return tensor_linear_packed(input, layer->weights, layer->bias, lp->packed_weights, &lp->blocking);
+            }
+            return tensor_linear(input, layer->weights, layer->bias, &lp->blocking);
+        default:
+            return NULL;
+    }
+}
+
+// ====================================================
+// Save/Load
+// ====================================================
+
+static int write_packed(FILE *file, const PackedMatrix *P) {
+    uint64_t dims[4] = { P->K, P->N, P->kc, P->nr };
+    return fwrite(dims, sizeof(uint64_t), 4, file) == 4
+        && fwrite(P->data, sizeof(float), P->size, file) == P->size;
+}
+
+// Returns NULL on a read error or if the panels target another kernel width
+static PackedMatrix* read_packed(FILE *file) {
+    uint64_t dims[4];
+    if (fread(dims, sizeof(uint64_t), 4, file) != 4) return NULL;
+    if (dims[3] != gemm_panel_width()) return NULL;
+
+    PackedMatrix *P = packed_matrix_alloc((size_t)dims[0], (size_t)dims[1], (size_t)dims[2]);
+    if (!P) return NULL;
+    if (fread(P->data, sizeof(float), P->size, file) != P->size) {
+        packed_matrix_free(P);
+        return NULL;
+    }
+    return P;
+}
+
+int network_plan_save(NetworkPlan *plan, const char *file_path) {
+    if (!plan || !file_path) return 0;
+
+    FILE *file = fopen(file_path, "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open file %s for writing\n", file_path);
+        return 0;
+    }
+
+    uint32_t header[2] = { PLAN_MAGIC, PLAN_VERSION };
+    uint64_t fields[3] = { plan->fingerprint, plan->batch_size, plan->num_layers };
+    int ok = fwrite(header, sizeof(uint32_t), 2, file) == 2
+          && fwrite(&plan->cpu_features, sizeof(uint32_t), 1, file) == 1
+          && fwrite(fields, sizeof(uint64_t), 3, file) == 3;
+
+    for (size_t i = 0; ok && i < plan->num_layers; i++) {
+        LayerPlan *lp = &plan->layers[i];
+        uint32_t kind = (uint32_t)lp->kind;
+        uint64_t blocking[3] = { lp->blocking.mc, lp->blocking.kc, lp->blocking.nc };
+        ok = fwrite(&kind, sizeof(uint32_t), 1, file) == 1
+          && fwrite(blocking, sizeof(uint64_t), 3, file) == 3;
+    }
+
+    if (fclose(file) != 0) ok = 0;
+    if (!ok) fprintf(stderr, "Error: Could not write plan to %s\n", file_path);
+    return ok;
+}
+
+NetworkPlan* network_plan_load(const char *file_path) {
+    if (!file_path) return NULL;
+
+    FILE *file = fopen(file_path, "rb");
+    if (!file) return NULL;
+
+    uint32_t header[2], cpu_features;
+    uint64_t fields[3];
+    if (fread(header, sizeof(uint32_t), 2, file) != 2 || header[0] != PLAN_MAGIC || header[1] != PLAN_VERSION ||
+        fread(&cpu_features, sizeof(uint32_t), 1, file) != 1 ||
+        fread(fields, sizeof(uint64_t), 3, file) != 3) {
+        fprintf(stderr, "Error: Invalid plan file %s\n", file_path);
+        fclose(file);
+        return NULL;
+    }
+
+    NetworkPlan *plan = (NetworkPlan *)malloc(sizeof(NetworkPlan));
+    if (!plan) {
+        fclose(file);
+        return NULL;
+    }
+    plan->fingerprint = fields[0];
+    plan->cpu_features = cpu_features;
+    plan->batch_size = (size_t)fields[1];
+    plan->num_layers = (size_t)fields[2];
+    plan->next = NULL;
+    plan->layers = (LayerPlan *)calloc(plan->num_layers ? plan->num_layers : 1, sizeof(LayerPlan));
+    if (!plan->layers) {
+        free(plan);
+        fclose(file);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < plan->num_layers; i++) {
+        uint32_t kind;
+        uint64_t blocking[3];
+        if (fread(&kind, sizeof(uint32_t), 1, file) != 1 || fread(blocking, sizeof(uint64_t), 3, file) != 3 ||
+            kind > LAYER_PLAN_LINEAR) {
+            fprintf(stderr, "Error: Truncated plan file %s\n", file_path);
+            network_plan_free(plan);
+            fclose(file);
+            return NULL;
+        }
+        plan->layers[i].kind = (LayerPlanKind)kind;
+        plan->layers[i].blocking.mc = (size_t)blocking[0];
+        plan->layers[i].blocking.kc = (size_t)blocking[1];
+        plan->layers[i].blocking.nc = (size_t)blocking[2];
+    }
+
+    fclose(file);
+    return plan;
+}
+
+static NetworkPlan* load_or_build(Network *net, const char *cache_dir, uint64_t fingerprint, size_t batch_size) {
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%016llx-%zu.plan", cache_dir, (unsigned long long)fingerprint, batch_size);
+
+    NetworkPlan *plan = network_plan_load(path);
+    if (plan && (plan->fingerprint != fingerprint || plan->cpu_features != kernels_cpu_features() ||
+                 plan->batch_size != batch_size)) {
+        network_plan_free(plan);
+        plan = NULL;
+    }
+
+    if (!plan) {
+        plan = plan_build(net, batch_size);
+        if (!plan) return NULL;
+
+        // Publish with a rename so concurrent processes never read a partial plan
+        char tmp_path[4200];
+        snprintf(tmp_path, sizeof(tmp_path), "%s.tmp.%ld", path, (long)getpid());
+        if (network_plan_save(plan, tmp_path)) {
+            if (rename(tmp_path, path) != 0) remove(tmp_path);
+        } else {
+            remove(tmp_path);
+        }
+    }
+
+    return plan;
+}
+
+int network_plan_cached(Network *net, const char *cache_dir, size_t batch_size) {
+    if (!net || !cache_dir || batch_size == 0) return 0;
+
+    NetworkPlan *plan = load_or_build(net, cache_dir, network_fingerprint(net), batch_size);
+    if (!plan) return 0;
+
+    if (!network_plan_pack(net, plan) || !network_set_plan(net, plan)) {
+        network_plan_free(plan);
+        return 0;
+    }
+    return 1;
+}
+
+// ====================================================
+// Batch Buckets
+// ====================================================
+
+size_t plan_bucket(size_t rows) {
+    size_t bucket = 1;
+    while (bucket < rows) bucket <<= 1;
+    return bucket;
+}
+
+int network_plan_cached_buckets(Network *net, const char *cache_dir, size_t max_batch) {
+    if (!net || !cache_dir || max_batch == 0) return 0;
+
+    uint64_t fingerprint = network_fingerprint(net);
+    NetworkPlan *head = NULL, *tail = NULL;
+
+    for (size_t bucket = 1; bucket <= plan_bucket(max_batch); bucket <<= 1) {
+        NetworkPlan *plan = load_or_build(net, cache_dir, fingerprint, bucket);
+        if (!plan) {
+            network_plan_free(head);
+            return 0;
+        }
+
+        if (tail) tail->next = plan;
+        else head = plan;
+        tail = plan;
+    }
+
+    if (!network_plan_pack(net, head) || !network_set_plan(net, head)) {
+        network_plan_free(head);
+        return 0;
+    }
+    return 1;
+}
+
+// ====================================================
+// Model File Section
+// ====================================================
+
+// Whether layer i of plan holds panels packed from net's current weights
+static int packed_current(Network *net, NetworkPlan *plan, size_t i) {
+    LayerPlan *lp = &plan->layers[i];
+    return lp->packed_weights && i < net->num_layers && net->layers[i]->weights &&
+           lp->weights_version == tensor_version(net->layers[i]->weights);
+}
+
+int network_plan_write_packed(Network *net, FILE *file) {
+    if (!net || !net->plan || !file) return 0;
+    NetworkPlan *plan = net->plan;
+
+    uint64_t count = 0;
+    for (size_t i = 0; i < plan->num_layers; i++) {
+        if (packed_current(net, plan, i)) count++;
+    }
+    if (count == 0) return 1;
+
+    uint32_t header[2] = { PACKED_SECTION_MAGIC, PACKED_SECTION_VERSION };
+    uint64_t weights = network_weights_fingerprint(net);
+    int ok = fwrite(header, sizeof(uint32_t), 2, file) == 2
+          && fwrite(&count, sizeof(uint64_t), 1, file) == 1
+          && fwrite(&weights, sizeof(uint64_t), 1, file) == 1;
+
+    for (size_t i = 0; ok && i < plan->num_layers; i++) {
+        LayerPlan *lp = &plan->layers[i];
+        if (!packed_current(net, plan, i)) continue;
+
+        uint64_t fields[3] = { i, lp->blocking.mc, lp->blocking.nc };
+        ok = fwrite(fields, sizeof(uint64_t), 3, file) == 3 && write_packed(file, lp->packed_weights);
+    }
+    return ok;
+}
+
+int network_plan_read_packed(Network *net, FILE *file) {
+    if (!net || !file) return 0;
+
+    uint32_t header[2];
+    uint64_t count, weights;
+    if (fread(header, sizeof(uint32_t), 2, file) != 2 || header[0] != PACKED_SECTION_MAGIC ||
+        header[1] != PACKED_SECTION_VERSION || fread(&count, sizeof(uint64_t), 1, file) != 1 ||
+        fread(&weights, sizeof(uint64_t), 1, file) != 1) {
+        return 0;
+    }
+
+    // Panels packed from other weights than the ones loaded would silently
+    // compute with the old model
+    if (weights != network_weights_fingerprint(net)) return 0;
+
+    NetworkPlan *plan = (NetworkPlan *)malloc(sizeof(NetworkPlan));
+    if (!plan) return 0;
+    plan->fingerprint = 0;
+    plan->cpu_features = kernels_cpu_features();
+    plan->batch_size = 0;
+    plan->num_layers = net->num_layers;
+    plan->next = NULL;
+    plan->layers = (LayerPlan *)calloc(net->num_layers ? net->num_layers : 1, sizeof(LayerPlan));
+    if (!plan->layers) {
+        free(plan);
+        return 0;
+    }
+
+    for (uint64_t e = 0; e < count; e++) {
+        uint64_t fields[3];
+        if (fread(fields, sizeof(uint64_t), 3, file) != 3 || fields[0] >= net->num_layers ||
+            !layer_is_linear(net->layers[fields[0]])) {
+            network_plan_free(plan);
+            return 0;
+        }
+
+        LayerPlan *lp = &plan->layers[fields[0]];
+        packed_matrix_free(lp->packed_weights);
+        lp->packed_weights = read_packed(file);
+        if (!lp->packed_weights) {
+            network_plan_free(plan);
+            return 0;
+        }
+        lp->kind = LAYER_PLAN_LINEAR;
+        lp->weights_version = tensor_version(net->layers[fields[0]]->weights);
+        lp->blocking.mc = (size_t)fields[1];
+        lp->blocking.kc = lp->packed_weights->kc;
+        lp->blocking.nc = (size_t)fields[2];
+    }
+
+    plan->fingerprint = network_fingerprint(net);
+    if (!network_set_plan(net, plan)) {
+        network_plan_free(plan);
+        return 0;
+    }
+    return 1;
+}
@@ -4,225 +4,324 @@
 #include "../include/ops.h"
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
 // ====================================================
 // Register Helpers
 // ====================================================
 
-#define REGISTRY_SIZE 64
-
-typedef struct RegistryEntry {
+// Each registry is an immutable open-addressed table. Writers build a new
+// table under registry_lock and publish it; readers load the current table
+// and probe it without locking. Superseded tables go on a retired list so a
+// lookup racing with a registration always sees a complete table. Readers
+// count themselves in while probing, and the list is freed by the first
+// registration that finds no reader active after publishing.
+
+#define REGISTRY_MIN_CAPACITY 64
+
+typedef union RegistryValue {
+    struct {
+        LayerCreateFn create_fn;
+        LayerForwardFn forward_fn;
+    } layer;
+    struct {
+        OpFn op_fn;
+        int priority;
+    } op;
+    BackwardFn backward_fn;
+    struct {
+        OptimizerInitStateFn init_state_fn;
+        OptimizerStepFn step_fn;
+        OptimizerFreeStateFn free_state_fn;
+    } optimizer;
+} RegistryValue;
+
+typedef struct RegistrySlot {
     char *key;
-    void *value;
-    struct RegistryEntry *next;
-} RegistryEntry;
+    unsigned int hash;
+    RegistryValue value;
+} RegistrySlot;
+
+typedef struct RegistryTable {
+    size_t capacity;    // power of two, kept at most half full
+    size_t count;
+    struct RegistryTable *retired;
+    RegistrySlot slots[];
+} RegistryTable;
 
 typedef struct {
-    RegistryEntry *buckets[REGISTRY_SIZE];
+    RegistryTable *table;
+    unsigned long readers;
 } Registry;
 
+// Returns non-zero if incoming should replace existing
+typedef int (*RegistryAcceptFn)(const RegistryValue *existing, const RegistryValue *incoming);
+
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
 static unsigned int hash(const char *str) {
     unsigned int hash = 5381;
     int c;
     while ((c = *str++)) {
         hash = ((hash << 5) + hash) + c;
     }
-    return hash % REGISTRY_SIZE;
+    return hash;
+}
+
+static RegistrySlot* table_find(RegistryTable *table, const char *key, unsigned int h) {
+    size_t mask = table->capacity - 1;
+    for (size_t i = h & mask;; i = (i + 1) & mask) {
+        RegistrySlot *slot = &table->slots[i];
+        if (!slot->key) return slot;
+        if (slot->hash == h && strcmp(slot->key, key) == 0) return slot;
+    }
 }
 
-static void registry_set(Registry *reg, const char *key, void *value) {
-    unsigned int idx = hash(key);
-    RegistryEntry *entry = reg->buckets[idx];
-    
-    while (entry) {
-        if (strcmp(entry->key, key) == 0) {
-            entry->value = value;
+static RegistryTable* table_create(size_t capacity) {
+    RegistryTable *table = calloc(1, sizeof(RegistryTable) + capacity * sizeof(RegistrySlot));
+    if (table) table->capacity = capacity;
+    return table;
+}
+
+static void registry_set(Registry *reg, const char *key, const RegistryValue *value, RegistryAcceptFn accept) {
+    unsigned int h = hash(key);
+
+    pthread_mutex_lock(&registry_lock);
+    RegistryTable *old = reg->table;
+
+    if (old) {
+        RegistrySlot *slot = table_find(old, key, h);
+        if (slot->key && accept && !accept(&slot->value, value)) {
+            pthread_mutex_unlock(&registry_lock);
             return;
         }
-        entry = entry->next;
     }
-    
-    entry = malloc(sizeof(RegistryEntry));
-    entry->key = strdup(key);
-    entry->value = value;
-    entry->next = reg->buckets[idx];
-    reg->buckets[idx] = entry;
-}
-
-static void* registry_get(Registry *reg, const char *key) {
-    unsigned int idx = hash(key);
-    RegistryEntry *entry = reg->buckets[idx];
-    
-    while (entry) {
-        if (strcmp(entry->key, key) == 0) {
-            return entry->value;
+
+    size_t capacity = old ? old->capacity : REGISTRY_MIN_CAPACITY;
+    size_t count = old ? old->count : 0;
+    if ((count + 1) * 2 > capacity) capacity *= 2;
+
+    RegistryTable *table = table_create(capacity);
+    if (!table) {
+        pthread_mutex_unlock(&registry_lock);
+        return;
+    }
+
+    // Keys are shared between table versions and freed once at cleanup
+    if (old) {
+        for (size_t i = 0; i < old->capacity; i++) {
+            if (old->slots[i].key) {
+                *table_find(table, old->slots[i].key, old->slots[i].hash) = old->slots[i];
+            }
+        }
+        table->count = old->count;
+    }
+
+    RegistrySlot *slot = table_find(table, key, h);
+    if (!slot->key) {
+        slot->key = strdup(key);
+        slot->hash = h;
+        table->count++;
+    }
+    slot->value = *value;
+
+    table->retired = old;
+    __atomic_store_n(&reg->table, table, __ATOMIC_SEQ_CST);
+
+    // A reader that counts itself in after this point loads the new table,
+    // so with none counted in no one can still hold a retired one
+    if (__atomic_load_n(&reg->readers, __ATOMIC_SEQ_CST) == 0) {
+        RegistryTable *retired = table->retired;
+        while (retired) {
+            RegistryTable *next = retired->retired;
+            free(retired);
+            retired = next;
         }
-        entry = entry->next;
+        table->retired = NULL;
     }
-    return NULL;
+    pthread_mutex_unlock(&registry_lock);
+}
+
+static int registry_get(Registry *reg, const char *key, RegistryValue *out) {
+    if (!key) return 0;
+
+    __atomic_add_fetch(&reg->readers, 1, __ATOMIC_SEQ_CST);
+    RegistryTable *table = __atomic_load_n(&reg->table, __ATOMIC_SEQ_CST);
+
+    int found = 0;
+    if (table) {
+        RegistrySlot *slot = table_find(table, key, hash(key));
+        if (slot->key) {
+            *out = slot->value;
+            found = 1;
+        }
+    }
+
+    __atomic_sub_fetch(&reg->readers, 1, __ATOMIC_SEQ_CST);
+    return found;
 }
 
+static int builtin_compare(const void *key, const void *entry) {
+    return strcmp((const char *)key, *(const char * const *)entry);
+}
+
+// Builtin entries all start with their name and are sorted by it
+static const void* builtin_find(const void *table, size_t count, size_t stride, const char *key) {
+    if (!key) return NULL;
+    return bsearch(key, table, count, stride, builtin_compare);
+}
+
+// Not safe against concurrent lookups; call once no other thread uses the registry
 static void registry_free(Registry *reg) {
-    for (int i = 0; i < REGISTRY_SIZE; i++) {
-        RegistryEntry *entry = reg->buckets[i];
-        while (entry) {
-            RegistryEntry *next = entry->next;
-            free(entry->key);
-            free(entry);
-            entry = next;
+    pthread_mutex_lock(&registry_lock);
+    RegistryTable *table = reg->table;
+    if (table) {
+        for (size_t i = 0; i < table->capacity; i++) {
+            free(table->slots[i].key);
         }
-        reg->buckets[i] = NULL;
     }
+    while (table) {
+        RegistryTable *retired = table->retired;
+        free(table);
+        table = retired;
+    }
+    __atomic_store_n(&reg->table, NULL, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&registry_lock);
 }
 
 // ====================================================
 // Layer Registers
 // ====================================================
 
-typedef struct {
-    LayerCreateFn create_fn;
-    LayerForwardFn forward_fn;
-} LayerRegistryEntry;
-
-static Registry layer_registry = {{NULL}};
+static Registry layer_registry = {NULL, 0};
 
 void register_layer(const char *name, LayerCreateFn create_fn, LayerForwardFn forward_fn) {
-    LayerRegistryEntry *entry = malloc(sizeof(LayerRegistryEntry));
-    entry->create_fn = create_fn;
-    entry->forward_fn = forward_fn;
-    registry_set(&layer_registry, name, entry);
+    RegistryValue value = { .layer = { create_fn, forward_fn } };
+    registry_set(&layer_registry, name, &value, NULL);
+}
+
+static int layer_lookup(const char *name, RegistryValue *value) {
+    if (registry_get(&layer_registry, name, value)) return 1;
+
+    const BuiltinLayer *builtin = builtin_find(builtin_layers, num_builtin_layers, sizeof(BuiltinLayer), name);
+    if (!builtin) return 0;
+    value->layer.create_fn = builtin->create_fn;
+    value->layer.forward_fn = builtin->forward_fn;
+    return 1;
 }
 
 LayerCreateFn get_layer_create_fn(const char *name) {
-    LayerRegistryEntry *entry = registry_get(&layer_registry, name);
-    return entry ? entry->create_fn : NULL;
+    RegistryValue value;
+    return layer_lookup(name, &value) ? value.layer.create_fn : NULL;
 }
 
 LayerForwardFn get_layer_forward_fn(const char *name) {
-    LayerRegistryEntry *entry = registry_get(&layer_registry, name);
-    return entry ? entry->forward_fn : NULL;
+    RegistryValue value;
+    return layer_lookup(name, &value) ? value.layer.forward_fn : NULL;
 }
 
 // ====================================================
 // Operation Registers
 // ====================================================
 
-typedef struct {
-    OpFn op_fn;
-    int priority;
-} OperationRegistryEntry;
+static Registry operation_registry = {NULL, 0};
 
-static Registry operation_registry = {{NULL}};
+static int accept_higher_priority(const RegistryValue *existing, const RegistryValue *incoming) {
+    return incoming->op.priority > existing->op.priority;
+}
 
 void register_operation(const char *name, OpFn op_fn) {
     register_operation_backend(name, op_fn, 0);
 }
 
 void register_operation_backend(const char *name, OpFn op_fn, int priority) {
-    OperationRegistryEntry *existing = (OperationRegistryEntry*)registry_get(&operation_registry, name);
-    
-    if (!existing || priority > existing->priority) {
-        OperationRegistryEntry *entry = malloc(sizeof(OperationRegistryEntry));
-        entry->op_fn = op_fn;
-        entry->priority = priority;
-        registry_set(&operation_registry, name, entry);
+    RegistryValue value = { .op = { op_fn, priority } };
+
+    // Builtins have priority 0 and are only replaced by a higher priority backend
+    if (priority <= 0 && builtin_find(builtin_operations, num_builtin_operations, sizeof(BuiltinOperation), name)) {
+        return;
     }
+    registry_set(&operation_registry, name, &value, accept_higher_priority);
 }
 
 OpFn get_operation_fn(const char *name) {
-    OperationRegistryEntry *entry = (OperationRegistryEntry*)registry_get(&operation_registry, name);
-    return entry ? entry->op_fn : NULL;
+    RegistryValue value;
+    if (registry_get(&operation_registry, name, &value)) return value.op.op_fn;
+
+    const BuiltinOperation *builtin = builtin_find(builtin_operations, num_builtin_operations, sizeof(BuiltinOperation), name);
+    return builtin ? builtin->op_fn : NULL;
 }
 
 // ====================================================
 // Tensor Operation Registers
 // ====================================================
 
-static Registry tensor_op_registry = {{NULL}};
+static Registry tensor_op_registry = {NULL, 0};
 
 void register_tensor_op(const char *name, BackwardFn backward_fn) {
-    registry_set(&tensor_op_registry, name, (void*)backward_fn);
+    RegistryValue value = { .backward_fn = backward_fn };
+    registry_set(&tensor_op_registry, name, &value, NULL);
 }
 
 BackwardFn get_tensor_op_backward_fn(const char *name) {
-    return (BackwardFn)registry_get(&tensor_op_registry, name);
+    RegistryValue value;
+    if (registry_get(&tensor_op_registry, name, &value)) return value.backward_fn;
+
+    const BuiltinTensorOp *builtin = builtin_find(builtin_tensor_ops, num_builtin_tensor_ops, sizeof(BuiltinTensorOp), name);
+    return builtin ? builtin->backward_fn : NULL;
 }
 
 // ====================================================
 // Optimizer Registers
 // ====================================================
 
-typedef struct {
-    OptimizerInitStateFn init_state_fn;
-    OptimizerStepFn step_fn;
-    OptimizerFreeStateFn free_state_fn;
-} OptimizerRegistryEntry;
-
-static Registry optimizer_registry = {{NULL}};
+static Registry optimizer_registry = {NULL, 0};
 
 void register_optimizer(const char *name,
                        OptimizerInitStateFn init_state_fn,
                        OptimizerStepFn step_fn,
                        OptimizerFreeStateFn free_state_fn) {
-    OptimizerRegistryEntry *entry = malloc(sizeof(OptimizerRegistryEntry));
-    entry->init_state_fn = init_state_fn;
-    entry->step_fn = step_fn;
-    entry->free_state_fn = free_state_fn;
-    registry_set(&optimizer_registry, name, entry);
+    RegistryValue value = { .optimizer = { init_state_fn, step_fn, free_state_fn } };
+    registry_set(&optimizer_registry, name, &value, NULL);
+}
+
+static int optimizer_lookup(const char *name, RegistryValue *value) {
+    if (registry_get(&optimizer_registry, name, value)) return 1;
+
+    const BuiltinOptimizer *builtin = builtin_find(builtin_optimizers, num_builtin_optimizers, sizeof(BuiltinOptimizer), name);
+    if (!builtin) return 0;
+    value->optimizer.init_state_fn = builtin->init_state_fn;
+    value->optimizer.step_fn = builtin->step_fn;
+    value->optimizer.free_state_fn = builtin->free_state_fn;
+    return 1;
 }
 
 OptimizerInitStateFn get_optimizer_init_state_fn(const char *name) {
-    OptimizerRegistryEntry *entry = registry_get(&optimizer_registry, name);
-    return entry ? entry->init_state_fn : NULL;
+    RegistryValue value;
+    return optimizer_lookup(name, &value) ? value.optimizer.init_state_fn : NULL;
 }
 
 OptimizerStepFn get_optimizer_step_fn(const char *name) {
-    OptimizerRegistryEntry *entry = registry_get(&optimizer_registry, name);
-    return entry ? entry->step_fn : NULL;
+    RegistryValue value;
+    return optimizer_lookup(name, &value) ? value.optimizer.step_fn : NULL;
 }
 
 OptimizerFreeStateFn get_optimizer_free_state_fn(const char *name) {
-    OptimizerRegistryEntry *entry = registry_get(&optimizer_registry, name);
-    return entry ? entry->free_state_fn : NULL;
+    RegistryValue value;
+    return optimizer_lookup(name, &value) ? value.optimizer.free_state_fn : NULL;
 }
 
 // ====================================================
 // Registry Initialization
 // ====================================================
 
+// Builtins are constant tables, so there is nothing to set up
 void registry_init() {
-    layer_register_builtins();
-    ops_register_builtins();
-    optimizer_register_builtins();
 }
 
 void registry_cleanup() {
-    for (int i = 0; i < REGISTRY_SIZE; i++) {
-        RegistryEntry *entry = layer_registry.buckets[i];
-        while (entry) {
-            free(entry->value);
-            entry = entry->next;
-        }
-    }
     registry_free(&layer_registry);
-    
-    for (int i = 0; i < REGISTRY_SIZE; i++) {
-        RegistryEntry *entry = operation_registry.buckets[i];
-        while (entry) {
-            free(entry->value);
-            entry = entry->next;
-        }
-    }
     registry_free(&operation_registry);
-    
     registry_free(&tensor_op_registry);
-    
-    for (int i = 0; i < REGISTRY_SIZE; i++) {
-        RegistryEntry *entry = optimizer_registry.buckets[i];
-        while (entry) {
-            free(entry->value);
-            entry = entry->next;
-        }
-    }
     registry_free(&optimizer_registry);
 }
@@ -0,0 +1,362 @@
+#include "../include/telemetry.h"
+#include "../include/alloc.h"
+#include "../include/threadpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+
+#define MAX_OPS 128
+#define OP_NAME_LEN 48
+#define NUM_BUCKETS 13
+
+static const double step_buckets[NUM_BUCKETS] = {
+    0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0
+};
+
+typedef struct OpStats {
+    char name[OP_NAME_LEN];
+    int backward;
+    uint64_t calls;
+    uint64_t nanos;
+} OpStats;
+
+typedef struct Metrics {
+    uint64_t steps;
+    uint64_t samples;
+    uint64_t step_nanos;
+    uint64_t step_buckets[NUM_BUCKETS + 1];  // last one is +Inf
+    float loss;
+
+    OpStats ops[MAX_OPS];
+    size_t num_ops;                         // published with release
+    pthread_mutex_t ops_lock;               // serializes adding ops
+} Metrics;
+
+typedef struct Writer {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    int running;
+    int stop;
+    char *path;
+    unsigned interval_ms;
+
+    // Previous snapshot, for the samples/sec gauge
+    uint64_t last_samples;
+    double last_time;
+    double samples_per_second;
+} Writer;
+
+static Metrics metrics = { .ops_lock = PTHREAD_MUTEX_INITIALIZER };
+static Writer writer = { .lock = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER };
+static int enabled = 0;
+
+double telemetry_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t to_nanos(double seconds) {
+    return seconds > 0.0 ? (uint64_t)(seconds * 1e9) : 0;
+}
+
+// ====================================================
+// Recording
+// ====================================================
+
+void telemetry_record_step(size_t samples, double seconds, float loss) {
+    size_t bucket = 0;
+    while (bucket < NUM_BUCKETS && seconds > step_buckets[bucket]) bucket++;
+
+    __atomic_add_fetch(&metrics.steps, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&metrics.samples, samples, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&metrics.step_nanos, to_nanos(seconds), __ATOMIC_RELAXED);
+    __atomic_add_fetch(&metrics.step_buckets[bucket], 1, __ATOMIC_RELAXED);
+    __atomic_store(&metrics.loss, &loss, __ATOMIC_RELAXED);
+}
+
+static OpStats* find_op(const char *op, int backward) {
+    size_t n = __atomic_load_n(&metrics.num_ops, __ATOMIC_ACQUIRE);
+    for (size_t i = 0; i < n; i++) {
+        if (metrics.ops[i].backward == backward && strcmp(metrics.ops[i].name, op) == 0) return &metrics.ops[i];
+    }
+
+    // Not seen yet: look again under the lock, since another thread may be adding it
+    pthread_mutex_lock(&metrics.ops_lock);
+    OpStats *found = NULL;
+    n = metrics.num_ops;
+    for (size_t i = 0; i < n && !found; i++) {
+        if (metrics.ops[i].backward == backward && strcmp(metrics.ops[i].name, op) == 0) found = &metrics.ops[i];
+    }
+    if (!found && n < MAX_OPS) {
+        found = &metrics.ops[n];
+        snprintf(found->name, OP_NAME_LEN, "%s", op);
+        found->backward = backward;
+        __atomic_store_n(&metrics.num_ops, n + 1, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&metrics.ops_lock);
+    return found;
+}
+
+void telemetry_record_op(const char *op, int backward, double seconds) {
+    OpStats *stats = find_op(op ? op : "unknown", backward != 0);
+    if (!stats) return;
+
+    __atomic_add_fetch(&stats->calls, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&stats->nanos, to_nanos(seconds), __ATOMIC_RELAXED);
+}
+
+// ====================================================
+// Exposition
+// ====================================================
+
+static void write_header(FILE *file, const char *name, const char *type, const char *help) {
+    fprintf(file, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+// Label values may hold any layer name; quote what the format requires
+static void write_label(FILE *file, const char *value) {
+    for (const char *c = value; *c; c++) {
+        if (*c == '\\' || *c == '"') fputc('\\', file);
+        if (*c == '\n') {
+            fputs("\\n", file);
+            continue;
+        }
+        fputc(*c, file);
+    }
+}
+
+static void write_threadpool(FILE *file, ThreadPool *pool) {
+    size_t num_threads = threadpool_num_threads(pool);
+    ThreadPoolStats stats = threadpool_stats(pool);
+
+    write_header(file, "basednn_threadpool_threads", "gauge", "Threads in the default pool, including the caller.");
+    fprintf(file, "basednn_threadpool_threads %zu\n", num_threads);
+    write_header(file, "basednn_threadpool_regions_total", "counter", "Parallel-for calls, by whether they were split.");
+    fprintf(file, "basednn_threadpool_regions_total{kind=\"parallel\"} %llu\n", (unsigned long long)stats.parallel_regions);
+    fprintf(file, "basednn_threadpool_regions_total{kind=\"serial\"} %llu\n", (unsigned long long)stats.serial_regions);
+    write_header(file, "basednn_threadpool_utilization", "gauge", "Share of worker time spent running chunks.");
+    fprintf(file, "basednn_threadpool_utilization %.6g\n", stats.utilization);
+    write_header(file, "basednn_threadpool_imbalance", "gauge", "Busiest thread over mean thread time in parallel regions.");
+    fprintf(file, "basednn_threadpool_imbalance{stat=\"mean\"} %.6g\n", stats.mean_imbalance);
+    fprintf(file, "basednn_threadpool_imbalance{stat=\"max\"} %.6g\n", stats.max_imbalance);
+
+    const char *series[4][2] = {
+        { "basednn_threadpool_busy_seconds_total", "Time each thread spent running chunks; thread 0 is the callers." },
+        { "basednn_threadpool_idle_seconds_total", "Time each worker spent waiting for work." },
+        { "basednn_threadpool_chunks_total", "Chunks run by each thread." },
+        { "basednn_threadpool_excess_chunks_total", "Chunks each thread took beyond an even share of its region." },
+    };
+    for (size_t k = 0; k < 4; k++) {
+        write_header(file, series[k][0], "counter", series[k][1]);
+        for (size_t t = 0; t < num_threads; t++) {
+            ThreadStats ts = threadpool_thread_stats(pool, t);
+            fprintf(file, "%s{thread=\"%zu\"} ", series[k][0], t);
+            switch (k) {
+                case 0: fprintf(file, "%.9g\n", ts.busy_seconds); break;
+                case 1: fprintf(file, "%.9g\n", ts.idle_seconds); break;
+                case 2: fprintf(file, "%llu\n", (unsigned long long)ts.chunks); break;
+                default: fprintf(file, "%llu\n", (unsigned long long)ts.excess_chunks); break;
+            }
+        }
+    }
+}
+
+static void write_metrics(FILE *file, double samples_per_second) {
+    uint64_t steps = __atomic_load_n(&metrics.steps, __ATOMIC_RELAXED);
+    uint64_t samples = __atomic_load_n(&metrics.samples, __ATOMIC_RELAXED);
+    uint64_t step_nanos = __atomic_load_n(&metrics.step_nanos, __ATOMIC_RELAXED);
+    float loss;
+    __atomic_load(&metrics.loss, &loss, __ATOMIC_RELAXED);
+
+    write_header(file, "basednn_train_steps_total", "counter", "Optimizer steps taken.");
+    fprintf(file, "basednn_train_steps_total %llu\n", (unsigned long long)steps);
+    write_header(file, "basednn_train_samples_total", "counter", "Training samples processed.");
+    fprintf(file, "basednn_train_samples_total %llu\n", (unsigned long long)samples);
+    write_header(file, "basednn_train_samples_per_second", "gauge", "Training throughput since the previous snapshot.");
+    fprintf(file, "basednn_train_samples_per_second %.6g\n", samples_per_second);
+    write_header(file, "basednn_train_loss", "gauge", "Loss of the most recent step.");
+    fprintf(file, "basednn_train_loss %.9g\n", (double)loss);
+
+    write_header(file, "basednn_train_step_seconds", "histogram", "Wall time of one training step.");
+    uint64_t cumulative = 0;
+    for (size_t b = 0; b <= NUM_BUCKETS; b++) {
+        cumulative += __atomic_load_n(&metrics.step_buckets[b], __ATOMIC_RELAXED);
+        if (b < NUM_BUCKETS) {
+            fprintf(file, "basednn_train_step_seconds_bucket{le=\"%g\"} %llu\n", step_buckets[b], (unsigned long long)cumulative);
+        } else {
+            fprintf(file, "basednn_train_step_seconds_bucket{le=\"+Inf\"} %llu\n", (unsigned long long)cumulative);
+        }
+    }
+    fprintf(file, "basednn_train_step_seconds_sum %.9g\n", (double)step_nanos * 1e-9);
+    fprintf(file, "basednn_train_step_seconds_count %llu\n", (unsigned long long)cumulative);
+
+    BufferStats buffers = buffer_stats();
+    write_header(file, "basednn_buffer_huge_page_bytes", "gauge",
+                 "Bytes in live huge page buffer mappings; malloc-backed buffers are not counted.");
+    fprintf(file, "basednn_buffer_huge_page_bytes %zu\n", buffers.mapped_bytes);
+    write_header(file, "basednn_buffer_huge_buffers", "gauge", "Live buffers on huge page mappings.");
+    fprintf(file, "basednn_buffer_huge_buffers %zu\n", buffers.huge_buffers);
+
+    write_threadpool(file, threadpool_default());
+
+    size_t num_ops = __atomic_load_n(&metrics.num_ops, __ATOMIC_ACQUIRE);
+    const char *kinds[2][2] = {
+        { "basednn_op_seconds_total", "Time spent in each op." },
+        { "basednn_op_calls_total", "Calls of each op." },
+    };
+    for (size_t k = 0; k < 2; k++) {
+        write_header(file, kinds[k][0], "counter", kinds[k][1]);
+        for (size_t i = 0; i < num_ops; i++) {
+            OpStats *op = &metrics.ops[i];
+            fprintf(file, "%s{op=\"", kinds[k][0]);
+            write_label(file, op->name);
+            fprintf(file, "\",pass=\"%s\"} ", op->backward ? "backward" : "forward");
+            if (k == 0) {
+                fprintf(file, "%.9g\n", (double)__atomic_load_n(&op->nanos, __ATOMIC_RELAXED) * 1e-9);
+            } else {
+                fprintf(file, "%llu\n", (unsigned long long)__atomic_load_n(&op->calls, __ATOMIC_RELAXED));
+            }
+        }
+    }
+}
+
+static int write_snapshot(const char *path, double samples_per_second) {
+    size_t len = strlen(path);
+    char *tmp = (char *)malloc(len + 5);
+    if (!tmp) return 0;
+    memcpy(tmp, path, len);
+    memcpy(tmp + len, ".tmp", 5);
+
+    FILE *file = fopen(tmp, "w");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open telemetry file %s: %s\n", tmp, strerror(errno));
+        free(tmp);
+        return 0;
+    }
+
+    write_metrics(file, samples_per_second);
+    int ok = fflush(file) == 0 && !ferror(file);
+    ok = fclose(file) == 0 && ok;
+    ok = ok && rename(tmp, path) == 0;
+    if (!ok) {
+        fprintf(stderr, "Error: Could not write telemetry file %s\n", path);
+        remove(tmp);
+    }
+
+    free(tmp);
+    return ok;
+}
+
+int telemetry_write(const char *path) {
+    if (!path) return 0;
+    pthread_mutex_lock(&writer.lock);
+    double rate = writer.samples_per_second;
+    pthread_mutex_unlock(&writer.lock);
+    return write_snapshot(path, rate);
+}
+
+// ====================================================
+// Writer Thread
+// ====================================================
+
+// Called with writer.lock held
+static void writer_tick(void) {
+    double now = telemetry_now();
+    uint64_t samples = __atomic_load_n(&metrics.samples, __ATOMIC_RELAXED);
+    if (now > writer.last_time) {
+        writer.samples_per_second = (double)(samples - writer.last_samples) / (now - writer.last_time);
+    }
+    writer.last_samples = samples;
+    writer.last_time = now;
+    write_snapshot(writer.path, writer.samples_per_second);
+}
+
+static void* writer_main(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&writer.lock);
+    while (!writer.stop) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += writer.interval_ms / 1000;
+        deadline.tv_nsec += (long)(writer.interval_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        while (!writer.stop) {
+            if (pthread_cond_timedwait(&writer.cond, &writer.lock, &deadline) == ETIMEDOUT) break;
+        }
+        writer_tick();
+    }
+    pthread_mutex_unlock(&writer.lock);
+    return NULL;
+}
+
+int telemetry_enabled(void) {
+    return __atomic_load_n(&enabled, __ATOMIC_RELAXED);
+}
+
+int telemetry_start(TelemetryConfig config) {
+    if (!config.path || !*config.path) return 0;
+    telemetry_stop();
+
+    pthread_mutex_lock(&writer.lock);
+    writer.path = strdup(config.path);
+    writer.interval_ms = config.interval_ms ? config.interval_ms : 1;
+    writer.stop = 0;
+    writer.last_samples = __atomic_load_n(&metrics.samples, __ATOMIC_RELAXED);
+    writer.last_time = telemetry_now();
+    writer.samples_per_second = 0.0;
+
+    if (!writer.path || pthread_create(&writer.thread, NULL, writer_main, NULL) != 0) {
+        fprintf(stderr, "Error: Failed to start telemetry writer\n");
+        free(writer.path);
+        writer.path = NULL;
+        pthread_mutex_unlock(&writer.lock);
+        return 0;
+    }
+    writer.running = 1;
+    pthread_mutex_unlock(&writer.lock);
+
+    __atomic_store_n(&enabled, 1, __ATOMIC_RELAXED);
+    return 1;
+}
+
+void telemetry_stop(void) {
+    pthread_mutex_lock(&writer.lock);
+    if (!writer.running) {
+        pthread_mutex_unlock(&writer.lock);
+        return;
+    }
+    __atomic_store_n(&enabled, 0, __ATOMIC_RELAXED);
+    writer.stop = 1;
+    pthread_cond_signal(&writer.cond);
+    pthread_mutex_unlock(&writer.lock);
+
+    // The writer finishes with one last snapshot on its way out
+    pthread_join(writer.thread, NULL);
+
+    pthread_mutex_lock(&writer.lock);
+    writer.running = 0;
+    free(writer.path);
+    writer.path = NULL;
+    pthread_mutex_unlock(&writer.lock);
+}
+
+void telemetry_init(void) {
+    const char *path = getenv("BASEDNN_TELEMETRY_FILE");
+    if (!path || !*path) return;
+
+    TelemetryConfig config = TELEMETRY_DEFAULTS(path);
+    const char *env = getenv("BASEDNN_TELEMETRY_INTERVAL_MS");
+    if (env && atoi(env) > 0) config.interval_ms = (unsigned)atoi(env);
+    telemetry_start(config);
+}
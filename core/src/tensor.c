@@ -1,9 +1,13 @@
 #include "../include/tensor.h"
+#include "../include/alloc.h"
+#include "../include/telemetry.h"
 #include <stdlib.h> 
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
 
+static __thread int grad_disabled = 0;
+
 // ====================================================
 // TopoSort
 // ====================================================
@@ -49,7 +53,7 @@ Tensor* tensor_create(size_t *shape, size_t ndim) {
         T->size *= shape[i]; 
     }
 
-    T->data = (float *)malloc(T->size * sizeof(float)); 
+    T->data = (float *)buffer_alloc(T->size * sizeof(float)); 
     if (!T->data) {
         free(T->shape);
         free(T);
@@ -64,6 +68,7 @@ Tensor* tensor_create(size_t *shape, size_t ndim) {
     T->num_inputs = 0;
     T->backward_fn = NULL;
     T->extra_data = NULL;
+    T->version = 0;
     return T; 
 }
 
@@ -102,8 +107,8 @@ void tensor_free(Tensor *T) {
     if (!T) return; 
 
     if (T->owns_data) {
-        if (T->data) free(T->data); 
-        if (T->grad) free(T->grad); 
+        buffer_free(T->data);
+        buffer_free(T->grad);
     }
 
     if (T->shape) free(T->shape); 
@@ -130,7 +135,7 @@ void tensor_backward(Tensor *T) {
     if (!T || !T->requires_grad) return; 
 
     if (!T->grad) {
-        T->grad = (float *)malloc(T->size * sizeof(float)); 
+        T->grad = (float *)buffer_alloc(T->size * sizeof(float)); 
         for (size_t i = 0; i < T->size; i++) {
             T->grad[i] = 1.0f; 
         }
@@ -144,10 +149,13 @@ void tensor_backward(Tensor *T) {
 
     topological_sort_util(T, visited, &visited_count, stack, &stack_count, max_size); 
 
+    int timed = telemetry_enabled();
     for (size_t i = stack_count; i > 0; i--) {
         Tensor *node = stack[i - 1]; 
         if (node->backward_fn) {
+            double start = timed ? telemetry_now() : 0.0;
             node->backward_fn(node);
+            if (timed) telemetry_record_op(node->op_name, 1, telemetry_now() - start);
         }
     }
 
@@ -155,6 +163,14 @@ void tensor_backward(Tensor *T) {
     free(stack); 
 }
 
+void tensor_set_grad_enabled(int enabled) {
+    grad_disabled = !enabled;
+}
+
+int tensor_grad_enabled(void) {
+    return !grad_disabled;
+}
+
 void tensor_zero_grad(Tensor *T) {
     if (!T || !T->grad) return;
     memset(T->grad, 0, T->size * sizeof(float));
@@ -165,6 +181,17 @@ void tensor_fill(Tensor *T, float value) {
     for (size_t i = 0; i < T->size; i++) {
         T->data[i] = value;
     }
+    tensor_mark_modified(T);
+}
+
+// Relaxed is enough: readers on other threads only compare the counter with
+// one they saved, and any ordering with the data itself is the caller's job
+void tensor_mark_modified(Tensor *T) {
+    if (T) __atomic_add_fetch(&T->version, 1, __ATOMIC_RELAXED);
+}
+
+unsigned long tensor_version(Tensor *T) {
+    return T ? __atomic_load_n(&T->version, __ATOMIC_RELAXED) : 0;
 }
 
 // ====================================================
@@ -0,0 +1,364 @@
+#include "../include/threadpool.h"
+#include "../include/numerics.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+
+#define CHUNKS_PER_THREAD 4
+
+// ====================================================
+// Pool State
+// ====================================================
+
+typedef struct ParallelJob {
+    ParallelForFn fn;
+    void *ctx;
+    size_t n;
+    size_t chunk;
+    size_t num_chunks;
+    size_t next_chunk;
+    size_t helpers_wanted;
+    size_t helpers_running;
+    size_t fair_share;          // chunks per thread if all helpers joined
+    uint64_t busy_sum_ns;
+    uint64_t busy_max_ns;
+    size_t participants;
+    struct ParallelJob *next;
+} ParallelJob;
+
+// Counters are only written by their own thread, except slot 0, which every
+// caller shares; all access is atomic so stats can be read at any time.
+typedef struct ThreadSlot {
+    uint64_t busy_ns;
+    uint64_t idle_ns;
+    uint64_t chunks;
+    uint64_t excess_chunks;
+} ThreadSlot;
+
+struct ThreadPool {
+    pthread_t *workers;
+    size_t num_workers;
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;
+    pthread_cond_t done_cond;
+    ParallelJob *jobs;
+    int shutdown;
+
+    ThreadSlot *slots;          // num_workers + 1
+    size_t next_slot;
+    uint64_t parallel_regions;
+    uint64_t serial_regions;
+    double imbalance_sum;       // guarded by lock
+    double imbalance_max;
+};
+
+static __thread int in_worker = 0;
+
+static ThreadPool *default_pool = NULL;
+static pthread_mutex_t default_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// ====================================================
+// Job Helpers
+// ====================================================
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void job_run_chunks(ParallelJob *job, ThreadSlot *slot) {
+    uint64_t start_ns = now_ns();
+    size_t ran = 0;
+
+    for (;;) {
+        size_t c = __atomic_fetch_add(&job->next_chunk, 1, __ATOMIC_RELAXED);
+        if (c >= job->num_chunks) break;
+
+        size_t start = c * job->chunk;
+        size_t end = start + job->chunk < job->n ? start + job->chunk : job->n;
+        job->fn(job->ctx, start, end);
+        ran++;
+    }
+
+    uint64_t busy = now_ns() - start_ns;
+    __atomic_add_fetch(&slot->busy_ns, busy, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&slot->chunks, ran, __ATOMIC_RELAXED);
+    if (ran > job->fair_share) __atomic_add_fetch(&slot->excess_chunks, ran - job->fair_share, __ATOMIC_RELAXED);
+
+    // Helpers that arrive after the last chunk was claimed did no work and
+    // are left out of the region's balance
+    if (ran == 0) return;
+    __atomic_add_fetch(&job->busy_sum_ns, busy, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&job->participants, 1, __ATOMIC_RELAXED);
+    uint64_t max = __atomic_load_n(&job->busy_max_ns, __ATOMIC_RELAXED);
+    while (busy > max && !__atomic_compare_exchange_n(&job->busy_max_ns, &max, busy, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+static void job_unlink(ThreadPool *pool, ParallelJob *job) {
+    ParallelJob **link = &pool->jobs;
+    while (*link) {
+        if (*link == job) {
+            *link = job->next;
+            return;
+        }
+        link = &(*link)->next;
+    }
+}
+
+static void* worker_main(void *arg) {
+    ThreadPool *pool = (ThreadPool *)arg;
+    in_worker = 1;
+    numerics_sync_thread();
+
+    pthread_mutex_lock(&pool->lock);
+    ThreadSlot *slot = &pool->slots[++pool->next_slot];
+    for (;;) {
+        uint64_t idle_start = now_ns();
+        while (!pool->jobs && !pool->shutdown) {
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+        }
+        if (pool->shutdown) break;
+        __atomic_add_fetch(&slot->idle_ns, now_ns() - idle_start, __ATOMIC_RELAXED);
+
+        ParallelJob *job = pool->jobs;
+        job->helpers_wanted--;
+        job->helpers_running++;
+        if (job->helpers_wanted == 0) job_unlink(pool, job);
+        pthread_mutex_unlock(&pool->lock);
+
+        numerics_sync_thread();
+        job_run_chunks(job, slot);
+
+        pthread_mutex_lock(&pool->lock);
+        job->helpers_running--;
+        if (job->helpers_running == 0) pthread_cond_broadcast(&pool->done_cond);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+// ====================================================
+// Thread Pool Creation and Destruction
+// ====================================================
+
+ThreadPool* threadpool_create(size_t num_threads) {
+    ThreadPool *pool = (ThreadPool *)malloc(sizeof(ThreadPool));
+    if (!pool) return NULL;
+
+    pool->num_workers = num_threads > 1 ? num_threads - 1 : 0;
+    pool->workers = NULL;
+    pool->jobs = NULL;
+    pool->shutdown = 0;
+    pool->next_slot = 0;
+    pool->parallel_regions = 0;
+    pool->serial_regions = 0;
+    pool->imbalance_sum = 0.0;
+    pool->imbalance_max = 0.0;
+    pool->slots = (ThreadSlot *)calloc(pool->num_workers + 1, sizeof(ThreadSlot));
+    if (!pool->slots) {
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    if (pool->num_workers > 0) {
+        pool->workers = (pthread_t *)malloc(pool->num_workers * sizeof(pthread_t));
+        if (!pool->workers) {
+            pool->num_workers = 0;
+            return pool;
+        }
+    }
+
+    for (size_t i = 0; i < pool->num_workers; i++) {
+        if (pthread_create(&pool->workers[i], NULL, worker_main, pool) != 0) {
+            pool->num_workers = i;
+            break;
+        }
+    }
+
+    return pool;
+}
+
+void threadpool_free(ThreadPool *pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->num_workers; i++) {
+        pthread_join(pool->workers[i], NULL);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_cond_destroy(&pool->done_cond);
+    if (pool->workers) free(pool->workers);
+    free(pool->slots);
+    free(pool);
+}
+
+ThreadPool* threadpool_default(void) {
+    pthread_mutex_lock(&default_pool_lock);
+    if (!default_pool) {
+        long num_threads = 0;
+        const char *env = getenv("BASEDNN_NUM_THREADS");
+        if (env) num_threads = strtol(env, NULL, 10);
+        if (num_threads <= 0) num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+        if (num_threads <= 0) num_threads = 1;
+        default_pool = threadpool_create((size_t)num_threads);
+    }
+    pthread_mutex_unlock(&default_pool_lock);
+    return default_pool;
+}
+
+void threadpool_default_cleanup(void) {
+    pthread_mutex_lock(&default_pool_lock);
+    threadpool_free(default_pool);
+    default_pool = NULL;
+    pthread_mutex_unlock(&default_pool_lock);
+}
+
+// ====================================================
+// Parallel Execution
+// ====================================================
+
+static void parallel_run(ThreadPool *pool, size_t n, size_t grain, ParallelForFn fn, void *ctx) {
+    size_t num_threads = pool ? pool->num_workers + 1 : 1;
+    size_t num_chunks = (n + grain - 1) / grain;
+    if (num_chunks > num_threads * CHUNKS_PER_THREAD) num_chunks = num_threads * CHUNKS_PER_THREAD;
+
+    if (num_chunks <= 1 || num_threads == 1 || in_worker) {
+        if (pool) __atomic_add_fetch(&pool->serial_regions, 1, __ATOMIC_RELAXED);
+        fn(ctx, 0, n);
+        return;
+    }
+
+    ParallelJob job;
+    job.fn = fn;
+    job.ctx = ctx;
+    job.n = n;
+    job.chunk = (n + num_chunks - 1) / num_chunks;
+    job.num_chunks = (n + job.chunk - 1) / job.chunk;
+    job.next_chunk = 0;
+    job.helpers_wanted = job.num_chunks - 1 < pool->num_workers ? job.num_chunks - 1 : pool->num_workers;
+    job.helpers_running = 0;
+    job.fair_share = (job.num_chunks + job.helpers_wanted) / (job.helpers_wanted + 1);
+    job.busy_sum_ns = 0;
+    job.busy_max_ns = 0;
+    job.participants = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    job.next = pool->jobs;
+    pool->jobs = &job;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    job_run_chunks(&job, &pool->slots[0]);
+
+    // Helpers that have not started yet are no longer needed; only wait for
+    // the ones already running chunks.
+    pthread_mutex_lock(&pool->lock);
+    if (job.helpers_wanted > 0) {
+        job.helpers_wanted = 0;
+        job_unlink(pool, &job);
+    }
+    while (job.helpers_running > 0) {
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    }
+
+    double mean = (double)job.busy_sum_ns / (double)job.participants;
+    double imbalance = mean > 0.0 ? (double)job.busy_max_ns / mean : 1.0;
+    pool->parallel_regions++;
+    pool->imbalance_sum += imbalance;
+    if (imbalance > pool->imbalance_max) pool->imbalance_max = imbalance;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Workers already run in the library's mode; a caller's thread takes it only
+// for the duration of the call and gets its own control state back.
+void threadpool_parallel_for(ThreadPool *pool, size_t n, size_t grain, ParallelForFn fn, void *ctx) {
+    if (!fn || n == 0) return;
+    if (grain == 0) grain = 1;
+
+    if (in_worker) {
+        parallel_run(pool, n, grain, fn, ctx);
+        return;
+    }
+    NumericsState saved = numerics_enter();
+    parallel_run(pool, n, grain, fn, ctx);
+    numerics_leave(saved);
+}
+
+size_t threadpool_num_threads(ThreadPool *pool) {
+    return pool ? pool->num_workers + 1 : 1;
+}
+
+// ====================================================
+// Statistics
+// ====================================================
+
+ThreadStats threadpool_thread_stats(ThreadPool *pool, size_t thread) {
+    ThreadStats stats = { 0.0, 0.0, 0, 0 };
+    if (!pool || thread > pool->num_workers) return stats;
+
+    ThreadSlot *slot = &pool->slots[thread];
+    stats.busy_seconds = (double)__atomic_load_n(&slot->busy_ns, __ATOMIC_RELAXED) * 1e-9;
+    stats.idle_seconds = (double)__atomic_load_n(&slot->idle_ns, __ATOMIC_RELAXED) * 1e-9;
+    stats.chunks = __atomic_load_n(&slot->chunks, __ATOMIC_RELAXED);
+    stats.excess_chunks = __atomic_load_n(&slot->excess_chunks, __ATOMIC_RELAXED);
+    return stats;
+}
+
+ThreadPoolStats threadpool_stats(ThreadPool *pool) {
+    ThreadPoolStats stats;
+    memset(&stats, 0, sizeof(stats));
+    if (!pool) return stats;
+
+    double worker_busy = 0.0;
+    for (size_t t = 0; t <= pool->num_workers; t++) {
+        ThreadStats ts = threadpool_thread_stats(pool, t);
+        stats.busy_seconds += ts.busy_seconds;
+        stats.idle_seconds += ts.idle_seconds;
+        stats.chunks += ts.chunks;
+        stats.excess_chunks += ts.excess_chunks;
+        if (t > 0) worker_busy += ts.busy_seconds;
+    }
+    if (worker_busy + stats.idle_seconds > 0.0) {
+        stats.utilization = worker_busy / (worker_busy + stats.idle_seconds);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    stats.parallel_regions = pool->parallel_regions;
+    if (pool->parallel_regions > 0) stats.mean_imbalance = pool->imbalance_sum / (double)pool->parallel_regions;
+    stats.max_imbalance = pool->imbalance_max;
+    pthread_mutex_unlock(&pool->lock);
+    stats.serial_regions = __atomic_load_n(&pool->serial_regions, __ATOMIC_RELAXED);
+    return stats;
+}
+
+void threadpool_reset_stats(ThreadPool *pool) {
+    if (!pool) return;
+
+    for (size_t t = 0; t <= pool->num_workers; t++) {
+        ThreadSlot *slot = &pool->slots[t];
+        __atomic_store_n(&slot->busy_ns, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&slot->idle_ns, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&slot->chunks, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&slot->excess_chunks, 0, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->parallel_regions = 0;
+    pool->imbalance_sum = 0.0;
+    pool->imbalance_max = 0.0;
+    pthread_mutex_unlock(&pool->lock);
+    __atomic_store_n(&pool->serial_regions, 0, __ATOMIC_RELAXED);
+}
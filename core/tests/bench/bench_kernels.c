@@ -0,0 +1,331 @@
+#include "../../include/basednn.h"
+#include "../../include/kernels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Micro-benchmarks for the kernel and memory settings. Run with an optional
+// benchmark name to select one: ./bench_kernels [hugepages|denormals|fastmath|transpose|ewise|gemv]
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int selected(int argc, char **argv, const char *name) {
+    return argc < 2 || strcmp(argv[1], name) == 0;
+}
+
+// ====================================================
+// Huge Pages
+// ====================================================
+
+// One training-sized linear step: forward, backward and a weight update,
+// with every buffer allocated under the current BufferConfig
+static double time_linear_steps(size_t batch, size_t in, size_t out, int steps) {
+    Tensor *x = tensor_randn((size_t[]){batch, in}, 2, 1);
+    Tensor *w = tensor_randn((size_t[]){in, out}, 2, 2);
+    Tensor *b = tensor_zeroes((size_t[]){out}, 1);
+    tensor_set_requires_grad(w, 1);
+    tensor_set_requires_grad(b, 1);
+
+    double best = 1e30;
+    for (int s = 0; s < steps; s++) {
+        double start = now_seconds();
+        Tensor *y = tensor_linear(x, w, b, NULL);
+        tensor_backward(y);
+        for (size_t i = 0; i < w->size; i++) w->data[i] -= 1e-6f * w->grad[i];
+        double elapsed = now_seconds() - start;
+        if (elapsed < best) best = elapsed;
+
+        tensor_zero_grad(w);
+        tensor_zero_grad(b);
+        tensor_free(y);
+    }
+
+    tensor_free(x);
+    tensor_free(w);
+    tensor_free(b);
+    return best;
+}
+
+static void bench_hugepages(void) {
+    static const size_t sizes[][3] = { { 256, 1024, 1024 }, { 512, 2048, 2048 }, { 256, 4096, 4096 } };
+    BufferConfig saved = buffer_config();
+
+    printf("hugepages: best of 5 linear steps (ms), threshold %zu bytes\n",
+           saved.huge_threshold ? saved.huge_threshold : (size_t)4 << 20);
+    printf("  %-22s %10s %10s %8s\n", "batch x in x out", "heap", "huge", "speedup");
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        size_t batch = sizes[i][0], in = sizes[i][1], out = sizes[i][2];
+
+        buffer_configure((BufferConfig){ 0, 0 });
+        double heap = time_linear_steps(batch, in, out, 5);
+
+        BufferConfig huge = saved;
+        if (huge.huge_threshold == 0) huge.huge_threshold = (size_t)4 << 20;
+        buffer_configure(huge);
+        double mapped = time_linear_steps(batch, in, out, 5);
+
+        char label[64];
+        snprintf(label, sizeof(label), "%zu x %zu x %zu", batch, in, out);
+        printf("  %-22s %10.2f %10.2f %7.2fx\n", label, heap * 1e3, mapped * 1e3, heap / mapped);
+    }
+
+    buffer_configure(saved);
+}
+
+// ====================================================
+// Numerics
+// ====================================================
+
+// Adam steps on gradients that have decayed into the denormal range, as
+// they do near convergence
+static double time_adam_denormal(size_t size, int steps) {
+    Tensor *w = tensor_randn((size_t[]){size}, 1, 5);
+    w->grad = malloc(size * sizeof(float));
+    for (size_t i = 0; i < size; i++) w->grad[i] = 1e-39f * (float)(i % 17 + 1);
+
+    Optimizer *opt = optimizer_create(&w, 1, ADAM(1e-3f, 0.9f, 0.999f, 1e-8f));
+    double best = 1e30;
+    for (int s = 0; s < steps; s++) {
+        double start = now_seconds();
+        optimizer_step(opt);
+        double elapsed = now_seconds() - start;
+        if (elapsed < best) best = elapsed;
+    }
+
+    optimizer_free(opt);
+    tensor_free(w);
+    return best;
+}
+
+static void bench_denormals(void) {
+    NumericsConfig saved = numerics_config();
+    size_t size = (size_t)1 << 20;
+
+    NumericsConfig mode = saved;
+    mode.flush_denormals = 0;
+    numerics_configure(mode);
+    double slow = time_adam_denormal(size, 5);
+
+    mode.flush_denormals = 1;
+    numerics_configure(mode);
+    double fast = time_adam_denormal(size, 5);
+
+    printf("denormals: best of 5 Adam steps over %zu denormal gradients (ms)\n", size);
+    printf("  %10s %10s %8s\n", "kept", "flushed", "speedup");
+    printf("  %10.2f %10.2f %7.2fx\n", slow * 1e3, fast * 1e3, slow / fast);
+
+    numerics_configure(saved);
+}
+
+static double time_activations(Tensor *z, int steps) {
+    double best = 1e30;
+    for (int s = 0; s < steps; s++) {
+        double start = now_seconds();
+        Tensor *a = tensor_softmax(z);
+        Tensor *b = tensor_sigmoid(z);
+        double elapsed = now_seconds() - start;
+        if (elapsed < best) best = elapsed;
+        tensor_free(a);
+        tensor_free(b);
+    }
+    return best;
+}
+
+static void bench_fastmath(void) {
+    NumericsConfig saved = numerics_config();
+    Tensor *z = tensor_randn((size_t[]){256, 4096}, 2, 6);
+
+    NumericsConfig mode = saved;
+    mode.fast_math = 0;
+    numerics_configure(mode);
+    double exact = time_activations(z, 5);
+
+    mode.fast_math = 1;
+    numerics_configure(mode);
+    double fast = time_activations(z, 5);
+
+    printf("fastmath: best of 5 softmax + sigmoid over 256 x 4096 (ms)\n");
+    printf("  %10s %10s %8s\n", "libm", "fast", "speedup");
+    printf("  %10.2f %10.2f %7.2fx\n", exact * 1e3, fast * 1e3, exact / fast);
+
+    tensor_free(z);
+    numerics_configure(saved);
+}
+
+// ====================================================
+// Transpose
+// ====================================================
+
+typedef struct NaiveTranspose {
+    size_t rows, cols;
+    const float *src;
+    float *dst;
+} NaiveTranspose;
+
+static void naive_transpose_rows(void *ctx, size_t start, size_t end) {
+    NaiveTranspose *t = (NaiveTranspose *)ctx;
+    for (size_t i = start; i < end; i++) {
+        for (size_t j = 0; j < t->cols; j++) t->dst[j * t->rows + i] = t->src[i * t->cols + j];
+    }
+}
+
+// Threaded like matrix_transpose, which stays serial below 1M elements and
+// splits over the default pool above, so only the access pattern differs
+static void naive_transpose(size_t rows, size_t cols, const float *src, float *dst) {
+    NaiveTranspose task = { rows, cols, src, dst };
+    if (rows * cols < ((size_t)1 << 20)) {
+        naive_transpose_rows(&task, 0, rows);
+        return;
+    }
+    threadpool_parallel_for(threadpool_default(), rows, 256, naive_transpose_rows, &task);
+}
+
+static void bench_transpose(void) {
+    static const size_t sizes[][2] = { { 512, 512 }, { 1024, 4096 }, { 4096, 4096 } };
+
+    printf("transpose: best of 5 (ms), %zu threads\n", threadpool_num_threads(threadpool_default()));
+    printf("  %-16s %10s %10s %8s\n", "rows x cols", "naive", "blocked", "speedup");
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        size_t rows = sizes[i][0], cols = sizes[i][1];
+        Tensor *src = tensor_randn((size_t[]){rows, cols}, 2, 7);
+        float *dst = malloc(rows * cols * sizeof(float));
+
+        double naive = 1e30, blocked = 1e30;
+        for (int s = 0; s < 5; s++) {
+            double start = now_seconds();
+            naive_transpose(rows, cols, src->data, dst);
+            double elapsed = now_seconds() - start;
+            if (elapsed < naive) naive = elapsed;
+
+            start = now_seconds();
+            matrix_transpose(rows, cols, src->data, cols, dst, rows);
+            elapsed = now_seconds() - start;
+            if (elapsed < blocked) blocked = elapsed;
+        }
+
+        char label[64];
+        snprintf(label, sizeof(label), "%zu x %zu", rows, cols);
+        printf("  %-16s %10.2f %10.2f %7.2fx\n", label, naive * 1e3, blocked * 1e3, naive / blocked);
+
+        free(dst);
+        tensor_free(src);
+    }
+}
+
+// ====================================================
+// Elementwise
+// ====================================================
+
+// The per-element function pointer loop tensor_add used to run
+static float add_func(float x, float y) { return x + y; }
+
+static void __attribute__((noinline)) ewise_func_ptr(float *dst, const float *a, const float *b, size_t n,
+                                                     float (*func)(float, float)) {
+    for (size_t i = 0; i < n; i++) dst[i] = func(a[i], b[i]);
+}
+
+static void bench_ewise(void) {
+    static const size_t sizes[] = { (size_t)1 << 12, (size_t)1 << 16, (size_t)1 << 22, (size_t)1 << 24 };
+    float (*volatile func)(float, float) = add_func;
+
+    printf("ewise: best of 10 add (GB/s moved, 12 bytes per element)\n");
+    printf("  %-12s %10s %10s %8s\n", "elements", "func ptr", "vec_add", "speedup");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t n = sizes[s];
+        Tensor *a = tensor_randn((size_t[]){n}, 1, 8);
+        Tensor *b = tensor_randn((size_t[]){n}, 1, 9);
+        Tensor *c = tensor_zeroes((size_t[]){n}, 1);
+
+        double slow = 1e30, fast = 1e30;
+        for (int r = 0; r < 10; r++) {
+            double start = now_seconds();
+            ewise_func_ptr(c->data, a->data, b->data, n, func);
+            double elapsed = now_seconds() - start;
+            if (elapsed < slow) slow = elapsed;
+
+            start = now_seconds();
+            vec_add(c->data, a->data, b->data, n);
+            elapsed = now_seconds() - start;
+            if (elapsed < fast) fast = elapsed;
+        }
+
+        double bytes = 12.0 * (double)n;
+        printf("  %-12zu %10.2f %10.2f %7.2fx\n", n, bytes / slow * 1e-9, bytes / fast * 1e-9, slow / fast);
+
+        tensor_free(a);
+        tensor_free(b);
+        tensor_free(c);
+    }
+}
+
+// ====================================================
+// GEMV
+// ====================================================
+
+// The 1D x 2D matmul loop this replaced, walking B a column at a time
+static void __attribute__((noinline)) column_walk(const float *x, const float *B, float *y, size_t K, size_t N) {
+    for (size_t j = 0; j < N; j++) {
+        float acc = 0.0f;
+        for (size_t k = 0; k < K; k++) acc += x[k] * B[k * N + j];
+        y[j] = acc;
+    }
+}
+
+static void bench_gemv(void) {
+    static const size_t sizes[][2] = { { 256, 256 }, { 1024, 1024 }, { 4096, 1024 }, { 4096, 4096 } };
+
+    printf("gemv: best of 10 batch-1 x[K] * W[K, N] (GB/s of weights)\n");
+    printf("  %-14s %10s %10s %10s\n", "K x N", "columns", "packed", "gemv");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t K = sizes[s][0], N = sizes[s][1];
+        Tensor *x = tensor_randn((size_t[]){K}, 1, 10);
+        Tensor *W = tensor_randn((size_t[]){K, N}, 2, 11);
+        float *y = malloc(N * sizeof(float));
+        PackedMatrix *P = sgemm_pack_b(0, K, N, W->data, N, gemm_default_blocking().kc);
+
+        double best[3] = { 1e30, 1e30, 1e30 };
+        for (int r = 0; r < 10; r++) {
+            for (int v = 0; v < 3; v++) {
+                double start = now_seconds();
+                if (v == 0) column_walk(x->data, W->data, y, K, N);
+                if (v == 1) sgemm_packed(0, 1, 1.0f, x->data, K, P, 0.0f, y, N, NULL);
+                if (v == 2) sgemv(1, K, N, 1.0f, W->data, N, x->data, 0.0f, y);
+                double elapsed = now_seconds() - start;
+                if (elapsed < best[v]) best[v] = elapsed;
+            }
+        }
+
+        double bytes = 4.0 * (double)K * (double)N;
+        char label[64];
+        snprintf(label, sizeof(label), "%zu x %zu", K, N);
+        printf("  %-14s %10.2f %10.2f %10.2f\n", label, bytes / best[0] * 1e-9, bytes / best[1] * 1e-9, bytes / best[2] * 1e-9);
+
+        packed_matrix_free(P);
+        free(y);
+        tensor_free(x);
+        tensor_free(W);
+    }
+}
+
+int main(int argc, char **argv) {
+    basednn_init();
+
+    if (selected(argc, argv, "hugepages")) bench_hugepages();
+    if (selected(argc, argv, "denormals")) bench_denormals();
+    if (selected(argc, argv, "fastmath")) bench_fastmath();
+    if (selected(argc, argv, "transpose")) bench_transpose();
+    if (selected(argc, argv, "ewise")) bench_ewise();
+    if (selected(argc, argv, "gemv")) bench_gemv();
+
+    basednn_cleanup();
+    return 0;
+}
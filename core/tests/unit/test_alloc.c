@@ -0,0 +1,116 @@
+#include "../../include/basednn.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include <string.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { printf("Running %s...\n", #name); test_##name(); printf("  PASSED\n"); } while(0)
+
+#define MIB ((size_t)1 << 20)
+
+// ====================================================
+// Allocation Tests
+// ====================================================
+
+TEST(small_buffers_use_heap) {
+    BufferStats before = buffer_stats();
+    float *p = buffer_alloc(1000 * sizeof(float));
+    assert(p != NULL && ((uintptr_t)p & 63) == 0);
+    assert(buffer_stats().huge_buffers == before.huge_buffers);
+
+    float *z = buffer_calloc(333, sizeof(float));
+    for (size_t i = 0; i < 333; i++) assert(z[i] == 0.0f);
+
+    buffer_free(p);
+    buffer_free(z);
+    buffer_free(malloc(64));
+    buffer_free(NULL);
+    assert(buffer_calloc(SIZE_MAX / 2, 4) == NULL);
+}
+
+TEST(large_buffers_use_huge_mappings) {
+    BufferConfig saved = buffer_config();
+    buffer_configure((BufferConfig){ 4 * MIB, 0 });
+    BufferStats before = buffer_stats();
+
+    size_t bytes = 5 * MIB + 123;
+    unsigned char *p = buffer_calloc(bytes, 1);
+    assert(p != NULL);
+    assert(((uintptr_t)p & (2 * MIB - 1)) == 0);
+
+    BufferStats during = buffer_stats();
+    assert(during.huge_buffers == before.huge_buffers + 1);
+    assert(during.mapped_bytes == before.mapped_bytes + 6 * MIB);
+    for (size_t i = 0; i < bytes; i += 4096) assert(p[i] == 0);
+    memset(p, 0xAB, bytes);
+
+    buffer_free(p);
+    assert(buffer_stats().huge_buffers == before.huge_buffers);
+    assert(buffer_stats().mapped_bytes == before.mapped_bytes);
+
+    buffer_configure(saved);
+}
+
+TEST(threshold_is_configurable) {
+    BufferConfig saved = buffer_config();
+    BufferStats before = buffer_stats();
+
+    // Disabled: even big buffers come from the heap
+    buffer_configure((BufferConfig){ 0, 0 });
+    void *p = buffer_alloc(8 * MIB);
+    assert(p != NULL && buffer_stats().huge_buffers == before.huge_buffers);
+    buffer_free(p);
+
+    // Reserved huge pages are rarely configured; the fallback must still map
+    buffer_configure((BufferConfig){ 2 * MIB, 1 });
+    p = buffer_alloc(2 * MIB);
+    assert(p != NULL && buffer_stats().huge_buffers == before.huge_buffers + 1);
+    buffer_free(p);
+
+    buffer_configure(saved);
+    assert(buffer_config().huge_threshold == saved.huge_threshold);
+}
+
+TEST(tensors_use_buffers) {
+    BufferConfig saved = buffer_config();
+    buffer_configure((BufferConfig){ 4 * MIB, 0 });
+    BufferStats before = buffer_stats();
+
+    Tensor *w = tensor_randn((size_t[]){1024, 1024}, 2, 3);
+    Tensor *x = tensor_randn((size_t[]){8, 1024}, 2, 4);
+    tensor_set_requires_grad(w, 1);
+    assert(buffer_stats().huge_buffers == before.huge_buffers + 1);
+
+    Tensor *y = tensor_matmul(x, w);
+    tensor_backward(y);
+    assert(w->grad != NULL);
+    assert(buffer_stats().huge_buffers == before.huge_buffers + 2);
+
+    tensor_free(y);
+    tensor_free(x);
+    tensor_free(w);
+    assert(buffer_stats().huge_buffers == before.huge_buffers);
+
+    buffer_configure(saved);
+}
+
+// ====================================================
+// ====================================================
+
+int main() {
+    printf("=== Running Alloc Tests ===\n\n");
+
+    basednn_init();
+
+    RUN_TEST(small_buffers_use_heap);
+    RUN_TEST(large_buffers_use_huge_mappings);
+    RUN_TEST(threshold_is_configurable);
+    RUN_TEST(tensors_use_buffers);
+
+    basednn_cleanup();
+
+    printf("\n=== All Alloc Tests Passed! ===\n");
+    return 0;
+}
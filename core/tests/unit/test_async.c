@@ -0,0 +1,159 @@
+#include "../../include/basednn.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { printf("Running %s...\n", #name); test_##name(); printf("  PASSED\n"); } while(0)
+
+// ====================================================
+// Helpers
+// ====================================================
+
+static Network* make_network(void) {
+    Network *net = network_create();
+    network_add_layer(net, layer_create(LINEAR(8, 16)));
+    network_add_layer(net, layer_create(RELU()));
+    network_add_layer(net, layer_create(LINEAR(16, 4)));
+    return net;
+}
+
+typedef struct CallbackLog {
+    int calls;
+    Tensor *seen;
+    Future *chained;
+    Network *net;
+    Tensor *input;
+} CallbackLog;
+
+static void record(Future *future, void *user_data) {
+    CallbackLog *log = (CallbackLog *)user_data;
+    log->calls++;
+    log->seen = future_tensor(future);
+}
+
+static void record_and_chain(Future *future, void *user_data) {
+    record(future, user_data);
+    CallbackLog *log = (CallbackLog *)user_data;
+    log->chained = network_forward_async(log->net, log->input);
+}
+
+// ====================================================
+// Future Tests
+// ====================================================
+
+TEST(forward_async_matches_sync) {
+    Network *net = make_network();
+    Tensor *x = tensor_randn((size_t[]){5, 8}, 2, 1);
+    Tensor *expected = network_forward(net, x);
+
+    Future *future = network_forward_async(net, x);
+    assert(future != NULL);
+    future_wait(future);
+    assert(future_poll(future));
+
+    Tensor *y = future_tensor(future);
+    assert(y != NULL && y->shape[0] == 5 && y->shape[1] == 4);
+    for (size_t i = 0; i < y->size; i++) assert(y->data[i] == expected->data[i]);
+
+    future_free(future);
+    tensor_free(y);
+    tensor_free(expected);
+    tensor_free(x);
+    network_free(net);
+}
+
+TEST(futures_complete_in_order) {
+    Network *net = make_network();
+    Tensor *inputs[16];
+    Future *futures[16];
+    for (size_t i = 0; i < 16; i++) {
+        inputs[i] = tensor_randn((size_t[]){3, 8}, 2, (unsigned)i + 10);
+        futures[i] = network_forward_async(net, inputs[i]);
+    }
+
+    // Once a later future is done, every earlier one must be too
+    future_wait(futures[15]);
+    for (size_t i = 0; i < 16; i++) assert(future_poll(futures[i]));
+
+    for (size_t i = 0; i < 16; i++) {
+        Tensor *expected = network_forward(net, inputs[i]);
+        Tensor *y = future_tensor(futures[i]);
+        for (size_t j = 0; j < y->size; j++) assert(y->data[j] == expected->data[j]);
+        tensor_free(expected);
+        tensor_free(y);
+        future_free(futures[i]);
+        tensor_free(inputs[i]);
+    }
+    network_free(net);
+}
+
+TEST(callbacks) {
+    Network *net = make_network();
+    Tensor *x = tensor_randn((size_t[]){2, 8}, 2, 3);
+    CallbackLog log = { 0, NULL, NULL, net, x };
+
+    // Registered before completion: runs on the executor and may submit more
+    Future *future = network_forward_async(net, x);
+    future_then(future, record_and_chain, &log);
+    future_free(future);
+    assert(log.calls == 1 && log.seen != NULL);
+    assert(log.chained != NULL);
+    tensor_free(log.seen);
+
+    // Registered after completion: runs on the caller right away
+    future_wait(log.chained);
+    future_then(log.chained, record, &log);
+    assert(log.calls == 2 && log.seen != NULL);
+    tensor_free(log.seen);
+    future_free(log.chained);
+
+    tensor_free(x);
+    network_free(net);
+}
+
+TEST(train_step_async) {
+    Network *net = make_network();
+    Optimizer *opt = optimizer_create(net->parameters, net->num_parameters, SGD(0.05f, 0.0f));
+    Tensor *x = tensor_randn((size_t[]){16, 8}, 2, 4);
+    Tensor *t = tensor_randn((size_t[]){16, 4}, 2, 5);
+
+    Future *first = network_train_step_async(net, x, t, opt, "mse");
+    Future *steps[20];
+    for (size_t i = 0; i < 20; i++) steps[i] = network_train_step_async(net, x, t, opt, "mse");
+
+    float initial = future_loss(first);
+    float final = future_loss(steps[19]);
+    assert(isfinite(initial) && final < initial);
+
+    future_free(first);
+    for (size_t i = 0; i < 20; i++) future_free(steps[i]);
+
+    assert(network_forward_async(NULL, x) == NULL);
+    assert(network_train_step_async(net, x, NULL, opt, "mse") == NULL);
+
+    optimizer_free(opt);
+    tensor_free(x);
+    tensor_free(t);
+    network_free(net);
+}
+
+// ====================================================
+// ====================================================
+
+int main() {
+    printf("=== Running Async Tests ===\n\n");
+
+    basednn_init();
+
+    RUN_TEST(forward_async_matches_sync);
+    RUN_TEST(futures_complete_in_order);
+    RUN_TEST(callbacks);
+    RUN_TEST(train_step_async);
+
+    basednn_cleanup();
+
+    printf("\n=== All Async Tests Passed! ===\n");
+    return 0;
+}
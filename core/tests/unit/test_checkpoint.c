@@ -0,0 +1,191 @@
+#include "../../include/basednn.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { printf("Running %s...\n", #name); test_##name(); printf("  PASSED\n"); } while(0)
+
+#define CKPT_DIR "/tmp/basednn_checkpoint_test"
+
+// ====================================================
+// Helpers
+// ====================================================
+
+static void clear_dir(void) {
+    char path[256];
+    for (size_t s = 1; s <= 32; s++) {
+        snprintf(path, sizeof(path), CKPT_DIR "/%08zu.base", s);
+        remove(path);
+        snprintf(path, sizeof(path), CKPT_DIR "/%08zu.delta", s);
+        remove(path);
+    }
+    remove(CKPT_DIR "/LATEST");
+}
+
+static Network* make_network(void) {
+    Network *net = network_create();
+    network_add_layer(net, layer_create(LINEAR(64, 128)));
+    network_add_layer(net, layer_create(RELU()));
+    network_add_layer(net, layer_create(LINEAR(128, 8)));
+    return net;
+}
+
+static int same_parameters(Network *a, Network *b) {
+    if (a->num_parameters != b->num_parameters) return 0;
+    for (size_t i = 0; i < a->num_parameters; i++) {
+        if (a->parameters[i]->size != b->parameters[i]->size) return 0;
+        if (memcmp(a->parameters[i]->data, b->parameters[i]->data, a->parameters[i]->size * sizeof(float)) != 0) return 0;
+    }
+    return 1;
+}
+
+static int file_exists(size_t sequence, const char *ext) {
+    char path[256];
+    snprintf(path, sizeof(path), CKPT_DIR "/%08zu.%s", sequence, ext);
+    return access(path, F_OK) == 0;
+}
+
+// ====================================================
+// Checkpoint Tests
+// ====================================================
+
+TEST(delta_only_writes_changed_blocks) {
+    clear_dir();
+    Network *net = make_network();
+    Checkpointer *ckpt = checkpointer_create(CKPT_DIR, (CheckpointConfig){ .block_size = 256, .full_interval = 8, .compress = 0 });
+    assert(ckpt != NULL);
+
+    assert(checkpoint_save(ckpt, net));
+    size_t base_bytes = ckpt->last_bytes;
+    assert(file_exists(1, "base"));
+
+    // One touched block in the first weight matrix
+    net->layers[0]->weights->data[1000] += 0.5f;
+    assert(checkpoint_save(ckpt, net));
+    assert(file_exists(2, "delta"));
+    assert(ckpt->last_bytes < 256 * sizeof(float) + 256);
+    assert(ckpt->last_bytes * 20 < base_bytes);
+
+    // Nothing changed: an empty delta
+    assert(checkpoint_save(ckpt, net));
+    assert(ckpt->sequence == 3);
+
+    Network *loaded = checkpoint_load_latest(CKPT_DIR);
+    assert(loaded != NULL);
+    assert(same_parameters(net, loaded));
+
+    network_free(loaded);
+    checkpointer_free(ckpt);
+    network_free(net);
+}
+
+TEST(xor_compression_roundtrip) {
+    clear_dir();
+    Network *net = make_network();
+    Checkpointer *ckpt = checkpointer_create(CKPT_DIR, (CheckpointConfig){ .block_size = 1024, .full_interval = 8, .compress = 1 });
+    assert(checkpoint_save(ckpt, net));
+
+    // A small update to every weight, like a fine-tuning step
+    for (int step = 0; step < 3; step++) {
+        for (size_t i = 0; i < net->num_parameters; i++) {
+            Tensor *param = net->parameters[i];
+            for (size_t j = 0; j < param->size; j++) param->data[j] *= 1.0f + 1e-5f * (float)((j + step) % 7);
+        }
+        assert(checkpoint_save(ckpt, net));
+
+        size_t total = 0;
+        for (size_t i = 0; i < net->num_parameters; i++) total += net->parameters[i]->size;
+        assert(ckpt->last_bytes < total * sizeof(float));
+    }
+
+    Network *loaded = checkpoint_load_latest(CKPT_DIR);
+    assert(loaded != NULL);
+    assert(same_parameters(net, loaded));
+
+    network_free(loaded);
+    checkpointer_free(ckpt);
+    network_free(net);
+}
+
+TEST(periodic_base_and_resume) {
+    clear_dir();
+    Network *net = make_network();
+    CheckpointConfig config = { .block_size = 512, .full_interval = 3, .compress = 1 };
+    Checkpointer *ckpt = checkpointer_create(CKPT_DIR, config);
+
+    for (int i = 0; i < 4; i++) {
+        net->layers[2]->bias->data[i] += 1.0f;
+        assert(checkpoint_save(ckpt, net));
+    }
+    assert(file_exists(1, "base") && file_exists(2, "delta") && file_exists(3, "delta"));
+    assert(file_exists(4, "base") && ckpt->base_sequence == 4);
+    checkpointer_free(ckpt);
+
+    // A restarted run continues the sequence, starting with a base
+    ckpt = checkpointer_create(CKPT_DIR, config);
+    assert(ckpt->sequence == 4);
+    net->layers[0]->bias->data[0] -= 1.0f;
+    assert(checkpoint_save(ckpt, net));
+    assert(file_exists(5, "base"));
+    net->layers[0]->bias->data[1] -= 1.0f;
+    assert(checkpoint_save(ckpt, net));
+    assert(file_exists(6, "delta"));
+
+    Network *loaded = checkpoint_load_latest(CKPT_DIR);
+    assert(loaded != NULL && same_parameters(net, loaded));
+
+    network_free(loaded);
+    checkpointer_free(ckpt);
+    network_free(net);
+}
+
+TEST(corrupt_delta_rejected) {
+    clear_dir();
+    Network *net = make_network();
+    Checkpointer *ckpt = checkpointer_create(CKPT_DIR, (CheckpointConfig){ .block_size = 128, .full_interval = 4, .compress = 0 });
+    assert(checkpoint_save(ckpt, net));
+    net->layers[0]->weights->data[5] = 3.0f;
+    assert(checkpoint_save(ckpt, net));
+
+    // Flip a payload byte at the end of the delta
+    FILE *f = fopen(CKPT_DIR "/00000002.delta", "r+b");
+    assert(f != NULL);
+    fseek(f, -3, SEEK_END);
+    int c = fgetc(f);
+    fseek(f, -3, SEEK_END);
+    fputc(c ^ 0x10, f);
+    fclose(f);
+
+    assert(checkpoint_load_latest(CKPT_DIR) == NULL);
+
+    clear_dir();
+    assert(checkpoint_load_latest(CKPT_DIR) == NULL);
+
+    checkpointer_free(ckpt);
+    network_free(net);
+}
+
+// ====================================================
+// ====================================================
+
+int main() {
+    printf("=== Running Checkpoint Tests ===\n\n");
+
+    basednn_init();
+
+    RUN_TEST(delta_only_writes_changed_blocks);
+    RUN_TEST(xor_compression_roundtrip);
+    RUN_TEST(periodic_base_and_resume);
+    RUN_TEST(corrupt_delta_rejected);
+
+    clear_dir();
+    rmdir(CKPT_DIR);
+    basednn_cleanup();
+
+    printf("\n=== All Checkpoint Tests Passed! ===\n");
+    return 0;
+}
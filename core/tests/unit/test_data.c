@@ -0,0 +1,265 @@
+#include "../../include/data.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+
+#define EPSILON 1e-5f
+#define ASSERT_FLOAT_EQ(a, b) assert(fabsf((a) - (b)) < EPSILON)
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { printf("Running %s...\n", #name); test_##name(); printf("  PASSED\n"); } while(0)
+
+static const char *csv_path = "test_data.csv";
+
+static void write_file(const char *contents) {
+    FILE *f = fopen(csv_path, "w");
+    assert(f != NULL);
+    fputs(contents, f);
+    fclose(f);
+}
+
+// ====================================================
+// CSV Loading Tests
+// ====================================================
+
+TEST(csv_features_only) {
+    write_file("1,2.5,-3\n4e1,0.125,6\n");
+
+    Tensor *x = tensor_load_csv(csv_path, CSV(), NULL);
+
+    assert(x != NULL);
+    assert(x->shape[0] == 2);
+    assert(x->shape[1] == 3);
+    ASSERT_FLOAT_EQ(x->data[0], 1.0f);
+    ASSERT_FLOAT_EQ(x->data[1], 2.5f);
+    ASSERT_FLOAT_EQ(x->data[2], -3.0f);
+    ASSERT_FLOAT_EQ(x->data[3], 40.0f);
+    ASSERT_FLOAT_EQ(x->data[4], 0.125f);
+    ASSERT_FLOAT_EQ(x->data[5], 6.0f);
+
+    tensor_free(x);
+}
+
+TEST(csv_header_and_crlf) {
+    write_file("a,b\r\n1,2\r\n\r\n3,4\r\n");
+
+    CSVConfig config = CSV();
+    config.has_header = 1;
+    Tensor *x = tensor_load_csv(csv_path, config, NULL);
+
+    assert(x != NULL);
+    assert(x->shape[0] == 2);
+    ASSERT_FLOAT_EQ(x->data[2], 3.0f);
+    ASSERT_FLOAT_EQ(x->data[3], 4.0f);
+
+    tensor_free(x);
+}
+
+TEST(csv_index_labels) {
+    write_file("0.5,2,1.5\n0.25,0,2.5\n");
+
+    Tensor *y = NULL;
+    Tensor *x = tensor_load_csv(csv_path, CSV_LABELED(0, 1, 0), &y);
+
+    assert(x != NULL && y != NULL);
+    assert(x->shape[1] == 2);
+    assert(y->shape[0] == 2 && y->shape[1] == 1);
+    ASSERT_FLOAT_EQ(x->data[0], 0.5f);
+    ASSERT_FLOAT_EQ(x->data[1], 1.5f);
+    ASSERT_FLOAT_EQ(y->data[0], 2.0f);
+    ASSERT_FLOAT_EQ(y->data[1], 0.0f);
+
+    tensor_free(x);
+    tensor_free(y);
+}
+
+TEST(csv_one_hot_labels) {
+    write_file("label,f\n2,1\n0,2\n1,3\n");
+
+    Tensor *y = NULL;
+    Tensor *x = tensor_load_csv(csv_path, CSV_LABELED(1, 0, 3), &y);
+
+    assert(x != NULL && y != NULL);
+    assert(y->shape[0] == 3 && y->shape[1] == 3);
+    ASSERT_FLOAT_EQ(y->data[2], 1.0f);
+    ASSERT_FLOAT_EQ(y->data[3], 1.0f);
+    ASSERT_FLOAT_EQ(y->data[7], 1.0f);
+    ASSERT_FLOAT_EQ(y->data[0] + y->data[1], 0.0f);
+    ASSERT_FLOAT_EQ(x->data[2], 3.0f);
+
+    tensor_free(x);
+    tensor_free(y);
+}
+
+TEST(csv_large_parallel) {
+    size_t rows = 20000;
+    FILE *f = fopen(csv_path, "w");
+    for (size_t i = 0; i < rows; i++) {
+        fprintf(f, "%zu,%.3f,%zu\n", i, i * 0.5f, i % 10);
+    }
+    fclose(f);
+
+    Tensor *y = NULL;
+    Tensor *x = tensor_load_csv(csv_path, CSV_LABELED(0, 2, 10), &y);
+
+    assert(x != NULL && y != NULL);
+    assert(x->shape[0] == rows);
+    for (size_t i = 0; i < rows; i++) {
+        ASSERT_FLOAT_EQ(x->data[i * 2], (float)i);
+        ASSERT_FLOAT_EQ(x->data[i * 2 + 1], i * 0.5f);
+        ASSERT_FLOAT_EQ(y->data[i * 10 + i % 10], 1.0f);
+    }
+
+    tensor_free(x);
+    tensor_free(y);
+}
+
+TEST(csv_malformed_row) {
+    write_file("1,2\n3\n");
+    assert(tensor_load_csv(csv_path, CSV(), NULL) == NULL);
+
+    write_file("1,2\n3,abc\n");
+    assert(tensor_load_csv(csv_path, CSV(), NULL) == NULL);
+}
+
+TEST(csv_label_out_of_range) {
+    write_file("5,1\n");
+    Tensor *y = NULL;
+    assert(tensor_load_csv(csv_path, CSV_LABELED(0, 0, 3), &y) == NULL);
+    assert(y == NULL);
+}
+
+TEST(csv_missing_file) {
+    assert(tensor_load_csv("does_not_exist.csv", CSV(), NULL) == NULL);
+}
+
+// ====================================================
+// Data Loader Tests
+// ====================================================
+
+static uint8_t* make_images(size_t n, size_t c, size_t h, size_t w) {
+    uint8_t *pixels = malloc(n * c * h * w);
+    for (size_t i = 0; i < n * c * h * w; i++) {
+        pixels[i] = (uint8_t)(i % 251);
+    }
+    return pixels;
+}
+
+TEST(dataloader_identity) {
+    size_t n = 10, c = 1, h = 4, w = 20;
+    uint8_t *pixels = make_images(n, c, h, w);
+    Tensor *labels = tensor_create((size_t[]){n, 1}, 2);
+    for (size_t i = 0; i < n; i++) labels->data[i] = (float)i;
+
+    ImageDataset ds = { pixels, n, c, h, w, labels };
+    DataLoader *loader = dataloader_create(ds, AUGMENT_NONE(), DATALOADER(4, 2, 2, 0, 1));
+    assert(loader != NULL);
+    assert(dataloader_num_batches(loader) == 3);
+
+    Tensor *x, *y;
+    size_t seen = 0;
+    while (dataloader_next(loader, &x, &y)) {
+        assert(x->shape[1] == c && x->shape[2] == h && x->shape[3] == w);
+        for (size_t b = 0; b < x->shape[0]; b++) {
+            size_t sample = (size_t)y->data[b];
+            assert(sample == seen + b);
+            for (size_t k = 0; k < c * h * w; k++) {
+                ASSERT_FLOAT_EQ(x->data[b * c * h * w + k], pixels[sample * c * h * w + k] / 255.0f);
+            }
+        }
+        seen += x->shape[0];
+    }
+    assert(seen == n);
+
+    dataloader_free(loader);
+    tensor_free(labels);
+    free(pixels);
+}
+
+TEST(dataloader_normalize_and_flip) {
+    size_t h = 2, w = 37;
+    uint8_t *pixels = make_images(1, 1, h, w);
+
+    AugmentConfig aug = AUGMENT(0, 0, 0, 1);
+    aug.mean[0] = 0.5f;
+    aug.std[0] = 0.25f;
+    ImageDataset ds = { pixels, 1, 1, h, w, NULL };
+
+    int flipped = 0, plain = 0;
+    DataLoader *loader = dataloader_create(ds, aug, DATALOADER(1, 1, 1, 0, 7));
+    for (int epoch = 0; epoch < 32; epoch++) {
+        Tensor *x;
+        assert(dataloader_next(loader, &x, NULL));
+        int is_flipped = fabsf(x->data[0] - (pixels[w - 1] / 255.0f - 0.5f) / 0.25f) < EPSILON;
+        for (size_t y = 0; y < h; y++) {
+            for (size_t i = 0; i < w; i++) {
+                size_t src = is_flipped ? w - 1 - i : i;
+                ASSERT_FLOAT_EQ(x->data[y * w + i], (pixels[y * w + src] / 255.0f - 0.5f) / 0.25f);
+            }
+        }
+        flipped += is_flipped;
+        plain += !is_flipped;
+        assert(!dataloader_next(loader, &x, NULL));
+    }
+    assert(flipped > 0 && plain > 0);
+
+    dataloader_free(loader);
+    free(pixels);
+}
+
+TEST(dataloader_crop_and_shift) {
+    size_t n = 16, c = 3, h = 8, w = 8;
+    uint8_t *pixels = make_images(n, c, h, w);
+    ImageDataset ds = { pixels, n, c, h, w, NULL };
+
+    DataLoader *loader = dataloader_create(ds, AUGMENT(6, 5, 2, 1), DATALOADER(5, 3, 0, 1, 3));
+    assert(loader != NULL);
+
+    for (int epoch = 0; epoch < 3; epoch++) {
+        Tensor *x;
+        size_t seen = 0;
+        while (dataloader_next(loader, &x, NULL)) {
+            assert(x->shape[2] == 6 && x->shape[3] == 5);
+            for (size_t i = 0; i < x->size; i++) {
+                assert(x->data[i] >= 0.0f && x->data[i] <= 1.0f);
+            }
+            seen += x->shape[0];
+        }
+        assert(seen == n);
+    }
+
+    dataloader_free(loader);
+    free(pixels);
+}
+
+TEST(dataloader_invalid_crop) {
+    uint8_t pixels[4] = {0};
+    ImageDataset ds = { pixels, 1, 1, 2, 2, NULL };
+    assert(dataloader_create(ds, AUGMENT(3, 3, 0, 0), DATALOADER(1, 1, 1, 0, 0)) == NULL);
+}
+
+// ====================================================
+// ====================================================
+
+int main() {
+    printf("=== Running Data Tests ===\n\n");
+
+    RUN_TEST(csv_features_only);
+    RUN_TEST(csv_header_and_crlf);
+    RUN_TEST(csv_index_labels);
+    RUN_TEST(csv_one_hot_labels);
+    RUN_TEST(csv_large_parallel);
+    RUN_TEST(csv_malformed_row);
+    RUN_TEST(csv_label_out_of_range);
+    RUN_TEST(csv_missing_file);
+
+    RUN_TEST(dataloader_identity);
+    RUN_TEST(dataloader_normalize_and_flip);
+    RUN_TEST(dataloader_crop_and_shift);
+    RUN_TEST(dataloader_invalid_crop);
+
+    remove(csv_path);
+
+    printf("\n=== All Data Tests Passed! ===\n");
+    return 0;
+}
@@ -0,0 +1,356 @@
+#include "../../include/kernels.h"
+#include "../../include/threadpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { printf("Running %s...\n", #name); test_##name(); printf("  PASSED\n"); } while(0)
+
+// ====================================================
+// Helpers
+// ====================================================
+
+static float* random_matrix(size_t n, unsigned int seed) {
+    float *m = malloc(n * sizeof(float));
+    srand(seed);
+    for (size_t i = 0; i < n; i++) {
+        m[i] = (float)rand() / RAND_MAX - 0.5f;
+    }
+    return m;
+}
+
+static void reference_gemm(int trans_a, int trans_b, size_t M, size_t N, size_t K, float alpha,
+                           const float *A, size_t lda, const float *B, size_t ldb, float beta, float *C, size_t ldc) {
+    for (size_t i = 0; i < M; i++) {
+        for (size_t j = 0; j < N; j++) {
+            double acc = 0.0;
+            for (size_t k = 0; k < K; k++) {
+                float a = trans_a ? A[k * lda + i] : A[i * lda + k];
+                float b = trans_b ? B[j * ldb + k] : B[k * ldb + j];
+                acc += (double)a * b;
+            }
+            C[i * ldc + j] = alpha * (float)acc + beta * C[i * ldc + j];
+        }
+    }
+}
+
+static void check_gemm(int trans_a, int trans_b, size_t M, size_t N, size_t K, float alpha, float beta) {
+    size_t lda = trans_a ? M : K;
+    size_t ldb = trans_b ? K : N;
+    float *A = random_matrix(M * K, 1);
+    float *B = random_matrix(K * N, 2);
+    float *C = random_matrix(M * N, 3);
+    float *R = malloc(M * N * sizeof(float));
+    for (size_t i = 0; i < M * N; i++) R[i] = C[i];
+
+    sgemm(trans_a, trans_b, M, N, K, alpha, A, lda, B, ldb, beta, C, N);
+    reference_gemm(trans_a, trans_b, M, N, K, alpha, A, lda, B, ldb, beta, R, N);
+
+    float tol = 1e-4f * (float)(K + 1);
+    for (size_t i = 0; i < M * N; i++) {
+        assert(fabsf(C[i] - R[i]) < tol);
+    }
+
+    free(A);
+    free(B);
+    free(C);
+    free(R);
+}
+
+// ====================================================
+// GEMM Tests
+// ====================================================
+
+TEST(sgemm_small) {
+    check_gemm(0, 0, 3, 5, 7, 1.0f, 0.0f);
+    check_gemm(1, 1, 3, 5, 7, 2.0f, 1.0f);
+}
+
+TEST(sgemm_blocked_all_transposes) {
+    for (int ta = 0; ta < 2; ta++) {
+        for (int tb = 0; tb < 2; tb++) {
+            check_gemm(ta, tb, 67, 45, 39, 1.0f, 0.0f);
+        }
+    }
+}
+
+TEST(sgemm_edges_and_beta) {
+    check_gemm(0, 0, 101, 33, 300, 0.5f, 1.0f);
+    check_gemm(0, 1, 7, 131, 65, 1.0f, -1.0f);
+    check_gemm(1, 0, 200, 17, 90, 1.0f, 0.25f);
+}
+
+TEST(sgemm_parallel_large) {
+    check_gemm(0, 0, 300, 290, 270, 1.0f, 0.0f);
+    check_gemm(1, 0, 1, 2100, 520, 1.0f, 1.0f);
+}
+
+TEST(sgemm_zero_k) {
+    float C[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+    sgemm(0, 0, 2, 2, 0, 1.0f, NULL, 0, NULL, 2, 0.5f, C, 2);
+    assert(C[0] == 0.5f && C[3] == 2.0f);
+}
+
+static void check_packed(int trans_a, int trans_b, size_t M, size_t N, size_t K, size_t kc, size_t nc) {
+    size_t lda = trans_a ? M : K;
+    size_t ldb = trans_b ? K : N;
+    float *A = random_matrix(M * K, 4);
+    float *B = random_matrix(K * N, 5);
+    float *C = random_matrix(M * N, 6);
+    float *R = malloc(M * N * sizeof(float));
+    for (size_t i = 0; i < M * N; i++) R[i] = C[i];
+
+    PackedMatrix *P = sgemm_pack_b(trans_b, K, N, B, ldb, kc);
+    assert(P != NULL && P->nr == gemm_panel_width() && P->kc == kc);
+
+    GemmBlocking blocking = { 24, 0, nc };
+    sgemm_packed(trans_a, M, 0.5f, A, lda, P, 1.0f, C, N, &blocking);
+    reference_gemm(trans_a, trans_b, M, N, K, 0.5f, A, lda, B, ldb, 1.0f, R, N);
+
+    float tol = 1e-4f * (float)(K + 1);
+    for (size_t i = 0; i < M * N; i++) {
+        assert(fabsf(C[i] - R[i]) < tol);
+    }
+
+    packed_matrix_free(P);
+    free(A);
+    free(B);
+    free(C);
+    free(R);
+}
+
+TEST(sgemm_prepacked_b) {
+    check_packed(0, 0, 7, 37, 50, 16, 2048);
+    check_packed(0, 0, 65, 100, 300, 128, 40);
+    check_packed(1, 1, 13, 33, 70, 32, 16);
+    check_packed(0, 0, 1, 10, 3, 256, 2048);
+}
+
+TEST(sgemm_custom_blocking) {
+    size_t M = 70, N = 90, K = 130;
+    float *A = random_matrix(M * K, 7);
+    float *B = random_matrix(K * N, 8);
+    float *C = malloc(M * N * sizeof(float));
+    float *R = malloc(M * N * sizeof(float));
+
+    GemmBlocking blocking = { 12, 40, 30 };
+    sgemm_blocked(0, 0, M, N, K, 1.0f, A, K, B, N, 0.0f, C, N, &blocking);
+    sgemm(0, 0, M, N, K, 1.0f, A, K, B, N, 0.0f, R, N);
+    for (size_t i = 0; i < M * N; i++) {
+        assert(fabsf(C[i] - R[i]) < 1e-3f);
+    }
+
+    free(A);
+    free(B);
+    free(C);
+    free(R);
+}
+
+// ====================================================
+// GEMV Tests
+// ====================================================
+
+TEST(sgemm_small_m_uses_gemv) {
+    // Every row count up to GEMV_MAX_ROWS and one past it, with column
+    // tails of every width and a size that splits across the pool
+    for (size_t M = 1; M <= GEMV_MAX_ROWS + 1; M++) {
+        check_gemm(0, 0, M, 203, 67, 1.0f, 0.0f);
+        check_gemm(1, 0, M, 77, 150, 0.5f, 1.0f);
+    }
+    check_gemm(0, 0, 1, 3000, 400, 1.0f, 0.5f);
+    check_gemm(0, 0, 3, 1000, 2000, -1.0f, 0.0f);
+}
+
+TEST(sgemv_both_forms) {
+    static const size_t shapes[][2] = { { 1, 1 }, { 5, 3 }, { 70, 130 }, { 1500, 900 } };
+    for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+        size_t M = shapes[s][0], N = shapes[s][1];
+        float *A = random_matrix(M * N, 12);
+        float *x = random_matrix(M > N ? M : N, 13);
+
+        // y[M] = 2 A x + y
+        float *y = random_matrix(M, 14);
+        float *ref = malloc(M * sizeof(float));
+        for (size_t i = 0; i < M; i++) {
+            double acc = 0.0;
+            for (size_t j = 0; j < N; j++) acc += (double)A[i * N + j] * x[j];
+            ref[i] = 2.0f * (float)acc + y[i];
+        }
+        sgemv(0, M, N, 2.0f, A, N, x, 1.0f, y);
+        for (size_t i = 0; i < M; i++) assert(fabsf(y[i] - ref[i]) < 1e-4f * (float)(N + 1));
+        free(y);
+        free(ref);
+
+        // y[N] = x A
+        y = random_matrix(N, 15);
+        ref = malloc(N * sizeof(float));
+        for (size_t j = 0; j < N; j++) {
+            double acc = 0.0;
+            for (size_t i = 0; i < M; i++) acc += (double)x[i] * A[i * N + j];
+            ref[j] = (float)acc;
+        }
+        sgemv(1, M, N, 1.0f, A, N, x, 0.0f, y);
+        for (size_t j = 0; j < N; j++) assert(fabsf(y[j] - ref[j]) < 1e-4f * (float)(M + 1));
+        free(y);
+        free(ref);
+
+        free(A);
+        free(x);
+    }
+}
+
+// ====================================================
+// Transpose Tests
+// ====================================================
+
+// Strided source and destination, so padding must be left untouched
+static void check_transpose(size_t rows, size_t cols, int accumulate) {
+    size_t lds = cols + 3, ldd = rows + 5;
+    float *src = random_matrix(rows * lds, 4);
+    float *dst = random_matrix(cols * ldd, 5);
+    float *ref = malloc(cols * ldd * sizeof(float));
+    for (size_t i = 0; i < cols * ldd; i++) ref[i] = dst[i];
+
+    for (size_t i = 0; i < rows; i++) {
+        for (size_t j = 0; j < cols; j++) {
+            ref[j * ldd + i] = (accumulate ? ref[j * ldd + i] : 0.0f) + src[i * lds + j];
+        }
+    }
+
+    if (accumulate) {
+        matrix_transpose_add(rows, cols, src, lds, dst, ldd);
+    } else {
+        matrix_transpose(rows, cols, src, lds, dst, ldd);
+    }
+    for (size_t i = 0; i < cols * ldd; i++) assert(dst[i] == ref[i]);
+
+    free(src);
+    free(dst);
+    free(ref);
+}
+
+TEST(transpose_shapes) {
+    static const size_t shapes[][2] = { {1, 1}, {8, 8}, {7, 13}, {64, 24}, {33, 100}, {257, 129} };
+    for (size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++) {
+        check_transpose(shapes[i][0], shapes[i][1], 0);
+        check_transpose(shapes[i][0], shapes[i][1], 1);
+    }
+}
+
+TEST(transpose_parallel_large) {
+    check_transpose(1100, 1031, 0);
+    check_transpose(1031, 1100, 1);
+}
+
+// ====================================================
+// Elementwise Tests
+// ====================================================
+
+TEST(vec_binary_ops) {
+    // Odd sizes cover the unrolled body, the 8-wide tail and the scalar tail;
+    // the largest runs split across the pool
+    static const size_t sizes[] = { 1, 7, 8, 37, 1000, 300007 };
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t n = sizes[s];
+        float *a = random_matrix(n, 6);
+        float *b = random_matrix(n, 7);
+        float *d = random_matrix(n, 8);
+        float *out = malloc(n * sizeof(float));
+
+        vec_add(out, a, b, n);
+        for (size_t i = 0; i < n; i++) assert(out[i] == a[i] + b[i]);
+        vec_sub(out, a, b, n);
+        for (size_t i = 0; i < n; i++) assert(out[i] == a[i] - b[i]);
+        vec_mul(out, a, b, n);
+        for (size_t i = 0; i < n; i++) assert(out[i] == a[i] * b[i]);
+
+        // Accumulating in place, as the backward passes do
+        for (size_t i = 0; i < n; i++) out[i] = d[i];
+        vec_fma(out, a, b, n);
+        for (size_t i = 0; i < n; i++) assert(fabsf(out[i] - (d[i] + a[i] * b[i])) < 1e-6f);
+        for (size_t i = 0; i < n; i++) out[i] = d[i];
+        vec_sub(out, out, a, n);
+        for (size_t i = 0; i < n; i++) assert(out[i] == d[i] - a[i]);
+
+        free(a);
+        free(b);
+        free(d);
+        free(out);
+    }
+}
+
+TEST(vec_row_broadcast) {
+    static const size_t shapes[][2] = { { 3, 5 }, { 17, 40 }, { 600, 300 }, { 70000, 3 } };
+    for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+        size_t rows = shapes[s][0], cols = shapes[s][1];
+        float *a = random_matrix(rows * cols, 9);
+        float *row = random_matrix(cols, 10);
+        float *out = malloc(rows * cols * sizeof(float));
+
+        vec_add_rows(out, a, row, rows, cols);
+        for (size_t i = 0; i < rows; i++) {
+            for (size_t j = 0; j < cols; j++) assert(out[i * cols + j] == a[i * cols + j] + row[j]);
+        }
+
+        float *sums = random_matrix(cols, 11);
+        double *ref = malloc(cols * sizeof(double));
+        for (size_t j = 0; j < cols; j++) ref[j] = sums[j];
+        for (size_t i = 0; i < rows; i++) {
+            for (size_t j = 0; j < cols; j++) ref[j] += a[i * cols + j];
+        }
+        vec_sum_rows(sums, a, rows, cols);
+        for (size_t j = 0; j < cols; j++) assert(fabs(sums[j] - ref[j]) < 1e-5 * (double)(rows + 1));
+
+        free(a);
+        free(row);
+        free(out);
+        free(sums);
+        free(ref);
+    }
+}
+
+// ====================================================
+// Checksum Tests
+// ====================================================
+
+TEST(crc32c_known_values) {
+    assert(crc32c(0, "123456789", 9) == 0xE3069283u);
+    assert(crc32c(0, "", 0) == 0);
+
+    // Chaining over pieces equals one pass, at every split of an odd length
+    unsigned char buf[67];
+    for (size_t i = 0; i < sizeof(buf); i++) buf[i] = (unsigned char)(i * 31 + 7);
+    uint32_t whole = crc32c(0, buf, sizeof(buf));
+    for (size_t split = 0; split <= sizeof(buf); split++) {
+        assert(crc32c(crc32c(0, buf, split), buf + split, sizeof(buf) - split) == whole);
+    }
+}
+
+// ====================================================
+// ====================================================
+
+int main() {
+    printf("=== Running Kernel Tests ===\n\n");
+
+    RUN_TEST(sgemm_small);
+    RUN_TEST(sgemm_blocked_all_transposes);
+    RUN_TEST(sgemm_edges_and_beta);
+    RUN_TEST(sgemm_parallel_large);
+    RUN_TEST(sgemm_zero_k);
+    RUN_TEST(sgemm_prepacked_b);
+    RUN_TEST(sgemm_custom_blocking);
+    RUN_TEST(sgemm_small_m_uses_gemv);
+    RUN_TEST(sgemv_both_forms);
+    RUN_TEST(transpose_shapes);
+    RUN_TEST(transpose_parallel_large);
+    RUN_TEST(vec_binary_ops);
+    RUN_TEST(vec_row_broadcast);
+    RUN_TEST(crc32c_known_values);
+
+    threadpool_default_cleanup();
+
+    printf("\n=== All Kernel Tests Passed! ===\n");
+    return 0;
+}
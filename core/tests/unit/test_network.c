@@ -4,6 +4,8 @@
 #include <math.h>
 #include <assert.h>
 #include <string.h>
+#include <unistd.h>
+#include <pthread.h>
 
 #define EPSILON 1e-4f
 #define ASSERT_FLOAT_EQ(a, b) assert(fabsf((a) - (b)) < EPSILON)
@@ -127,6 +129,66 @@ TEST(network_forward_with_activations) {
     network_free(net);
 }
 
+// ====================================================
+// Execution Context Tests
+// ====================================================
+
+typedef struct ServeTask {
+    Network *net;
+    Tensor *input;
+    Tensor *expected;
+    int ok;
+} ServeTask;
+
+static void* serve_requests(void *arg) {
+    ServeTask *task = (ServeTask *)arg;
+    ExecContext *ctx = exec_context_create(task->net);
+    task->ok = 1;
+
+    for (int r = 0; r < 50; r++) {
+        Tensor *out = exec_context_forward(ctx, task->input);
+        if (!out || out->requires_grad || out->size != task->expected->size) {
+            task->ok = 0;
+            break;
+        }
+        for (size_t i = 0; i < out->size; i++) {
+            if (out->data[i] != task->expected->data[i]) task->ok = 0;
+        }
+    }
+
+    exec_context_free(ctx);
+    return NULL;
+}
+
+TEST(exec_contexts_share_network) {
+    Network *net = network_create();
+    network_add_layer(net, layer_create(LINEAR(12, 32)));
+    network_add_layer(net, layer_create(TANH()));
+    network_add_layer(net, layer_create(LINEAR(32, 5)));
+    network_add_layer(net, layer_create(SOFTMAX()));
+
+    ServeTask tasks[4];
+    pthread_t threads[4];
+    for (size_t t = 0; t < 4; t++) {
+        tasks[t].net = net;
+        tasks[t].input = tensor_randn((size_t[]){t + 1, 12}, 2, (int)t + 20);
+        tasks[t].expected = network_forward(net, tasks[t].input);
+        pthread_create(&threads[t], NULL, serve_requests, &tasks[t]);
+    }
+
+    for (size_t t = 0; t < 4; t++) {
+        pthread_join(threads[t], NULL);
+        assert(tasks[t].ok);
+        tensor_free(tasks[t].expected);
+        tensor_free(tasks[t].input);
+    }
+
+    // Grad mode is restored on the caller, and the parameters are untouched
+    assert(tensor_grad_enabled());
+    assert(net->layers[0]->weights->grad == NULL);
+    network_free(net);
+}
+
 // ====================================================
 // Network Parameter Tests
 // ====================================================
@@ -201,6 +263,37 @@ TEST(network_train_step) {
     network_free(net);
 }
 
+TEST(network_train_step_fuses_sigmoid) {
+    Network *net = network_create();
+    network_add_layer(net, layer_create(LINEAR(3, 2)));
+    network_add_layer(net, layer_create(SIGMOID()));
+
+    Optimizer *opt = optimizer_create(net->parameters, net->num_parameters, SGD(0.5f, 0.0f));
+
+    Tensor *input = tensor_randn((size_t[]){4, 3}, 2, 21);
+    Tensor *target = tensor_zeroes((size_t[]){4, 2}, 2);
+    for (size_t i = 0; i < 4; i++) target->data[i * 2 + i % 2] = 1.0f;
+
+    // The loss reported for the fused step matches sigmoid then BCE
+    Tensor *pred = network_forward(net, input);
+    Tensor *ref = tensor_binary_cross_entropy(pred, target);
+    float expected = ref->data[0];
+    tensor_free(ref);
+    tensor_free(pred);
+
+    float first = network_train_step(net, input, target, opt, "binary_cross_entropy");
+    assert(fabsf(first - expected) < 1e-5f);
+
+    float last = first;
+    for (int s = 0; s < 20; s++) last = network_train_step(net, input, target, opt, "binary_cross_entropy");
+    assert(last < first);
+
+    tensor_free(input);
+    tensor_free(target);
+    optimizer_free(opt);
+    network_free(net);
+}
+
 TEST(network_train_epochs) {
     Network *net = network_create();
     network_add_layer(net, layer_create(LINEAR(2, 1)));
@@ -329,6 +422,117 @@ TEST(network_save_load) {
     network_free(loaded);
 }
 
+TEST(network_save_detects_corruption) {
+    Network *net = network_create();
+    network_add_layer(net, layer_create(LINEAR(32, 32)));
+    network_add_layer(net, layer_create(RELU()));
+    network_add_layer(net, layer_create(LINEAR(32, 4)));
+
+    const char *filepath = "/tmp/test_network_crc.bdnn";
+    assert(network_save(net, filepath));
+
+    Network *loaded = network_load(filepath);
+    assert(loaded != NULL);
+    for (size_t i = 0; i < net->num_parameters; i++) {
+        assert(memcmp(loaded->parameters[i]->data, net->parameters[i]->data, net->parameters[i]->size * sizeof(float)) == 0);
+    }
+    network_free(loaded);
+
+    // One flipped bit in the last payload
+    FILE *f = fopen(filepath, "r+b");
+    fseek(f, -5, SEEK_END);
+    int c = fgetc(f);
+    fseek(f, -5, SEEK_END);
+    fputc(c ^ 0x01, f);
+    fclose(f);
+
+    assert(network_load(filepath) == NULL);
+    NetworkStream *stream = network_stream_open(filepath);
+    assert(stream != NULL);
+    assert(network_stream_finish(stream) == NULL);
+
+    remove(filepath);
+    network_free(net);
+}
+
+TEST(network_load_version_1) {
+    // Hand-written version 1 file: payloads inline, no checksums
+    const char *filepath = "/tmp/test_network_v1.bdnn";
+    FILE *f = fopen(filepath, "wb");
+    uint32_t header[2] = { 0x42444E4E, 1 };
+    size_t num_layers = 1, name_len = 7, num_params = 2, ndim_w = 2, shape_w[2] = { 2, 3 }, ndim_b = 1, shape_b = 3;
+    float weights[6] = { 1, 2, 3, 4, 5, 6 }, bias[3] = { 0.5f, -0.5f, 1.0f };
+    Layer *ref = layer_create(LINEAR(2, 3));
+
+    fwrite(header, sizeof(uint32_t), 2, f);
+    fwrite(&num_layers, sizeof(size_t), 1, f);
+    fwrite(&name_len, sizeof(size_t), 1, f);
+    fwrite("linear", 1, name_len, f);
+    fwrite(&ref->config_data_size, sizeof(size_t), 1, f);
+    fwrite(ref->config_data, 1, ref->config_data_size, f);
+    fwrite(&num_params, sizeof(size_t), 1, f);
+    fwrite(&ndim_w, sizeof(size_t), 1, f);
+    fwrite(shape_w, sizeof(size_t), 2, f);
+    fwrite(weights, sizeof(float), 6, f);
+    fwrite(&ndim_b, sizeof(size_t), 1, f);
+    fwrite(&shape_b, sizeof(size_t), 1, f);
+    fwrite(bias, sizeof(float), 3, f);
+    fclose(f);
+
+    Network *loaded = network_load(filepath);
+    assert(loaded != NULL && loaded->num_layers == 1);
+    assert(memcmp(loaded->layers[0]->weights->data, weights, sizeof(weights)) == 0);
+    assert(memcmp(loaded->layers[0]->bias->data, bias, sizeof(bias)) == 0);
+
+    remove(filepath);
+    layer_free(ref);
+    network_free(loaded);
+}
+
+TEST(network_stream_load) {
+    Network *net = network_create();
+    network_add_layer(net, layer_create(LINEAR(6, 16)));
+    network_add_layer(net, layer_create(RELU()));
+    network_add_layer(net, layer_create(LINEAR(16, 4)));
+
+    const char *filepath = "/tmp/test_network_stream.bdnn";
+    network_save(net, filepath);
+
+    Tensor *input = tensor_randn((size_t[]){3, 6}, 2, 11);
+    Tensor *expected = network_forward(net, input);
+
+    NetworkStream *stream = network_stream_open(filepath);
+    assert(stream != NULL);
+    Tensor *output = network_stream_forward(stream, input);
+    assert(output != NULL && output->size == expected->size);
+    for (size_t i = 0; i < output->size; i++) {
+        ASSERT_FLOAT_EQ(output->data[i], expected->data[i]);
+    }
+
+    Network *loaded = network_stream_finish(stream);
+    assert(loaded != NULL && loaded->num_layers == 3);
+    assert(loaded->num_parameters == 4);
+    assert(memcmp(loaded->layers[2]->weights->data, net->layers[2]->weights->data, 16 * 4 * sizeof(float)) == 0);
+
+    // A truncated file fails the layers that are missing
+    FILE *f = fopen(filepath, "r+b");
+    assert(f != NULL);
+    assert(ftruncate(fileno(f), 200) == 0);
+    fclose(f);
+    stream = network_stream_open(filepath);
+    assert(stream != NULL);
+    assert(network_stream_forward(stream, input) == NULL);
+    assert(network_stream_finish(stream) == NULL);
+    assert(network_stream_open("/tmp/does_not_exist.bdnn") == NULL);
+
+    remove(filepath);
+    tensor_free(output);
+    tensor_free(expected);
+    tensor_free(input);
+    network_free(loaded);
+    network_free(net);
+}
+
 // ====================================================
 // Network Print Tests
 // ====================================================
@@ -393,6 +597,7 @@ int main() {
     RUN_TEST(network_forward_single_layer);
     RUN_TEST(network_forward_multilayer);
     RUN_TEST(network_forward_with_activations);
+    RUN_TEST(exec_contexts_share_network);
     
     // Parameter tests
     RUN_TEST(network_get_parameters);
@@ -400,6 +605,7 @@ int main() {
     
     // Training tests
     RUN_TEST(network_train_step);
+    RUN_TEST(network_train_step_fuses_sigmoid);
     RUN_TEST(network_train_epochs);
     RUN_TEST(network_train_with_cross_entropy);
     
@@ -409,6 +615,9 @@ int main() {
     
     // Save/load tests
     RUN_TEST(network_save_load);
+    RUN_TEST(network_save_detects_corruption);
+    RUN_TEST(network_load_version_1);
+    RUN_TEST(network_stream_load);
     
     // Print test
     RUN_TEST(network_print);
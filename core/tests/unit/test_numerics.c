@@ -0,0 +1,166 @@
+#include "../../include/basednn.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+#include <assert.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <xmmintrin.h>
+#endif
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { printf("Running %s...\n", #name); test_##name(); printf("  PASSED\n"); } while(0)
+
+// ====================================================
+// Helpers
+// ====================================================
+
+// volatile keeps the products at run time, under the current MXCSR
+static float denormal_product(void) {
+    volatile float a = FLT_MIN, b = 0.25f;
+    return a * b;
+}
+
+typedef struct WorkerCheck {
+    int flushed[64];
+} WorkerCheck;
+
+static void check_chunk(void *ctx, size_t start, size_t end) {
+    WorkerCheck *check = (WorkerCheck *)ctx;
+    for (size_t i = start; i < end; i++) {
+        check->flushed[i] = numerics_thread_flushes_denormals() && denormal_product() == 0.0f;
+    }
+}
+
+// ====================================================
+// Denormal Tests
+// ====================================================
+
+TEST(flush_denormals_on_caller) {
+    numerics_configure((NumericsConfig){ .flush_denormals = 1, .fast_math = 0 });
+    assert(numerics_thread_flushes_denormals());
+    assert(denormal_product() == 0.0f);
+
+    numerics_configure((NumericsConfig){ .flush_denormals = 0, .fast_math = 0 });
+    assert(!numerics_thread_flushes_denormals());
+    assert(denormal_product() > 0.0f);
+
+    numerics_configure(NUMERICS_DEFAULTS());
+}
+
+TEST(flush_denormals_on_workers) {
+    ThreadPool *pool = threadpool_create(4);
+    numerics_configure((NumericsConfig){ .flush_denormals = 1, .fast_math = 0 });
+
+    WorkerCheck check = {{0}};
+    threadpool_parallel_for(pool, 64, 1, check_chunk, &check);
+    for (size_t i = 0; i < 64; i++) assert(check.flushed[i]);
+
+    // Running workers pick changes up before their next job
+    numerics_configure((NumericsConfig){ .flush_denormals = 0, .fast_math = 0 });
+    threadpool_parallel_for(pool, 64, 1, check_chunk, &check);
+    for (size_t i = 0; i < 64; i++) assert(!check.flushed[i]);
+
+    numerics_configure(NUMERICS_DEFAULTS());
+    threadpool_free(pool);
+}
+
+// An application thread that changed its own control word keeps it across
+// library calls, while the work inside them still runs in the library's mode
+TEST(caller_mode_restored) {
+#if defined(__x86_64__) || defined(__i386__)
+    ThreadPool *pool = threadpool_create(2);
+    numerics_configure((NumericsConfig){ .flush_denormals = 1, .fast_math = 0 });
+    unsigned csr = _mm_getcsr();
+    _mm_setcsr(csr & ~((1u << 6) | (1u << 15)));
+
+    WorkerCheck check = {{0}};
+    threadpool_parallel_for(pool, 64, 1, check_chunk, &check);
+    for (size_t i = 0; i < 64; i++) assert(check.flushed[i]);
+    assert(!numerics_thread_flushes_denormals());
+    assert(denormal_product() > 0.0f);
+
+    threadpool_parallel_for(NULL, 64, 64, check_chunk, &check);
+    assert(check.flushed[0]);
+    assert(!numerics_thread_flushes_denormals());
+
+    _mm_setcsr(csr);
+    numerics_configure(NUMERICS_DEFAULTS());
+    threadpool_free(pool);
+#endif
+}
+
+// ====================================================
+// Fast Math Tests
+// ====================================================
+
+TEST(vec_expf_accuracy) {
+    size_t n = 2003;
+    float *x = malloc(n * sizeof(float));
+    float *y = malloc(n * sizeof(float));
+    for (size_t i = 0; i < n; i++) x[i] = -87.0f + 175.0f * (float)i / (float)(n - 1);
+
+    vec_expf(y, x, n);
+    for (size_t i = 0; i < n; i++) {
+        float ref = expf(x[i]);
+        assert(fabsf(y[i] - ref) <= 4e-7f * ref);
+    }
+
+    x[0] = -100.0f;
+    x[1] = 0.0f;
+    vec_expf(x, x, 2);
+    assert(x[0] == 0.0f && x[1] == 1.0f);
+
+    // NaN passes through both the vector body and the scalar tail
+    for (size_t i = 0; i < 9; i++) x[i] = (i == 2 || i == 8) ? NAN : 1.0f;
+    vec_expf(y, x, 9);
+    assert(isnan(y[2]) && isnan(y[8]));
+    assert(fabsf(y[0] - expf(1.0f)) <= 4e-7f * expf(1.0f));
+
+    free(x);
+    free(y);
+}
+
+TEST(fast_math_activations) {
+    Tensor *z = tensor_randn((size_t[]){5, 37}, 2, 9);
+    for (size_t i = 0; i < z->size; i++) z->data[i] *= 8.0f;
+
+    Tensor *sig = tensor_sigmoid(z);
+    Tensor *soft = tensor_softmax(z);
+
+    numerics_configure((NumericsConfig){ .flush_denormals = 1, .fast_math = 1 });
+    Tensor *fast_sig = tensor_sigmoid(z);
+    Tensor *fast_soft = tensor_softmax(z);
+    numerics_configure(NUMERICS_DEFAULTS());
+
+    for (size_t i = 0; i < z->size; i++) {
+        assert(fabsf(fast_sig->data[i] - sig->data[i]) < 1e-6f);
+        assert(fabsf(fast_soft->data[i] - soft->data[i]) < 1e-6f);
+    }
+
+    tensor_free(sig);
+    tensor_free(soft);
+    tensor_free(fast_sig);
+    tensor_free(fast_soft);
+    tensor_free(z);
+}
+
+// ====================================================
+// ====================================================
+
+int main() {
+    printf("=== Running Numerics Tests ===\n\n");
+
+    basednn_init();
+
+    RUN_TEST(flush_denormals_on_caller);
+    RUN_TEST(flush_denormals_on_workers);
+    RUN_TEST(caller_mode_restored);
+    RUN_TEST(vec_expf_accuracy);
+    RUN_TEST(fast_math_activations);
+
+    basednn_cleanup();
+
+    printf("\n=== All Numerics Tests Passed! ===\n");
+    return 0;
+}
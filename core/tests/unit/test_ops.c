@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <assert.h>
+#include <string.h>
 
 #define EPSILON 1e-4f
 #define ASSERT_FLOAT_EQ(a, b) assert(fabsf((a) - (b)) < EPSILON)
@@ -407,6 +408,42 @@ TEST(tensor_binary_cross_entropy) {
     tensor_free(loss);
 }
 
+TEST(tensor_bce_with_logits) {
+    size_t shape[] = {6};
+    Tensor *logits = tensor_create(shape, 1);
+    Tensor *target = tensor_create(shape, 1);
+    float x[] = { -3.0f, -0.5f, 0.0f, 0.7f, 2.5f, 4.0f };
+    float y[] = { 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.3f };
+    memcpy(logits->data, x, sizeof(x));
+    memcpy(target->data, y, sizeof(y));
+    tensor_set_requires_grad(logits, 1);
+
+    Tensor *pred = tensor_sigmoid(logits);
+    Tensor *ref = tensor_binary_cross_entropy(pred, target);
+    Tensor *loss = tensor_bce_with_logits(logits, target);
+    assert(fabsf(loss->data[0] - ref->data[0]) < 1e-5f);
+
+    // The fused backward is (sigmoid(x) - y) / n
+    tensor_backward(loss);
+    for (size_t i = 0; i < 6; i++) {
+        float s = 1.0f / (1.0f + expf(-x[i]));
+        assert(fabsf(logits->grad[i] - (s - y[i]) / 6.0f) < 1e-6f);
+    }
+
+    // Saturated logits stay finite where log(sigmoid(x)) would not
+    logits->data[0] = -100.0f; target->data[0] = 1.0f;
+    logits->data[5] = 100.0f; target->data[5] = 0.0f;
+    Tensor *extreme = tensor_bce_with_logits(logits, target);
+    assert(isfinite(extreme->data[0]) && extreme->data[0] > 33.0f);
+
+    tensor_free(pred);
+    tensor_free(ref);
+    tensor_free(loss);
+    tensor_free(extreme);
+    tensor_free(logits);
+    tensor_free(target);
+}
+
 // ====================================================
 // Slice Tests
 // ====================================================
@@ -522,6 +559,30 @@ TEST(backward_relu) {
     tensor_free(b);
 }
 
+TEST(grad_disabled) {
+    Tensor *a = tensor_ones((size_t[]){2, 3}, 2);
+    Tensor *w = tensor_ones((size_t[]){3, 2}, 2);
+    tensor_set_requires_grad(w, 1);
+
+    tensor_set_grad_enabled(0);
+    assert(!tensor_grad_enabled());
+    Tensor *b = tensor_matmul(a, w);
+    Tensor *c = tensor_relu(b);
+    assert(!b->requires_grad && !c->requires_grad);
+    assert(c->inputs == NULL && c->backward_fn == NULL);
+    ASSERT_FLOAT_EQ(c->data[0], 3.0f);
+    tensor_set_grad_enabled(1);
+
+    Tensor *d = tensor_matmul(a, w);
+    assert(d->requires_grad && d->backward_fn != NULL);
+
+    tensor_free(b);
+    tensor_free(c);
+    tensor_free(d);
+    tensor_free(a);
+    tensor_free(w);
+}
+
 // ====================================================
 // Main Test Runner
 // ====================================================
@@ -552,6 +613,7 @@ int main() {
     RUN_TEST(tensor_mse);
     RUN_TEST(tensor_cross_entropy);
     RUN_TEST(tensor_binary_cross_entropy);
+    RUN_TEST(tensor_bce_with_logits);
     
     // Slice
     RUN_TEST(tensor_slice);
@@ -560,6 +622,7 @@ int main() {
     RUN_TEST(backward_add);
     RUN_TEST(backward_mul);
     RUN_TEST(backward_relu);
+    RUN_TEST(grad_disabled);
     
     printf("\n=== All Ops Tests Passed! ===\n");
     return 0;
@@ -0,0 +1,409 @@
+#include "../../include/basednn.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define EPSILON 1e-4f
+#define ASSERT_FLOAT_EQ(a, b) assert(fabsf((a) - (b)) < EPSILON)
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { printf("Running %s...\n", #name); test_##name(); printf("  PASSED\n"); } while(0)
+
+#define CACHE_DIR "/tmp/basednn_plan_cache"
+
+// ====================================================
+// Helpers
+// ====================================================
+
+static Network* make_network(void) {
+    Network *net = network_create();
+    network_add_layer(net, layer_create(LINEAR(40, 64)));
+    network_add_layer(net, layer_create(RELU()));
+    network_add_layer(net, layer_create(LINEAR(64, 10)));
+    return net;
+}
+
+static Tensor* make_input(size_t batch) {
+    Tensor *x = tensor_create((size_t[]){batch, 40}, 2);
+    for (size_t i = 0; i < x->size; i++) x->data[i] = (float)((i * 37) % 11) / 11.0f - 0.5f;
+    return x;
+}
+
+static void copy_weights(Network *dst, Network *src) {
+    for (size_t i = 0; i < src->num_parameters; i++) {
+        memcpy(dst->parameters[i]->data, src->parameters[i]->data, src->parameters[i]->size * sizeof(float));
+    }
+}
+
+static void assert_same_forward(Network *net, Network *reference, Tensor *x) {
+    copy_weights(reference, net);
+    Tensor *expected = network_forward(reference, x);
+    Tensor *out = network_forward(net, x);
+    for (size_t i = 0; i < out->size; i++) ASSERT_FLOAT_EQ(out->data[i], expected->data[i]);
+    tensor_free(out);
+    tensor_free(expected);
+}
+
+static void clear_cache_dir(void) {
+    char path[256];
+    mkdir(CACHE_DIR, 0755);
+    Network *net = make_network();
+    snprintf(path, sizeof(path), CACHE_DIR "/%016llx-%d.plan", (unsigned long long)network_fingerprint(net), 16);
+    remove(path);
+    network_free(net);
+}
+
+// ====================================================
+// Fingerprint Tests
+// ====================================================
+
+TEST(fingerprint_stable_and_sensitive) {
+    Network *a = make_network();
+    Network *b = make_network();
+    assert(network_fingerprint(a) == network_fingerprint(b));
+
+    // Weight values do not change the plan, only the architecture does
+    b->layers[0]->weights->data[3] += 1.0f;
+    assert(network_fingerprint(a) == network_fingerprint(b));
+
+    Network *c = make_network();
+    network_add_layer(c, layer_create(SOFTMAX()));
+    assert(network_fingerprint(a) != network_fingerprint(c));
+
+    Network *d = network_create();
+    network_add_layer(d, layer_create(LINEAR(40, 64)));
+    network_add_layer(d, layer_create(RELU()));
+    network_add_layer(d, layer_create(LINEAR(64, 12)));
+    assert(network_fingerprint(a) != network_fingerprint(d));
+
+    network_free(a);
+    network_free(b);
+    network_free(c);
+    network_free(d);
+}
+
+// ====================================================
+// Plan Tests
+// ====================================================
+
+TEST(planned_forward_matches) {
+    Network *net = make_network();
+    Tensor *x = make_input(16);
+    Tensor *expected = network_forward(net, x);
+
+    NetworkPlan *plan = network_plan_build(net, 16);
+    assert(plan != NULL && plan->num_layers == 3);
+    assert(plan->layers[0].kind == LAYER_PLAN_LINEAR);
+    assert(plan->layers[1].kind == LAYER_PLAN_NONE);
+    assert(plan->layers[0].blocking.mc > 0 && plan->layers[0].blocking.kc > 0);
+    assert(plan->layers[0].packed_weights != NULL && plan->layers[1].packed_weights == NULL);
+    assert(plan->layers[0].packed_weights->kc == plan->layers[0].blocking.kc);
+    assert(network_set_plan(net, plan));
+
+    Tensor *out = network_forward(net, x);
+    assert(out->shape[0] == 16 && out->shape[1] == 10);
+    for (size_t i = 0; i < out->size; i++) {
+        ASSERT_FLOAT_EQ(out->data[i], expected->data[i]);
+    }
+
+    // Adding a layer drops the stale plan
+    network_add_layer(net, layer_create(SOFTMAX()));
+    assert(net->plan == NULL);
+
+    tensor_free(out);
+    tensor_free(expected);
+    tensor_free(x);
+    network_free(net);
+}
+
+TEST(plan_mismatch_rejected) {
+    Network *net = make_network();
+    NetworkPlan *plan = network_plan_build(net, 4);
+
+    Network *other = network_create();
+    network_add_layer(other, layer_create(RELU()));
+    network_add_layer(other, layer_create(LINEAR(40, 64)));
+    network_add_layer(other, layer_create(RELU()));
+    assert(!network_set_plan(other, plan));
+    assert(other->plan == NULL);
+
+    network_plan_free(plan);
+    network_free(other);
+    network_free(net);
+}
+
+TEST(linear_backward_matches_matmul) {
+    Tensor *x = make_input(5);
+    Tensor *w = tensor_randn((size_t[]){40, 6}, 2, 3);
+    Tensor *b = tensor_randn((size_t[]){6}, 1, 4);
+    tensor_set_requires_grad(x, 1);
+    tensor_set_requires_grad(w, 1);
+    tensor_set_requires_grad(b, 1);
+
+    Tensor *fused = tensor_linear(x, w, b, NULL);
+    tensor_backward(fused);
+    float *dx = malloc(x->size * sizeof(float)), *dw = malloc(w->size * sizeof(float)), *db = malloc(b->size * sizeof(float));
+    memcpy(dx, x->grad, x->size * sizeof(float));
+    memcpy(dw, w->grad, w->size * sizeof(float));
+    memcpy(db, b->grad, b->size * sizeof(float));
+    tensor_zero_grad(x);
+    tensor_zero_grad(w);
+    tensor_zero_grad(b);
+
+    Tensor *mm = tensor_matmul(x, w);
+    Tensor *ref = tensor_add(mm, b);
+    tensor_backward(ref);
+
+    for (size_t i = 0; i < fused->size; i++) ASSERT_FLOAT_EQ(fused->data[i], ref->data[i]);
+    for (size_t i = 0; i < x->size; i++) ASSERT_FLOAT_EQ(dx[i], x->grad[i]);
+    for (size_t i = 0; i < w->size; i++) ASSERT_FLOAT_EQ(dw[i], w->grad[i]);
+    for (size_t i = 0; i < b->size; i++) ASSERT_FLOAT_EQ(db[i], b->grad[i]);
+
+    free(dx);
+    free(dw);
+    free(db);
+    tensor_free(ref);
+    tensor_free(mm);
+    tensor_free(fused);
+    tensor_free(x);
+    tensor_free(w);
+    tensor_free(b);
+}
+
+TEST(stale_packed_weights_unused) {
+    Network *net = make_network();
+    Network *reference = make_network();
+    Tensor *x = make_input(16);
+    Tensor *y = tensor_zeroes((size_t[]){16, 10}, 2);
+    network_set_plan(net, network_plan_build(net, 16));
+
+    // A hand-written training loop keeps the plan attached
+    Optimizer *opt = optimizer_create(net->parameters, net->num_parameters, SGD(0.5f, 0.0f));
+    for (int s = 0; s < 3; s++) {
+        Tensor *out = network_forward(net, x);
+        Tensor *loss = tensor_mse(out, y);
+        network_zero_grad(net);
+        tensor_backward(loss);
+        optimizer_step(opt);
+        tensor_free(loss);
+        tensor_free(out);
+    }
+    assert(net->plan != NULL);
+    assert_same_forward(net, reference, x);
+
+    // Direct edits count once marked
+    for (size_t i = 0; i < net->layers[2]->weights->size; i++) net->layers[2]->weights->data[i] += 0.25f;
+    tensor_mark_modified(net->layers[2]->weights);
+    assert_same_forward(net, reference, x);
+
+    // Repacking picks the current weights up again
+    network_set_plan(net, network_plan_build(net, 16));
+    assert(net->plan->layers[2].weights_version == tensor_version(net->layers[2]->weights));
+    assert_same_forward(net, reference, x);
+
+    // A stored section is rejected once the weights it was packed from change
+    FILE *f = tmpfile();
+    assert(network_plan_write_packed(net, f));
+    net->layers[0]->weights->data[0] += 1.0f;
+    rewind(f);
+    assert(!network_plan_read_packed(net, f));
+    fclose(f);
+
+    optimizer_free(opt);
+    tensor_free(y);
+    tensor_free(x);
+    network_free(reference);
+    network_free(net);
+}
+
+// ====================================================
+// Cache Tests
+// ====================================================
+
+TEST(plan_save_load_roundtrip) {
+    Network *net = make_network();
+    NetworkPlan *plan = network_plan_build(net, 8);
+    const char *path = "/tmp/test_plan.plan";
+    assert(network_plan_save(plan, path));
+
+    NetworkPlan *loaded = network_plan_load(path);
+    assert(loaded != NULL);
+    assert(loaded->fingerprint == plan->fingerprint);
+    assert(loaded->cpu_features == plan->cpu_features);
+    assert(loaded->batch_size == 8 && loaded->num_layers == 3);
+    for (size_t i = 0; i < 3; i++) {
+        assert(loaded->layers[i].kind == plan->layers[i].kind);
+        assert(loaded->layers[i].blocking.mc == plan->layers[i].blocking.mc);
+        assert(loaded->layers[i].blocking.kc == plan->layers[i].blocking.kc);
+        assert(loaded->layers[i].blocking.nc == plan->layers[i].blocking.nc);
+        assert(loaded->layers[i].packed_weights == NULL);
+    }
+
+    // Weights are packed from the network, not the file
+    assert(network_plan_pack(net, loaded));
+    PackedMatrix *a = plan->layers[2].packed_weights, *b = loaded->layers[2].packed_weights;
+    assert(a->size == b->size && memcmp(a->data, b->data, a->size * sizeof(float)) == 0);
+
+    FILE *f = fopen(path, "wb");
+    fputs("garbage", f);
+    fclose(f);
+    assert(network_plan_load(path) == NULL);
+
+    remove(path);
+    network_plan_free(loaded);
+    network_plan_free(plan);
+    network_free(net);
+}
+
+TEST(plan_cache_reuse) {
+    clear_cache_dir();
+
+    Network *first = make_network();
+    assert(network_plan_cached(first, CACHE_DIR, 16));
+    assert(first->plan != NULL);
+
+    char path[256];
+    snprintf(path, sizeof(path), CACHE_DIR "/%016llx-%d.plan", (unsigned long long)network_fingerprint(first), 16);
+    assert(access(path, F_OK) == 0);
+
+    // A second process with the same model picks the stored plan up
+    Network *second = make_network();
+    assert(network_plan_cached(second, CACHE_DIR, 16));
+    assert(second->plan->fingerprint == first->plan->fingerprint);
+    assert(second->plan->layers[2].blocking.kc == first->plan->layers[2].blocking.kc);
+
+    Tensor *x = make_input(16);
+    Tensor *a = network_forward(first, x);
+    Tensor *b = network_forward(second, x);
+    for (size_t i = 0; i < a->size; i++) ASSERT_FLOAT_EQ(a->data[i], b->data[i]);
+
+    // A retrained model with the same architecture reuses the tuning but
+    // runs its own weights
+    Network *third = make_network();
+    for (size_t i = 0; i < third->layers[2]->weights->size; i++) third->layers[2]->weights->data[i] *= -1.0f;
+    Tensor *expected = network_forward(third, x);
+    assert(network_plan_cached(third, CACHE_DIR, 16));
+    Tensor *c = network_forward(third, x);
+    for (size_t i = 0; i < c->size; i++) ASSERT_FLOAT_EQ(c->data[i], expected->data[i]);
+    tensor_free(c);
+    tensor_free(expected);
+    network_free(third);
+
+    remove(path);
+    tensor_free(a);
+    tensor_free(b);
+    tensor_free(x);
+    network_free(first);
+    network_free(second);
+}
+
+TEST(bucketed_plans) {
+    assert(plan_bucket(1) == 1 && plan_bucket(5) == 8 && plan_bucket(8) == 8 && plan_bucket(9) == 16);
+
+    Network *net = make_network();
+    Network *reference = make_network();
+    mkdir(CACHE_DIR, 0755);
+    assert(network_plan_cached_buckets(net, CACHE_DIR, 12));
+
+    size_t expected_bucket = 1;
+    for (NetworkPlan *p = net->plan; p; p = p->next) {
+        assert(p->batch_size == expected_bucket);
+        expected_bucket <<= 1;
+
+        // K = 40 leaves a single kc candidate, so every bucket shares the first panels
+        if (p != net->plan) {
+            assert(p->layers[0].shared_packed);
+            assert(p->layers[0].packed_weights == net->plan->layers[0].packed_weights);
+        }
+    }
+    assert(expected_bucket == 32);
+
+    static const size_t batches[] = { 1, 3, 5, 11, 16, 23 };
+    for (size_t b = 0; b < sizeof(batches) / sizeof(batches[0]); b++) {
+        Tensor *x = make_input(batches[b]);
+        Tensor *expected = network_forward(reference, x);
+        Tensor *out = network_forward_bucketed(net, x);
+
+        assert(out != NULL && out->shape[0] == batches[b] && out->shape[1] == 10);
+        for (size_t i = 0; i < out->size; i++) ASSERT_FLOAT_EQ(out->data[i], expected->data[i]);
+
+        tensor_free(out);
+        tensor_free(expected);
+        tensor_free(x);
+    }
+
+    char path[256];
+    for (size_t bucket = 1; bucket <= 16; bucket <<= 1) {
+        snprintf(path, sizeof(path), CACHE_DIR "/%016llx-%zu.plan", (unsigned long long)network_fingerprint(net), bucket);
+        assert(access(path, F_OK) == 0);
+        remove(path);
+    }
+    network_free(reference);
+    network_free(net);
+}
+
+TEST(model_file_packed_section) {
+    Network *net = make_network();
+    Tensor *x = make_input(6);
+    Tensor *expected = network_forward(net, x);
+    const char *path = "/tmp/test_plan_model.bdnn";
+
+    // Without a plan the file has no packed section
+    network_save(net, path);
+    Network *plain = network_load(path);
+    assert(plain != NULL && plain->plan == NULL);
+
+    network_set_plan(net, network_plan_build(net, 6));
+    network_save(net, path);
+    Network *loaded = network_load(path);
+    assert(loaded != NULL && loaded->plan != NULL);
+    assert(loaded->plan->layers[0].kind == LAYER_PLAN_LINEAR);
+    assert(loaded->plan->layers[2].packed_weights != NULL);
+    assert(loaded->plan->layers[2].blocking.kc == net->plan->layers[2].blocking.kc);
+
+    Tensor *out = network_forward(loaded, x);
+    for (size_t i = 0; i < out->size; i++) ASSERT_FLOAT_EQ(out->data[i], expected->data[i]);
+
+    // Training invalidates the prepacked weights
+    Tensor *y = tensor_zeroes((size_t[]){6, 10}, 2);
+    Optimizer *opt = optimizer_create(loaded->parameters, loaded->num_parameters, SGD(0.1f, 0.0f));
+    network_train_step(loaded, x, y, opt, "mse");
+    assert(loaded->plan == NULL);
+
+    remove(path);
+    optimizer_free(opt);
+    tensor_free(y);
+    tensor_free(out);
+    tensor_free(expected);
+    tensor_free(x);
+    network_free(plain);
+    network_free(loaded);
+    network_free(net);
+}
+
+// ====================================================
+// ====================================================
+
+int main() {
+    printf("=== Running Plan Tests ===\n\n");
+
+    basednn_init();
+
+    RUN_TEST(fingerprint_stable_and_sensitive);
+    RUN_TEST(planned_forward_matches);
+    RUN_TEST(plan_mismatch_rejected);
+    RUN_TEST(linear_backward_matches_matmul);
+    RUN_TEST(stale_packed_weights_unused);
+    RUN_TEST(plan_save_load_roundtrip);
+    RUN_TEST(plan_cache_reuse);
+    RUN_TEST(bucketed_plans);
+    RUN_TEST(model_file_packed_section);
+
+    basednn_cleanup();
+
+    printf("\n=== All Plan Tests Passed! ===\n");
+    return 0;
+}
@@ -3,6 +3,8 @@
 #include <stdlib.h>
 #include <math.h>
 #include <assert.h>
+#include <string.h>
+#include <pthread.h>
 
 #define EPSILON 1e-4f
 #define ASSERT_FLOAT_EQ(a, b) assert(fabsf((a) - (b)) < EPSILON)
@@ -239,6 +241,97 @@ TEST(training_with_registry_loss) {
     network_free(net);
 }
 
+// ====================================================
+// Builtin Table Tests
+// ====================================================
+
+#define ASSERT_SORTED(table, count) \
+    for (size_t i = 1; i < (count); i++) assert(strcmp((table)[i - 1].name, (table)[i].name) < 0)
+
+TEST(builtin_tables_sorted) {
+    ASSERT_SORTED(builtin_layers, num_builtin_layers);
+    ASSERT_SORTED(builtin_operations, num_builtin_operations);
+    ASSERT_SORTED(builtin_tensor_ops, num_builtin_tensor_ops);
+    ASSERT_SORTED(builtin_optimizers, num_builtin_optimizers);
+
+    for (size_t i = 0; i < num_builtin_tensor_ops; i++) {
+        assert(get_tensor_op_backward_fn(builtin_tensor_ops[i].name) == builtin_tensor_ops[i].backward_fn);
+    }
+}
+
+static Tensor* custom_relu_forward(Layer *self, Tensor *input) {
+    (void)self;
+    return input;
+}
+
+TEST(builtins_without_init) {
+    registry_cleanup();
+    assert(get_layer_create_fn("linear") != NULL);
+    assert(get_loss_fn("cross_entropy") == tensor_cross_entropy);
+    assert(get_optimizer_step_fn("adam") != NULL);
+
+    // Runtime registrations override builtins until cleanup
+    LayerCreateFn create_fn = get_layer_create_fn("relu");
+    register_layer("relu", create_fn, custom_relu_forward);
+    assert(get_layer_forward_fn("relu") == custom_relu_forward);
+
+    register_operation("mse", tensor_add);
+    assert(get_loss_fn("mse") == tensor_mse);
+
+    registry_cleanup();
+    assert(get_layer_forward_fn("relu") != custom_relu_forward);
+    registry_init();
+}
+
+// ====================================================
+// Concurrency Tests
+// ====================================================
+
+#define PLUGIN_COUNT 200
+
+static Tensor* plugin_op(Tensor *a, Tensor *b) {
+    (void)b;
+    return a;
+}
+
+static void* register_plugins(void *arg) {
+    (void)arg;
+    char name[32];
+    for (int i = 0; i < PLUGIN_COUNT; i++) {
+        snprintf(name, sizeof(name), "plugin_op_%d", i);
+        register_operation(name, plugin_op);
+    }
+    return NULL;
+}
+
+TEST(lookups_during_registration) {
+    pthread_t writer;
+    pthread_create(&writer, NULL, register_plugins, NULL);
+
+    // Builtins stay visible while the table is being republished
+    for (int i = 0; i < 20000; i++) {
+        assert(get_layer_create_fn("linear") != NULL);
+        assert(get_loss_fn("mse") != NULL);
+    }
+    pthread_join(writer, NULL);
+
+    char name[32];
+    for (int i = 0; i < PLUGIN_COUNT; i++) {
+        snprintf(name, sizeof(name), "plugin_op_%d", i);
+        assert(get_operation_fn(name) == plugin_op);
+    }
+    assert(get_loss_fn("mse") == tensor_mse);
+}
+
+TEST(backend_priority) {
+    register_operation_backend("priority_op", plugin_op, 5);
+    register_operation_backend("priority_op", tensor_add, 1);
+    assert(get_operation_fn("priority_op") == plugin_op);
+
+    register_operation_backend("priority_op", tensor_mul, 9);
+    assert(get_operation_fn("priority_op") == tensor_mul);
+}
+
 // ====================================================
 // Main Test Runner
 // ====================================================
@@ -275,6 +368,14 @@ int main() {
     // Integration tests
     RUN_TEST(full_network_via_registry);
     RUN_TEST(training_with_registry_loss);
+
+    // Builtin table tests
+    RUN_TEST(builtin_tables_sorted);
+    RUN_TEST(builtins_without_init);
+
+    // Concurrency tests
+    RUN_TEST(lookups_during_registration);
+    RUN_TEST(backend_priority);
     
     basednn_cleanup();
     
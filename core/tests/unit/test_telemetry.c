@@ -0,0 +1,139 @@
+#include "../../include/basednn.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { printf("Running %s...\n", #name); test_##name(); printf("  PASSED\n"); } while(0)
+
+#define TELEMETRY_FILE "/tmp/basednn_test_telemetry.prom"
+
+// ====================================================
+// Helpers
+// ====================================================
+
+static char* read_file(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long len = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *text = malloc((size_t)len + 1);
+    size_t got = fread(text, 1, (size_t)len, file);
+    text[got] = '\0';
+    fclose(file);
+    return text;
+}
+
+// Value of the sample whose name and labels are exactly `series`, or -1
+static double sample_value(const char *text, const char *series) {
+    size_t len = strlen(series);
+    for (const char *line = text; *line; ) {
+        if (strncmp(line, series, len) == 0 && line[len] == ' ') return atof(line + len + 1);
+        const char *next = strchr(line, '\n');
+        if (!next) break;
+        line = next + 1;
+    }
+    return -1.0;
+}
+
+static Network* make_network(void) {
+    Network *net = network_create();
+    network_add_layer(net, layer_create(LINEAR(4, 8)));
+    network_add_layer(net, layer_create(RELU()));
+    network_add_layer(net, layer_create(LINEAR(8, 1)));
+    return net;
+}
+
+// ====================================================
+// Telemetry Tests
+// ====================================================
+
+TEST(snapshot_format) {
+    telemetry_record_step(32, 0.003, 0.5f);
+    telemetry_record_step(32, 0.2, 0.25f);
+    telemetry_record_op("odd \"name\"", 0, 0.001);
+
+    remove(TELEMETRY_FILE);
+    assert(telemetry_write(TELEMETRY_FILE));
+    char *text = read_file(TELEMETRY_FILE);
+    assert(text != NULL);
+
+    assert(strstr(text, "# TYPE basednn_train_step_seconds histogram\n") != NULL);
+    assert(sample_value(text, "basednn_train_steps_total") == 2.0);
+    assert(sample_value(text, "basednn_train_samples_total") == 64.0);
+    assert(sample_value(text, "basednn_train_loss") == 0.25);
+    assert(sample_value(text, "basednn_train_step_seconds_bucket{le=\"0.0025\"}") == 0.0);
+    assert(sample_value(text, "basednn_train_step_seconds_bucket{le=\"0.005\"}") == 1.0);
+    assert(sample_value(text, "basednn_train_step_seconds_bucket{le=\"+Inf\"}") == 2.0);
+    assert(sample_value(text, "basednn_train_step_seconds_count") == 2.0);
+    assert(sample_value(text, "basednn_op_calls_total{op=\"odd \\\"name\\\"\",pass=\"forward\"}") == 1.0);
+    assert(sample_value(text, "basednn_buffer_huge_page_bytes") == (double)buffer_stats().mapped_bytes);
+    assert(sample_value(text, "basednn_threadpool_threads") >= 1.0);
+    assert(sample_value(text, "basednn_threadpool_busy_seconds_total{thread=\"0\"}") >= 0.0);
+    assert(sample_value(text, "basednn_threadpool_imbalance{stat=\"max\"}") >= 0.0);
+
+    // The temporary file is renamed away
+    assert(access(TELEMETRY_FILE ".tmp", F_OK) != 0);
+    free(text);
+}
+
+TEST(training_updates_file) {
+    Network *net = make_network();
+    Optimizer *opt = optimizer_create(net->parameters, net->num_parameters, SGD(0.01f, 0.0f));
+    Tensor *x = tensor_randn((size_t[]){40, 4}, 2, 1);
+    Tensor *y = tensor_randn((size_t[]){40, 1}, 2, 2);
+
+    remove(TELEMETRY_FILE);
+    assert(telemetry_start((TelemetryConfig){ .path = TELEMETRY_FILE, .interval_ms = 10 }));
+    assert(telemetry_enabled());
+
+    // Counters carry on from snapshot_format's two steps
+    double steps_before = 2.0;
+    network_train(net, opt, x, y, 3, 10, "mse", 0);
+    usleep(50000);
+
+    char *text = read_file(TELEMETRY_FILE);
+    assert(text != NULL);
+    assert(sample_value(text, "basednn_train_steps_total") == steps_before + 12.0);
+    assert(sample_value(text, "basednn_op_calls_total{op=\"linear\",pass=\"forward\"}") == 24.0);
+    assert(sample_value(text, "basednn_op_calls_total{op=\"linear\",pass=\"backward\"}") == 24.0);
+    assert(sample_value(text, "basednn_op_calls_total{op=\"relu\",pass=\"backward\"}") == 12.0);
+    free(text);
+
+    // Stopping writes a final snapshot and turns recording off
+    network_train_step(net, x, y, opt, "mse");
+    telemetry_stop();
+    assert(!telemetry_enabled());
+    network_train_step(net, x, y, opt, "mse");
+
+    text = read_file(TELEMETRY_FILE);
+    assert(sample_value(text, "basednn_train_steps_total") == steps_before + 13.0);
+    assert(sample_value(text, "basednn_train_samples_total") == 64.0 + 160.0);
+    free(text);
+
+    remove(TELEMETRY_FILE);
+    optimizer_free(opt);
+    tensor_free(x);
+    tensor_free(y);
+    network_free(net);
+}
+
+// ====================================================
+// ====================================================
+
+int main() {
+    printf("=== Running Telemetry Tests ===\n\n");
+
+    basednn_init();
+
+    RUN_TEST(snapshot_format);
+    RUN_TEST(training_updates_file);
+
+    basednn_cleanup();
+
+    printf("\n=== All Telemetry Tests Passed! ===\n");
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include "../../include/threadpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { printf("Running %s...\n", #name); test_##name(); printf("  PASSED\n"); } while(0)
+
+// ====================================================
+// Helpers
+// ====================================================
+
+static void mark_range(void *ctx, size_t start, size_t end) {
+    int *hits = (int *)ctx;
+    for (size_t i = start; i < end; i++) {
+        __atomic_fetch_add(&hits[i], 1, __ATOMIC_RELAXED);
+    }
+}
+
+typedef struct NestedContext {
+    ThreadPool *pool;
+    int *hits;
+    size_t inner;
+} NestedContext;
+
+static void nested_range(void *ctx, size_t start, size_t end) {
+    NestedContext *nested = (NestedContext *)ctx;
+    for (size_t i = start; i < end; i++) {
+        threadpool_parallel_for(nested->pool, nested->inner, 1, mark_range, nested->hits + i * nested->inner);
+    }
+}
+
+// ====================================================
+// Thread Pool Tests
+// ====================================================
+
+TEST(threadpool_create) {
+    ThreadPool *pool = threadpool_create(4);
+    assert(pool != NULL);
+    assert(threadpool_num_threads(pool) == 4);
+    threadpool_free(pool);
+}
+
+TEST(threadpool_parallel_for_covers_range) {
+    ThreadPool *pool = threadpool_create(4);
+    size_t n = 10007;
+    int *hits = calloc(n, sizeof(int));
+
+    threadpool_parallel_for(pool, n, 16, mark_range, hits);
+
+    for (size_t i = 0; i < n; i++) {
+        assert(hits[i] == 1);
+    }
+
+    free(hits);
+    threadpool_free(pool);
+}
+
+TEST(threadpool_parallel_for_repeated) {
+    ThreadPool *pool = threadpool_create(3);
+    size_t n = 257;
+    int *hits = calloc(n, sizeof(int));
+
+    for (int round = 0; round < 100; round++) {
+        threadpool_parallel_for(pool, n, 1, mark_range, hits);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        assert(hits[i] == 100);
+    }
+
+    free(hits);
+    threadpool_free(pool);
+}
+
+TEST(threadpool_nested) {
+    ThreadPool *pool = threadpool_create(4);
+    NestedContext nested = { pool, calloc(64 * 32, sizeof(int)), 32 };
+
+    threadpool_parallel_for(pool, 64, 1, nested_range, &nested);
+
+    for (size_t i = 0; i < 64 * 32; i++) {
+        assert(nested.hits[i] == 1);
+    }
+
+    free(nested.hits);
+    threadpool_free(pool);
+}
+
+TEST(threadpool_single_thread) {
+    ThreadPool *pool = threadpool_create(1);
+    int hits[10] = {0};
+
+    threadpool_parallel_for(pool, 10, 1, mark_range, hits);
+
+    for (size_t i = 0; i < 10; i++) {
+        assert(hits[i] == 1);
+    }
+    threadpool_free(pool);
+}
+
+TEST(threadpool_stats) {
+    ThreadPool *pool = threadpool_create(4);
+    int *hits = calloc(1000, sizeof(int));
+
+    for (int r = 0; r < 20; r++) threadpool_parallel_for(pool, 1000, 10, mark_range, hits);
+    threadpool_parallel_for(pool, 5, 10, mark_range, hits);
+
+    ThreadPoolStats stats = threadpool_stats(pool);
+    assert(stats.parallel_regions == 20);
+    assert(stats.serial_regions == 1);
+    assert(stats.chunks == 20 * 16);
+    assert(stats.mean_imbalance >= 1.0 && stats.max_imbalance >= stats.mean_imbalance);
+    assert(stats.utilization >= 0.0 && stats.utilization <= 1.0);
+
+    uint64_t chunks = 0, excess = 0;
+    for (size_t t = 0; t < threadpool_num_threads(pool); t++) {
+        ThreadStats ts = threadpool_thread_stats(pool, t);
+        assert(ts.busy_seconds >= 0.0);
+        chunks += ts.chunks;
+        excess += ts.excess_chunks;
+    }
+    assert(chunks == stats.chunks && excess == stats.excess_chunks);
+    assert(threadpool_thread_stats(pool, 0).idle_seconds == 0.0);
+
+    threadpool_reset_stats(pool);
+    stats = threadpool_stats(pool);
+    assert(stats.parallel_regions == 0 && stats.chunks == 0 && stats.max_imbalance == 0.0);
+
+    free(hits);
+    threadpool_free(pool);
+}
+
+TEST(threadpool_default) {
+    ThreadPool *pool = threadpool_default();
+    assert(pool != NULL);
+    assert(threadpool_default() == pool);
+    assert(threadpool_num_threads(pool) >= 1);
+    threadpool_default_cleanup();
+}
+
+// ====================================================
+// ====================================================
+
+int main() {
+    printf("=== Running Thread Pool Tests ===\n\n");
+
+    RUN_TEST(threadpool_create);
+    RUN_TEST(threadpool_parallel_for_covers_range);
+    RUN_TEST(threadpool_parallel_for_repeated);
+    RUN_TEST(threadpool_nested);
+    RUN_TEST(threadpool_single_thread);
+    RUN_TEST(threadpool_stats);
+    RUN_TEST(threadpool_default);
+
+    printf("\n=== All Thread Pool Tests Passed! ===\n");
+    return 0;
+}
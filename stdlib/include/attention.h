@@ -19,6 +19,35 @@ void backward_layer_norm(Tensor *output);
 Tensor* tensor_batch_norm(Tensor *input, Tensor *gamma, Tensor *beta, Tensor *running_mean, Tensor *running_var, float momentum, float eps, int training);
 void backward_batch_norm(Tensor *output);
 
+// Post-norm encoder block over [batch, seq_len, embed_dim] (or [seq_len,
+// embed_dim]). params is the flat parameter tensor created by the layer.
+Tensor* tensor_transformer_encoder(Tensor *input, Tensor *params, size_t num_heads, size_t ff_hidden_dim);
+void backward_transformer_encoder(Tensor *output);
+
+// Packed variable-length batches: num_sequences sequences stored back to back
+// as the rows of input [offsets[num_sequences], embed_dim], sequence b being
+// rows [offsets[b], offsets[b + 1]). Attention is block-diagonal per sequence
+// and every other step runs over the real tokens only, so nothing is spent on
+// padding. Row-wise ops such as tensor_linear take packed values as they are.
+// Packing is op level only: the layers and network entry points carry no
+// offsets and still treat a 2D input as a single sequence.
+Tensor* tensor_transformer_encoder_packed(Tensor *input, const size_t *offsets, size_t num_sequences,
+                                          Tensor *params, size_t num_heads, size_t ff_hidden_dim);
+
+// Sinusoidal table of at least [max_len, embed_dim], computed once per
+// embed_dim and shared by every layer that asks for it. Tables stay valid
+// until positional_encoding_cache_clear().
+const float* positional_encoding_table(size_t max_len, size_t embed_dim);
+void positional_encoding_cache_clear(void);
+
+// Adds table rows [0, seq_len) to every sequence of input (which may be a view)
+Tensor* tensor_positional_encoding(Tensor *input, const float *table, size_t max_len);
+void backward_positional_encoding(Tensor *output);
+
+// Same for packed sequences, each starting again at table row 0
+Tensor* tensor_positional_encoding_packed(Tensor *input, const size_t *offsets, size_t num_sequences,
+                                          const float *table, size_t max_len);
+
 // ====================================================
 // Attention Layers
 // ====================================================
@@ -64,4 +93,6 @@ typedef struct EmbeddingParams {
 
 #define EMBEDDING(num_emb, emb_dim)(LayerConfig){.name="embedding", .params=&(EmbeddingParams){num_emb, emb_dim}}
 
+void attention_register_builtins(void);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef BASEDNN_STDLIB_H
+#define BASEDNN_STDLIB_H
+
+#include "../../core/include/basednn.h"
+#include "recurrent.h"
+#include "attention.h"
+#include "sampled_softmax.h"
+
+// Register the standard library layers and operations
+// Call this once after basednn_init()
+static inline void basednn_stdlib_init() {
+    recurrent_register_builtins();
+    attention_register_builtins();
+    sampled_softmax_register_builtins();
+}
+
+// Release shared tables once every stdlib layer has been freed
+static inline void basednn_stdlib_cleanup() {
+    positional_encoding_cache_clear();
+}
+
+#endif
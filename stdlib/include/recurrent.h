@@ -0,0 +1,34 @@
+#ifndef RECURRENT_H
+#define RECURRENT_H
+
+#include "../../core/include/tensor.h"
+#include "../../core/include/layer.h"
+
+// ====================================================
+// Recurrent Operations
+// ====================================================
+
+// input is [batch, seq_len, input_size]. weights stacks the input and
+// recurrent matrices as [input_size + hidden_size, gates * hidden_size].
+Tensor* tensor_lstm(Tensor *input, Tensor *weights, Tensor *bias, int return_sequences);
+void backward_lstm(Tensor *output);
+
+Tensor* tensor_gru(Tensor *input, Tensor *weights, Tensor *bias, int return_sequences);
+void backward_gru(Tensor *output);
+
+// ====================================================
+// Recurrent Layers
+// ====================================================
+
+typedef struct RecurrentParams {
+    size_t input_size;
+    size_t hidden_size;
+    int return_sequences;
+} RecurrentParams;
+
+#define LSTM(in_size, hidden_size, ret_seq)(LayerConfig){.name="lstm", .params=&(RecurrentParams){in_size, hidden_size, ret_seq}}
+#define GRU(in_size, hidden_size, ret_seq)(LayerConfig){.name="gru", .params=&(RecurrentParams){in_size, hidden_size, ret_seq}}
+
+void recurrent_register_builtins(void);
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef SAMPLED_SOFTMAX_H
+#define SAMPLED_SOFTMAX_H
+
+#include <stdint.h>
+#include "../../core/include/tensor.h"
+#include "../../core/include/layer.h"
+
+// ====================================================
+// Candidate Samplers
+// ====================================================
+
+typedef struct CandidateSampler CandidateSampler;
+
+struct CandidateSampler {
+    size_t num_classes;
+    size_t (*sample)(const CandidateSampler *self, uint64_t *state);
+    float (*log_prob)(const CandidateSampler *self, size_t label);   // log Q(label)
+    void *ctx;
+};
+
+// Zipfian P(k) = log((k + 2) / (k + 1)) / log(V + 1), for labels sorted by frequency
+size_t log_uniform_sample(const CandidateSampler *self, uint64_t *state);
+float log_uniform_log_prob(const CandidateSampler *self, size_t label);
+
+#define LOG_UNIFORM_SAMPLER(n_classes) (CandidateSampler){ n_classes, log_uniform_sample, log_uniform_log_prob, NULL }
+
+// ====================================================
+// Sampled Softmax Operations
+// ====================================================
+
+// hidden is [batch, dim], weights is [num_classes, dim] (one row per class),
+// bias is [num_classes] or NULL. Returns softmax probabilities [batch, num_classes].
+Tensor* tensor_full_softmax(Tensor *hidden, Tensor *weights, Tensor *bias);
+void backward_full_softmax(Tensor *output);
+
+// Mean cross-entropy of each label against num_sampled negatives drawn once per
+// call and shared across the batch. Logits are corrected by log(num_sampled * Q)
+// and negatives equal to a row's label are masked. labels holds class indices [batch].
+// rng_state is advanced so consecutive calls draw fresh negatives.
+Tensor* tensor_sampled_softmax_loss(Tensor *hidden, Tensor *weights, Tensor *bias, Tensor *labels,
+                                    size_t num_sampled, const CandidateSampler *sampler, uint64_t *rng_state);
+void backward_sampled_softmax_loss(Tensor *loss);
+
+// ====================================================
+// Sampled Softmax Layer
+// ====================================================
+
+typedef struct SampledSoftmaxParams {
+    size_t in_features;
+    size_t num_classes;
+    size_t num_sampled;
+} SampledSoftmaxParams;
+
+// Forward computes the full softmax (evaluation); train with layer_sampled_softmax_loss
+#define SAMPLEDSOFTMAX(in_features, n_classes, n_sampled)(LayerConfig){.name="sampled_softmax", .params=&(SampledSoftmaxParams){in_features, n_classes, n_sampled}}
+
+// Sampler may be NULL to use a log-uniform sampler over the layer's classes
+Tensor* layer_sampled_softmax_loss(Layer *layer, Tensor *hidden, Tensor *labels,
+                                   const CandidateSampler *sampler, uint64_t *rng_state);
+
+void sampled_softmax_register_builtins(void);
+
+#endif
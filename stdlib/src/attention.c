@@ -0,0 +1,742 @@
+#include "../include/attention.h"
+#include "../../core/include/layer.h"
+#include "../../core/include/registry.h"
+#include "../../core/include/kernels.h"
+#include "../../core/include/alloc.h"
+#include "../../core/include/threadpool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#define ATTENTION_Q_TILE 64
+#define FFN_ROW_TILE 64
+#define LAYER_NORM_EPS 1e-5f
+#define GELU_COEFF 0.044715f
+#define SQRT_2_OVER_PI 0.7978845608f
+
+// ====================================================
+// Fused Kernels
+// ====================================================
+
+// Row-wise layer norm of x into out, saving xhat and 1/std for backward
+static void layer_norm_rows(const float *x, float *out, float *xhat, float *rstd,
+                            const float *gamma, const float *beta, size_t rows, size_t dim) {
+    for (size_t r = 0; r < rows; r++) {
+        const float *row = x + r * dim;
+        float mean = 0.0f;
+        for (size_t j = 0; j < dim; j++) mean += row[j];
+        mean /= (float)dim;
+
+        float var = 0.0f;
+        for (size_t j = 0; j < dim; j++) {
+            float d = row[j] - mean;
+            var += d * d;
+        }
+        float inv = 1.0f / sqrtf(var / (float)dim + LAYER_NORM_EPS);
+        rstd[r] = inv;
+
+        for (size_t j = 0; j < dim; j++) {
+            float n = (row[j] - mean) * inv;
+            xhat[r * dim + j] = n;
+            out[r * dim + j] = n * gamma[j] + beta[j];
+        }
+    }
+}
+
+// dx = rstd * (dxhat - mean(dxhat) - xhat * mean(dxhat * xhat)), dxhat = dy * gamma
+static void layer_norm_backward_rows(const float *dy, const float *xhat, const float *rstd, const float *gamma,
+                                     float *dx, float *dgamma, float *dbeta, size_t rows, size_t dim) {
+    for (size_t r = 0; r < rows; r++) {
+        const float *g = dy + r * dim;
+        const float *n = xhat + r * dim;
+        float sum = 0.0f, sum_n = 0.0f;
+
+        for (size_t j = 0; j < dim; j++) {
+            float d = g[j] * gamma[j];
+            sum += d;
+            sum_n += d * n[j];
+            if (dgamma) dgamma[j] += g[j] * n[j];
+            if (dbeta) dbeta[j] += g[j];
+        }
+        sum /= (float)dim;
+        sum_n /= (float)dim;
+
+        for (size_t j = 0; j < dim; j++) {
+            dx[r * dim + j] = rstd[r] * (g[j] * gamma[j] - sum - n[j] * sum_n);
+        }
+    }
+}
+
+static void broadcast_rows(float *dst, const float *row, size_t rows, size_t dim) {
+    for (size_t r = 0; r < rows; r++) {
+        memcpy(dst + r * dim, row, dim * sizeof(float));
+    }
+}
+
+static void column_sums(float *dst, const float *src, size_t rows, size_t dim) {
+    for (size_t r = 0; r < rows; r++) {
+        for (size_t j = 0; j < dim; j++) dst[j] += src[r * dim + j];
+    }
+}
+
+static inline float gelu(float x) {
+    return 0.5f * x * (1.0f + tanhf(SQRT_2_OVER_PI * (x + GELU_COEFF * x * x * x)));
+}
+
+static inline float gelu_grad(float x) {
+    float t = tanhf(SQRT_2_OVER_PI * (x + GELU_COEFF * x * x * x));
+    return 0.5f * (1.0f + t) + 0.5f * x * (1.0f - t * t) * SQRT_2_OVER_PI * (1.0f + 3.0f * GELU_COEFF * x * x);
+}
+
+// ====================================================
+// Transformer Encoder
+// ====================================================
+
+// Offsets of each parameter inside the flat parameter tensor
+typedef struct EncoderLayout {
+    size_t w_qkv, b_qkv;
+    size_t w_o, b_o;
+    size_t ln1_g, ln1_b;
+    size_t w_1, b_1;
+    size_t w_2, b_2;
+    size_t ln2_g, ln2_b;
+    size_t total;
+} EncoderLayout;
+
+static EncoderLayout encoder_layout(size_t E, size_t F) {
+    EncoderLayout l;
+    size_t o = 0;
+    l.w_qkv = o; o += E * 3 * E;
+    l.b_qkv = o; o += 3 * E;
+    l.w_o = o;   o += E * E;
+    l.b_o = o;   o += E;
+    l.ln1_g = o; o += E;
+    l.ln1_b = o; o += E;
+    l.w_1 = o;   o += E * F;
+    l.b_1 = o;   o += F;
+    l.w_2 = o;   o += F * E;
+    l.b_2 = o;   o += E;
+    l.ln2_g = o; o += E;
+    l.ln2_b = o; o += E;
+    l.total = o;
+    return l;
+}
+
+// Sequences are rows [offsets[b], offsets[b + 1]) of the N token rows. Dense
+// batches are the special case of equal lengths.
+typedef struct EncoderCache {
+    size_t num_sequences, tokens, max_len, embed_dim, ff_dim, num_heads;
+    size_t *offsets;        // [num_sequences + 1]
+    size_t *prob_offsets;   // [num_sequences] start of each sequence's scores
+    float *qkv;         // [N, 3E]
+    float *probs;       // [heads, S_b, S_b] per sequence
+    float *context;     // [N, E]
+    float *x1;          // [N, E] output of the first layer norm
+    float *xhat1;       // [N, E]
+    float *rstd1;       // [N]
+    float *ff_pre;      // [N, F]
+    float *ff_act;      // [N, F]
+    float *xhat2;       // [N, E]
+    float *rstd2;       // [N]
+} EncoderCache;
+
+static EncoderCache* encoder_cache_create(const size_t *offsets, size_t num_sequences, size_t E, size_t F, size_t heads) {
+    size_t N = offsets[num_sequences];
+    size_t header = (sizeof(EncoderCache) + (2 * num_sequences + 1) * sizeof(size_t) + 63) & ~(size_t)63;
+
+    size_t scores = 0, max_len = 0;
+    for (size_t b = 0; b < num_sequences; b++) {
+        size_t len = offsets[b + 1] - offsets[b];
+        scores += heads * len * len;
+        if (len > max_len) max_len = len;
+    }
+
+    size_t floats = N * 3 * E + scores + 4 * N * E + 2 * N + 2 * N * F;
+    EncoderCache *c = (EncoderCache *)malloc(header + floats * sizeof(float));
+    if (!c) return NULL;
+
+    c->num_sequences = num_sequences;
+    c->tokens = N;
+    c->max_len = max_len;
+    c->embed_dim = E;
+    c->ff_dim = F;
+    c->num_heads = heads;
+
+    c->offsets = (size_t *)(c + 1);
+    c->prob_offsets = c->offsets + num_sequences + 1;
+    memcpy(c->offsets, offsets, (num_sequences + 1) * sizeof(size_t));
+    for (size_t b = 0, o = 0; b < num_sequences; b++) {
+        size_t len = offsets[b + 1] - offsets[b];
+        c->prob_offsets[b] = o;
+        o += heads * len * len;
+    }
+
+    float *p = (float *)((char *)c + header);
+    c->qkv = p;     p += N * 3 * E;
+    c->probs = p;   p += scores;
+    c->context = p; p += N * E;
+    c->x1 = p;      p += N * E;
+    c->xhat1 = p;   p += N * E;
+    c->rstd1 = p;   p += N;
+    c->ff_pre = p;  p += N * F;
+    c->ff_act = p;  p += N * F;
+    c->xhat2 = p;   p += N * E;
+    c->rstd2 = p;
+    return c;
+}
+
+typedef struct AttentionTask {
+    EncoderCache *cache;
+    const float *dcontext;
+    float *dqkv;
+    float *scratch;     // backward: num_scratch [max_len, max_len] score buffers
+    int *scratch_busy;
+    size_t num_scratch;
+} AttentionTask;
+
+// Scaled dot-product attention for one (sequence, head) pair, processed in
+// query tiles so each score tile stays cache resident while it is scaled,
+// softmaxed and applied to V. The probabilities are still written out in
+// full, [S, S] per head, because backward reuses them. Tokens only attend
+// within their own sequence, so packed batches are block-diagonal.
+static void attention_forward_heads(void *ctx, size_t start, size_t end) {
+    AttentionTask *task = (AttentionTask *)ctx;
+    EncoderCache *c = task->cache;
+    size_t E = c->embed_dim, heads = c->num_heads, d = E / heads;
+    float scale = 1.0f / sqrtf((float)d);
+
+    for (size_t bh = start; bh < end; bh++) {
+        size_t b = bh / heads, h = bh % heads;
+        size_t first = c->offsets[b], S = c->offsets[b + 1] - first;
+        const float *Q = c->qkv + first * 3 * E + h * d;
+        const float *K = Q + E;
+        const float *V = Q + 2 * E;
+        float *P = c->probs + c->prob_offsets[b] + h * S * S;
+        float *ctx_out = c->context + first * E + h * d;
+        if (S == 0) continue;
+
+        for (size_t q0 = 0; q0 < S; q0 += ATTENTION_Q_TILE) {
+            size_t rows = S - q0 < ATTENTION_Q_TILE ? S - q0 : ATTENTION_Q_TILE;
+            float *tile = P + q0 * S;
+
+            sgemm(0, 1, rows, S, d, scale, Q + q0 * 3 * E, 3 * E, K, 3 * E, 0.0f, tile, S);
+
+            for (size_t i = 0; i < rows; i++) {
+                float *row = tile + i * S;
+                float max_val = row[0];
+                for (size_t j = 1; j < S; j++) if (row[j] > max_val) max_val = row[j];
+                float sum = 0.0f;
+                for (size_t j = 0; j < S; j++) {
+                    row[j] = expf(row[j] - max_val);
+                    sum += row[j];
+                }
+                float inv = 1.0f / sum;
+                for (size_t j = 0; j < S; j++) row[j] *= inv;
+            }
+
+            sgemm(0, 0, rows, d, S, 1.0f, tile, S, V, 3 * E, 0.0f, ctx_out + q0 * E, E);
+        }
+    }
+}
+
+static void attention_backward_heads(void *ctx, size_t start, size_t end) {
+    AttentionTask *task = (AttentionTask *)ctx;
+    EncoderCache *c = task->cache;
+    size_t E = c->embed_dim, heads = c->num_heads, d = E / heads;
+    float scale = 1.0f / sqrtf((float)d);
+
+    // At most one chunk per pool thread runs at a time, so a free buffer
+    // is always left for this one
+    size_t slot = 0;
+    while (__atomic_exchange_n(&task->scratch_busy[slot], 1, __ATOMIC_ACQUIRE)) {
+        slot = (slot + 1) % task->num_scratch;
+    }
+    float *dP = task->scratch + slot * c->max_len * c->max_len;
+
+    for (size_t bh = start; bh < end; bh++) {
+        size_t b = bh / heads, h = bh % heads;
+        size_t first = c->offsets[b], S = c->offsets[b + 1] - first;
+        if (S == 0) continue;
+
+        const float *Q = c->qkv + first * 3 * E + h * d;
+        const float *K = Q + E;
+        const float *V = Q + 2 * E;
+        const float *P = c->probs + c->prob_offsets[b] + h * S * S;
+        const float *dctx = task->dcontext + first * E + h * d;
+        float *dQ = task->dqkv + first * 3 * E + h * d;
+        float *dK = dQ + E;
+        float *dV = dQ + 2 * E;
+
+        // dV = P^T dctx, dP = dctx V^T
+        sgemm(1, 0, S, d, S, 1.0f, P, S, dctx, E, 0.0f, dV, 3 * E);
+        sgemm(0, 1, S, S, d, 1.0f, dctx, E, V, 3 * E, 0.0f, dP, S);
+
+        // Softmax backward: dS = P * (dP - rowsum(dP * P))
+        for (size_t i = 0; i < S; i++) {
+            float dot = 0.0f;
+            for (size_t j = 0; j < S; j++) dot += dP[i * S + j] * P[i * S + j];
+            for (size_t j = 0; j < S; j++) dP[i * S + j] = P[i * S + j] * (dP[i * S + j] - dot);
+        }
+
+        sgemm(0, 0, S, d, S, scale, dP, S, K, 3 * E, 0.0f, dQ, 3 * E);
+        sgemm(1, 0, S, d, S, scale, dP, S, Q, 3 * E, 0.0f, dK, 3 * E);
+    }
+
+    __atomic_store_n(&task->scratch_busy[slot], 0, __ATOMIC_RELEASE);
+}
+
+typedef struct FeedForwardTask {
+    EncoderCache *cache;
+    const float *w_1;
+    const float *b_1;
+} FeedForwardTask;
+
+// First FFN layer over row tiles, with the bias as the GEMM's initial C and
+// GELU applied to each tile while it is still in cache
+static void feed_forward_tiles(void *ctx, size_t start, size_t end) {
+    FeedForwardTask *task = (FeedForwardTask *)ctx;
+    EncoderCache *c = task->cache;
+    size_t N = c->tokens, E = c->embed_dim, F = c->ff_dim;
+
+    for (size_t t = start; t < end; t++) {
+        size_t r0 = t * FFN_ROW_TILE;
+        size_t rows = N - r0 < FFN_ROW_TILE ? N - r0 : FFN_ROW_TILE;
+        float *pre = c->ff_pre + r0 * F;
+        float *act = c->ff_act + r0 * F;
+
+        broadcast_rows(pre, task->b_1, rows, F);
+        sgemm(0, 0, rows, F, E, 1.0f, c->x1 + r0 * E, E, task->w_1, F, 1.0f, pre, F);
+        for (size_t i = 0; i < rows * F; i++) act[i] = gelu(pre[i]);
+    }
+}
+
+// Everything but attention works on the N token rows as one matrix, so its
+// cost follows the real token count whatever the sequence lengths
+static Tensor* encoder_forward(Tensor *input, const size_t *offsets, size_t num_sequences,
+                               Tensor *params, size_t num_heads, size_t ff_hidden_dim) {
+    size_t E = input->shape[input->ndim - 1];
+    size_t F = ff_hidden_dim;
+    size_t N = offsets[num_sequences];
+    EncoderLayout l = encoder_layout(E, F);
+    if (E % num_heads != 0 || params->size != l.total) return NULL;
+
+    EncoderCache *c = encoder_cache_create(offsets, num_sequences, E, F, num_heads);
+    float *resid = (float *)malloc(N * E * sizeof(float));
+    Tensor *out = tensor_create(input->shape, input->ndim);
+    if (!c || !resid || !out) {
+        free(c);
+        free(resid);
+        tensor_free(out);
+        return NULL;
+    }
+
+    const float *X = input->data;
+    const float *W = params->data;
+
+    // QKV projection as a single GEMM with the bias folded in
+    broadcast_rows(c->qkv, W + l.b_qkv, N, 3 * E);
+    sgemm(0, 0, N, 3 * E, E, 1.0f, X, E, W + l.w_qkv, 3 * E, 1.0f, c->qkv, 3 * E);
+
+    AttentionTask task = { c, NULL, NULL, NULL, NULL, 0 };
+    threadpool_parallel_for(threadpool_default(), num_sequences * num_heads, 1, attention_forward_heads, &task);
+
+    // Output projection accumulated onto the residual and bias
+    memcpy(resid, X, N * E * sizeof(float));
+    for (size_t r = 0; r < N; r++) {
+        for (size_t j = 0; j < E; j++) resid[r * E + j] += W[l.b_o + j];
+    }
+    sgemm(0, 0, N, E, E, 1.0f, c->context, E, W + l.w_o, E, 1.0f, resid, E);
+    layer_norm_rows(resid, c->x1, c->xhat1, c->rstd1, W + l.ln1_g, W + l.ln1_b, N, E);
+
+    // Feed-forward, first layer with its bias and GELU per row tile
+    FeedForwardTask ff = { c, W + l.w_1, W + l.b_1 };
+    threadpool_parallel_for(threadpool_default(), (N + FFN_ROW_TILE - 1) / FFN_ROW_TILE, 1, feed_forward_tiles, &ff);
+
+    for (size_t r = 0; r < N; r++) {
+        for (size_t j = 0; j < E; j++) resid[r * E + j] = c->x1[r * E + j] + W[l.b_2 + j];
+    }
+    sgemm(0, 0, N, E, F, 1.0f, c->ff_act, F, W + l.w_2, E, 1.0f, resid, E);
+    layer_norm_rows(resid, out->data, c->xhat2, c->rstd2, W + l.ln2_g, W + l.ln2_b, N, E);
+
+    free(resid);
+
+    if (tensor_grad_enabled() && (input->requires_grad || params->requires_grad)) {
+        out->requires_grad = 1;
+        out->op_name = strdup("transformer_encoder");
+        out->num_inputs = 2;
+        out->inputs = (Tensor **)malloc(2 * sizeof(Tensor *));
+        out->inputs[0] = input;
+        out->inputs[1] = params;
+        out->backward_fn = backward_transformer_encoder;
+        out->extra_data = c;
+    } else {
+        free(c);
+    }
+
+    return out;
+}
+
+Tensor* tensor_transformer_encoder(Tensor *input, Tensor *params, size_t num_heads, size_t ff_hidden_dim) {
+    if (!input || !params || num_heads == 0) return NULL;
+    if (input->ndim != 2 && input->ndim != 3) return NULL;
+
+    size_t S = input->shape[input->ndim - 2];
+    size_t B = input->ndim == 3 ? input->shape[0] : 1;
+    if (S == 0 || B == 0) return NULL;
+
+    size_t *offsets = (size_t *)malloc((B + 1) * sizeof(size_t));
+    if (!offsets) return NULL;
+    for (size_t b = 0; b <= B; b++) offsets[b] = b * S;
+
+    Tensor *out = encoder_forward(input, offsets, B, params, num_heads, ff_hidden_dim);
+    free(offsets);
+    return out;
+}
+
+static int valid_offsets(Tensor *input, const size_t *offsets, size_t num_sequences) {
+    if (!offsets || num_sequences == 0 || offsets[0] != 0) return 0;
+    for (size_t b = 0; b < num_sequences; b++) {
+        if (offsets[b + 1] < offsets[b]) return 0;
+    }
+    return offsets[num_sequences] == input->shape[0];
+}
+
+Tensor* tensor_transformer_encoder_packed(Tensor *input, const size_t *offsets, size_t num_sequences,
+                                          Tensor *params, size_t num_heads, size_t ff_hidden_dim) {
+    if (!input || !params || num_heads == 0 || input->ndim != 2) return NULL;
+    if (input->shape[0] == 0 || !valid_offsets(input, offsets, num_sequences)) return NULL;
+
+    return encoder_forward(input, offsets, num_sequences, params, num_heads, ff_hidden_dim);
+}
+
+void backward_transformer_encoder(Tensor *output) {
+    if (!output || !output->inputs || !output->extra_data) return;
+
+    Tensor *input = output->inputs[0];
+    Tensor *params = output->inputs[1];
+    EncoderCache *c = (EncoderCache *)output->extra_data;
+
+    size_t E = c->embed_dim, F = c->ff_dim;
+    size_t N = c->tokens;
+    EncoderLayout l = encoder_layout(E, F);
+    const float *W = params->data;
+
+    ThreadPool *pool = threadpool_default();
+    size_t num_scratch = threadpool_num_threads(pool);
+    float *dy = (float *)malloc(N * E * sizeof(float));
+    float *dx1 = (float *)malloc(N * E * sizeof(float));
+    float *dff = (float *)malloc(N * F * sizeof(float));
+    float *dqkv = (float *)malloc(N * 3 * E * sizeof(float));
+    float *scratch = (float *)malloc(num_scratch * c->max_len * c->max_len * sizeof(float));
+    int *scratch_busy = (int *)calloc(num_scratch, sizeof(int));
+    if (!dy || !dx1 || !dff || !dqkv || !scratch || !scratch_busy) goto cleanup;
+
+    float *dW = NULL;
+    if (params->requires_grad) {
+        if (!params->grad) params->grad = (float *)buffer_calloc(params->size, sizeof(float));
+        if (!params->grad) goto cleanup;
+        dW = params->grad;
+    }
+    if (input->requires_grad && !input->grad) {
+        input->grad = (float *)buffer_calloc(input->size, sizeof(float));
+        if (!input->grad) goto cleanup;
+    }
+
+    // Second layer norm
+    layer_norm_backward_rows(output->grad, c->xhat2, c->rstd2, W + l.ln2_g, dy,
+                             dW ? dW + l.ln2_g : NULL, dW ? dW + l.ln2_b : NULL, N, E);
+
+    // Feed-forward: the residual passes dy straight through to x1
+    memcpy(dx1, dy, N * E * sizeof(float));
+    sgemm(0, 1, N, F, E, 1.0f, dy, E, W + l.w_2, E, 0.0f, dff, F);
+    for (size_t i = 0; i < N * F; i++) dff[i] *= gelu_grad(c->ff_pre[i]);
+    sgemm(0, 1, N, E, F, 1.0f, dff, F, W + l.w_1, F, 1.0f, dx1, E);
+    if (dW) {
+        sgemm(1, 0, F, E, N, 1.0f, c->ff_act, F, dy, E, 1.0f, dW + l.w_2, E);
+        column_sums(dW + l.b_2, dy, N, E);
+        sgemm(1, 0, E, F, N, 1.0f, c->x1, E, dff, F, 1.0f, dW + l.w_1, F);
+        column_sums(dW + l.b_1, dff, N, F);
+    }
+
+    // First layer norm, reusing dy for the attention block output gradient
+    layer_norm_backward_rows(dx1, c->xhat1, c->rstd1, W + l.ln1_g, dy,
+                             dW ? dW + l.ln1_g : NULL, dW ? dW + l.ln1_b : NULL, N, E);
+
+    // Output projection, dx1 now holds the context gradient
+    sgemm(0, 1, N, E, E, 1.0f, dy, E, W + l.w_o, E, 0.0f, dx1, E);
+    if (dW) {
+        sgemm(1, 0, E, E, N, 1.0f, c->context, E, dy, E, 1.0f, dW + l.w_o, E);
+        column_sums(dW + l.b_o, dy, N, E);
+    }
+
+    AttentionTask task = { c, dx1, dqkv, scratch, scratch_busy, num_scratch };
+    threadpool_parallel_for(pool, c->num_sequences * c->num_heads, 1, attention_backward_heads, &task);
+
+    if (dW) {
+        sgemm(1, 0, E, 3 * E, N, 1.0f, input->data, E, dqkv, 3 * E, 1.0f, dW + l.w_qkv, 3 * E);
+        column_sums(dW + l.b_qkv, dqkv, N, 3 * E);
+    }
+
+    if (input->requires_grad) {
+        for (size_t i = 0; i < N * E; i++) input->grad[i] += dy[i];
+        sgemm(0, 1, N, E, 3 * E, 1.0f, dqkv, 3 * E, W + l.w_qkv, 3 * E, 1.0f, input->grad, E);
+    }
+
+cleanup:
+    free(dy);
+    free(dx1);
+    free(dff);
+    free(dqkv);
+    free(scratch);
+    free(scratch_busy);
+}
+
+// ====================================================
+// Positional Encoding
+// ====================================================
+
+typedef struct PositionalTable {
+    size_t max_len;
+    size_t embed_dim;
+    float *data;
+    struct PositionalTable *next;
+} PositionalTable;
+
+static PositionalTable *positional_tables = NULL;
+static pthread_mutex_t positional_lock = PTHREAD_MUTEX_INITIALIZER;
+
+const float* positional_encoding_table(size_t max_len, size_t embed_dim) {
+    if (max_len == 0 || embed_dim == 0) return NULL;
+
+    pthread_mutex_lock(&positional_lock);
+
+    // Rows do not depend on max_len, so any longer table of the same width
+    // can be shared. Superseded tables are kept alive for existing users.
+    for (PositionalTable *t = positional_tables; t; t = t->next) {
+        if (t->embed_dim == embed_dim && t->max_len >= max_len) {
+            pthread_mutex_unlock(&positional_lock);
+            return t->data;
+        }
+    }
+
+    PositionalTable *t = (PositionalTable *)malloc(sizeof(PositionalTable));
+    float *data = (float *)malloc(max_len * embed_dim * sizeof(float));
+    if (!t || !data) {
+        free(t);
+        free(data);
+        pthread_mutex_unlock(&positional_lock);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < embed_dim; i += 2) {
+        double freq = exp(-log(10000.0) * (double)i / (double)embed_dim);
+        for (size_t pos = 0; pos < max_len; pos++) {
+            double angle = (double)pos * freq;
+            data[pos * embed_dim + i] = (float)sin(angle);
+            if (i + 1 < embed_dim) data[pos * embed_dim + i + 1] = (float)cos(angle);
+        }
+    }
+
+    t->max_len = max_len;
+    t->embed_dim = embed_dim;
+    t->data = data;
+    t->next = positional_tables;
+    positional_tables = t;
+
+    pthread_mutex_unlock(&positional_lock);
+    return data;
+}
+
+void positional_encoding_cache_clear(void) {
+    pthread_mutex_lock(&positional_lock);
+    PositionalTable *t = positional_tables;
+    while (t) {
+        PositionalTable *next = t->next;
+        free(t->data);
+        free(t);
+        t = next;
+    }
+    positional_tables = NULL;
+    pthread_mutex_unlock(&positional_lock);
+}
+
+static void add_rows(float *restrict out, const float *restrict in, const float *restrict table, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = in[i] + table[i];
+    }
+}
+
+static void attach_positional_graph(Tensor *out, Tensor *input) {
+    if (tensor_grad_enabled() && input->requires_grad) {
+        out->requires_grad = 1;
+        out->op_name = strdup("positional_encoding");
+        out->num_inputs = 1;
+        out->inputs = (Tensor **)malloc(sizeof(Tensor *));
+        out->inputs[0] = input;
+        out->backward_fn = backward_positional_encoding;
+    }
+}
+
+Tensor* tensor_positional_encoding(Tensor *input, const float *table, size_t max_len) {
+    if (!input || !table) return NULL;
+    if (input->ndim != 2 && input->ndim != 3) return NULL;
+
+    size_t S = input->shape[input->ndim - 2];
+    size_t E = input->shape[input->ndim - 1];
+    size_t B = input->ndim == 3 ? input->shape[0] : 1;
+    if (S > max_len) return NULL;
+
+    Tensor *out = tensor_create(input->shape, input->ndim);
+    if (!out) return NULL;
+
+    // The first S table rows are contiguous, so each sequence is one flat add
+    for (size_t b = 0; b < B; b++) {
+        add_rows(out->data + b * S * E, input->data + b * S * E, table, S * E);
+    }
+
+    attach_positional_graph(out, input);
+    return out;
+}
+
+Tensor* tensor_positional_encoding_packed(Tensor *input, const size_t *offsets, size_t num_sequences,
+                                          const float *table, size_t max_len) {
+    if (!input || !table || input->ndim != 2 || !valid_offsets(input, offsets, num_sequences)) return NULL;
+
+    size_t E = input->shape[1];
+    for (size_t b = 0; b < num_sequences; b++) {
+        if (offsets[b + 1] - offsets[b] > max_len) return NULL;
+    }
+
+    Tensor *out = tensor_create(input->shape, input->ndim);
+    if (!out) return NULL;
+
+    // Every sequence restarts at position 0
+    for (size_t b = 0; b < num_sequences; b++) {
+        size_t first = offsets[b] * E;
+        add_rows(out->data + first, input->data + first, table, (offsets[b + 1] - offsets[b]) * E);
+    }
+
+    attach_positional_graph(out, input);
+    return out;
+}
+
+void backward_positional_encoding(Tensor *output) {
+    if (!output || !output->inputs) return;
+    Tensor *input = output->inputs[0];
+
+    if (input->requires_grad) {
+        if (!input->grad) input->grad = (float *)buffer_calloc(input->size, sizeof(float));
+        for (size_t i = 0; i < input->size; i++) {
+            input->grad[i] += output->grad[i];
+        }
+    }
+}
+
+// ====================================================
+// Attention Layers
+// ====================================================
+
+static Tensor* transformer_encoder_forward(Layer *self, Tensor *input) {
+    TransformerEncoderParams *p = (TransformerEncoderParams *)self->config_data;
+    return tensor_transformer_encoder(input, self->weights, p->num_heads, p->ff_hidden_dim);
+}
+
+static void scale_region(float *data, size_t count, float scale) {
+    for (size_t i = 0; i < count; i++) data[i] *= scale;
+}
+
+static Layer* transformer_encoder_create(LayerConfig *config) {
+    TransformerEncoderParams *p = (TransformerEncoderParams *)config->params;
+    size_t E = p->embed_dim, F = p->ff_hidden_dim;
+    EncoderLayout l = encoder_layout(E, F);
+
+    Layer *layer = malloc(sizeof(Layer));
+    layer->name = strdup(config->name);
+
+    // All parameters live in one flat tensor so the block stays a single
+    // optimizer parameter and is saved as one contiguous payload.
+    layer->weights = tensor_randn((size_t[]){l.total}, 1, 42);
+    float *W = layer->weights->data;
+    scale_region(W + l.w_qkv, E * 3 * E, 1.0f / sqrtf((float)E));
+    scale_region(W + l.w_o, E * E, 1.0f / sqrtf((float)E));
+    scale_region(W + l.w_1, E * F, 1.0f / sqrtf((float)E));
+    scale_region(W + l.w_2, F * E, 1.0f / sqrtf((float)F));
+    memset(W + l.b_qkv, 0, 3 * E * sizeof(float));
+    memset(W + l.b_o, 0, E * sizeof(float));
+    memset(W + l.b_1, 0, F * sizeof(float));
+    memset(W + l.b_2, 0, E * sizeof(float));
+    memset(W + l.ln1_b, 0, E * sizeof(float));
+    memset(W + l.ln2_b, 0, E * sizeof(float));
+    for (size_t j = 0; j < E; j++) {
+        W[l.ln1_g + j] = 1.0f;
+        W[l.ln2_g + j] = 1.0f;
+    }
+
+    layer->bias = NULL;
+    layer->output = NULL;
+    layer->parameters = malloc(sizeof(Tensor*));
+    layer->parameters[0] = layer->weights;
+    layer->num_parameters = 1;
+    layer->forward = transformer_encoder_forward;
+
+    layer->config_data_size = sizeof(TransformerEncoderParams);
+    layer->config_data = malloc(layer->config_data_size);
+    memcpy(layer->config_data, p, layer->config_data_size);
+
+    return layer;
+}
+
+static Tensor* positional_encoding_forward(Layer *self, Tensor *input) {
+    return tensor_positional_encoding(input, self->weights->data, self->weights->shape[0]);
+}
+
+static Layer* positional_encoding_create(LayerConfig *config) {
+    PositionalEncodingParams *p = (PositionalEncodingParams *)config->params;
+    const float *table = positional_encoding_table(p->max_len, p->embed_dim);
+    if (!table) return NULL;
+
+    Layer *layer = malloc(sizeof(Layer));
+    layer->name = strdup(config->name);
+
+    // Non-owning view of the shared table; it is not a trainable parameter
+    layer->weights = (Tensor *)malloc(sizeof(Tensor));
+    layer->weights->ndim = 2;
+    layer->weights->shape = (size_t *)malloc(2 * sizeof(size_t));
+    layer->weights->shape[0] = p->max_len;
+    layer->weights->shape[1] = p->embed_dim;
+    layer->weights->size = p->max_len * p->embed_dim;
+    layer->weights->data = (float *)table;
+    layer->weights->grad = NULL;
+    layer->weights->requires_grad = 0;
+    layer->weights->owns_data = 0;
+    layer->weights->op_name = NULL;
+    layer->weights->inputs = NULL;
+    layer->weights->num_inputs = 0;
+    layer->weights->backward_fn = NULL;
+    layer->weights->extra_data = NULL;
+    layer->weights->version = 0;
+
+    layer->bias = NULL;
+    layer->output = NULL;
+    layer->parameters = NULL;
+    layer->num_parameters = 0;
+    layer->forward = positional_encoding_forward;
+
+    layer->config_data_size = sizeof(PositionalEncodingParams);
+    layer->config_data = malloc(layer->config_data_size);
+    memcpy(layer->config_data, p, layer->config_data_size);
+
+    return layer;
+}
+
+// ====================================================
+// Attention Registration
+// ====================================================
+
+void attention_register_builtins(void) {
+    register_layer("transformer_encoder", transformer_encoder_create, transformer_encoder_forward);
+    register_layer("positional_encoding", positional_encoding_create, positional_encoding_forward);
+    register_tensor_op("transformer_encoder", backward_transformer_encoder);
+    register_tensor_op("positional_encoding", backward_positional_encoding);
+}
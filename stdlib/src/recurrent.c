@@ -0,0 +1,463 @@
+#include "../include/recurrent.h"
+#include "../../core/include/registry.h"
+#include "../../core/include/kernels.h"
+#include "../../core/include/alloc.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define LSTM_GATES 4
+#define GRU_GATES 3
+
+// ====================================================
+// Saved Activations
+// ====================================================
+
+// Everything backward needs, kept in one allocation so it can hang off
+// the output tensor's extra_data and be released by tensor_free.
+typedef struct RecurrentCache {
+    size_t batch;
+    size_t seq_len;
+    size_t input_size;
+    size_t hidden_size;
+    int return_sequences;
+    float *gates;       // [batch, seq_len, gates * hidden] post-activation
+    float *state;       // LSTM: cell states, GRU: recurrent candidate term
+    float *hidden;      // [batch, seq_len, hidden]
+} RecurrentCache;
+
+static RecurrentCache* cache_create(size_t B, size_t T, size_t I, size_t H, size_t G, int return_sequences) {
+    size_t header = (sizeof(RecurrentCache) + 63) & ~(size_t)63;
+    size_t floats = B * T * G * H + 2 * B * T * H;
+    RecurrentCache *cache = (RecurrentCache *)malloc(header + floats * sizeof(float));
+    if (!cache) return NULL;
+
+    cache->batch = B;
+    cache->seq_len = T;
+    cache->input_size = I;
+    cache->hidden_size = H;
+    cache->return_sequences = return_sequences;
+    cache->gates = (float *)((char *)cache + header);
+    cache->state = cache->gates + B * T * G * H;
+    cache->hidden = cache->state + B * T * H;
+    return cache;
+}
+
+static Tensor* recurrent_output(RecurrentCache *cache) {
+    size_t B = cache->batch, T = cache->seq_len, H = cache->hidden_size;
+
+    if (cache->return_sequences) {
+        Tensor *out = tensor_create((size_t[]){B, T, H}, 3);
+        if (out) memcpy(out->data, cache->hidden, B * T * H * sizeof(float));
+        return out;
+    }
+
+    Tensor *out = tensor_create((size_t[]){B, H}, 2);
+    if (!out) return NULL;
+    for (size_t b = 0; b < B; b++) {
+        memcpy(out->data + b * H, cache->hidden + (b * T + T - 1) * H, H * sizeof(float));
+    }
+    return out;
+}
+
+static void attach_graph(Tensor *out, Tensor *input, Tensor *weights, Tensor *bias, RecurrentCache *cache, const char *op_name, void (*backward_fn)(Tensor *)) {
+    if (tensor_grad_enabled() && (input->requires_grad || weights->requires_grad || bias->requires_grad)) {
+        out->requires_grad = 1;
+        out->op_name = strdup(op_name);
+        out->num_inputs = 3;
+        out->inputs = (Tensor **)malloc(3 * sizeof(Tensor *));
+        out->inputs[0] = input;
+        out->inputs[1] = weights;
+        out->inputs[2] = bias;
+        out->backward_fn = backward_fn;
+        out->extra_data = cache;
+    } else {
+        free(cache);
+    }
+}
+
+// Gradient of the layer output w.r.t. h at (b, t)
+static float output_grad(Tensor *out, RecurrentCache *cache, size_t b, size_t t, size_t j) {
+    size_t T = cache->seq_len, H = cache->hidden_size;
+    if (cache->return_sequences) return out->grad[(b * T + t) * H + j];
+    return t == T - 1 ? out->grad[b * H + j] : 0.0f;
+}
+
+// Parameter and input gradients shared by both cells. dGx holds the
+// pre-activation gradients of the input projection and dGh those of the
+// recurrent projection, both [batch * seq_len, G].
+static void accumulate_grads(Tensor *input, Tensor *weights, RecurrentCache *cache,
+                             const float *dGx, const float *dGh, size_t G, float *db_x, float *db_h) {
+    size_t B = cache->batch, T = cache->seq_len, I = cache->input_size, H = cache->hidden_size;
+    size_t rows = B * T;
+
+    if (weights->requires_grad) {
+        if (!weights->grad) weights->grad = (float *)buffer_calloc(weights->size, sizeof(float));
+
+        // h_{t-1} for every (b, t), zero at t = 0
+        float *h_prev = (float *)calloc(rows * H, sizeof(float));
+        for (size_t b = 0; b < B; b++) {
+            memcpy(h_prev + (b * T + 1) * H, cache->hidden + b * T * H, (T - 1) * H * sizeof(float));
+        }
+
+        sgemm(1, 0, I, G, rows, 1.0f, input->data, I, dGx, G, 1.0f, weights->grad, G);
+        sgemm(1, 0, H, G, rows, 1.0f, h_prev, H, dGh, G, 1.0f, weights->grad + I * G, G);
+        free(h_prev);
+    }
+
+    if (db_x) {
+        for (size_t r = 0; r < rows; r++) {
+            for (size_t j = 0; j < G; j++) db_x[j] += dGx[r * G + j];
+        }
+    }
+    if (db_h) {
+        for (size_t r = 0; r < rows; r++) {
+            for (size_t j = 0; j < G; j++) db_h[j] += dGh[r * G + j];
+        }
+    }
+
+    if (input->requires_grad) {
+        if (!input->grad) input->grad = (float *)buffer_calloc(input->size, sizeof(float));
+        sgemm(0, 1, rows, I, G, 1.0f, dGx, G, weights->data, G, 1.0f, input->grad, I);
+    }
+}
+
+static inline float sigmoidf(float x) {
+    return 1.0f / (1.0f + expf(-x));
+}
+
+static int check_shapes(Tensor *input, Tensor *weights, Tensor *bias, size_t gates, size_t bias_factor) {
+    if (!input || !weights || !bias) return 0;
+    if (input->ndim != 3 || weights->ndim != 2) return 0;
+    if (weights->shape[1] % gates != 0) return 0;
+
+    size_t H = weights->shape[1] / gates;
+    return weights->shape[0] == input->shape[2] + H && bias->size == bias_factor * gates * H;
+}
+
+// ====================================================
+// LSTM
+// ====================================================
+
+// Gate order is input, forget, cell, output.
+Tensor* tensor_lstm(Tensor *input, Tensor *weights, Tensor *bias, int return_sequences) {
+    if (!check_shapes(input, weights, bias, LSTM_GATES, 1)) return NULL;
+
+    size_t B = input->shape[0], T = input->shape[1], I = input->shape[2];
+    size_t G = weights->shape[1], H = G / LSTM_GATES;
+    if (T == 0) return NULL;
+
+    RecurrentCache *cache = cache_create(B, T, I, H, LSTM_GATES, return_sequences);
+    float *rec = (float *)malloc(B * G * sizeof(float));
+    if (!cache || !rec) {
+        free(cache);
+        free(rec);
+        return NULL;
+    }
+
+    // Input projection of the whole sequence in one GEMM
+    for (size_t r = 0; r < B * T; r++) {
+        memcpy(cache->gates + r * G, bias->data, G * sizeof(float));
+    }
+    sgemm(0, 0, B * T, G, I, 1.0f, input->data, I, weights->data, G, 1.0f, cache->gates, G);
+
+    const float *W_h = weights->data + I * G;
+
+    for (size_t t = 0; t < T; t++) {
+        if (t > 0) {
+            sgemm(0, 0, B, G, H, 1.0f, cache->hidden + (t - 1) * H, T * H, W_h, G, 0.0f, rec, G);
+        } else {
+            memset(rec, 0, B * G * sizeof(float));
+        }
+
+        // Gate nonlinearities and state update in one pass
+        for (size_t b = 0; b < B; b++) {
+            float *g = cache->gates + (b * T + t) * G;
+            const float *r = rec + b * G;
+            const float *c_prev = t > 0 ? cache->state + (b * T + t - 1) * H : NULL;
+            float *c = cache->state + (b * T + t) * H;
+            float *h = cache->hidden + (b * T + t) * H;
+
+            for (size_t j = 0; j < H; j++) {
+                float i_gate = sigmoidf(g[j] + r[j]);
+                float f_gate = sigmoidf(g[H + j] + r[H + j]);
+                float g_gate = tanhf(g[2 * H + j] + r[2 * H + j]);
+                float o_gate = sigmoidf(g[3 * H + j] + r[3 * H + j]);
+                float cell = i_gate * g_gate + (c_prev ? f_gate * c_prev[j] : 0.0f);
+
+                g[j] = i_gate;
+                g[H + j] = f_gate;
+                g[2 * H + j] = g_gate;
+                g[3 * H + j] = o_gate;
+                c[j] = cell;
+                h[j] = o_gate * tanhf(cell);
+            }
+        }
+    }
+    free(rec);
+
+    Tensor *out = recurrent_output(cache);
+    if (!out) {
+        free(cache);
+        return NULL;
+    }
+
+    attach_graph(out, input, weights, bias, cache, "lstm", backward_lstm);
+    return out;
+}
+
+void backward_lstm(Tensor *output) {
+    if (!output || !output->inputs || !output->extra_data) return;
+
+    Tensor *input = output->inputs[0];
+    Tensor *weights = output->inputs[1];
+    Tensor *bias = output->inputs[2];
+    RecurrentCache *cache = (RecurrentCache *)output->extra_data;
+
+    size_t B = cache->batch, T = cache->seq_len, H = cache->hidden_size;
+    size_t G = LSTM_GATES * H;
+    const float *W_h = weights->data + cache->input_size * G;
+
+    float *dA = (float *)malloc(B * T * G * sizeof(float));
+    float *dh_next = (float *)calloc(B * H, sizeof(float));
+    float *dc_next = (float *)calloc(B * H, sizeof(float));
+
+    for (size_t t = T; t-- > 0;) {
+        for (size_t b = 0; b < B; b++) {
+            const float *g = cache->gates + (b * T + t) * G;
+            const float *c = cache->state + (b * T + t) * H;
+            const float *c_prev = t > 0 ? cache->state + (b * T + t - 1) * H : NULL;
+            float *da = dA + (b * T + t) * G;
+
+            for (size_t j = 0; j < H; j++) {
+                float i_gate = g[j], f_gate = g[H + j], g_gate = g[2 * H + j], o_gate = g[3 * H + j];
+                float tc = tanhf(c[j]);
+                float dh = dh_next[b * H + j] + output_grad(output, cache, b, t, j);
+                float dc = dc_next[b * H + j] + dh * o_gate * (1.0f - tc * tc);
+
+                da[j] = dc * g_gate * i_gate * (1.0f - i_gate);
+                da[H + j] = dc * (c_prev ? c_prev[j] : 0.0f) * f_gate * (1.0f - f_gate);
+                da[2 * H + j] = dc * i_gate * (1.0f - g_gate * g_gate);
+                da[3 * H + j] = dh * tc * o_gate * (1.0f - o_gate);
+                dc_next[b * H + j] = dc * f_gate;
+            }
+        }
+
+        if (t > 0) {
+            sgemm(0, 1, B, H, G, 1.0f, dA + t * G, T * G, W_h, G, 0.0f, dh_next, H);
+        }
+    }
+
+    float *db = NULL;
+    if (bias->requires_grad) {
+        if (!bias->grad) bias->grad = (float *)buffer_calloc(bias->size, sizeof(float));
+        db = bias->grad;
+    }
+
+    // The input and recurrent projections share the same pre-activations
+    accumulate_grads(input, weights, cache, dA, dA, G, db, NULL);
+
+    free(dA);
+    free(dh_next);
+    free(dc_next);
+}
+
+// ====================================================
+// GRU
+// ====================================================
+
+// Gate order is reset, update, candidate. bias holds the input biases
+// followed by the recurrent biases, each gates * hidden wide.
+Tensor* tensor_gru(Tensor *input, Tensor *weights, Tensor *bias, int return_sequences) {
+    if (!check_shapes(input, weights, bias, GRU_GATES, 2)) return NULL;
+
+    size_t B = input->shape[0], T = input->shape[1], I = input->shape[2];
+    size_t G = weights->shape[1], H = G / GRU_GATES;
+    if (T == 0) return NULL;
+
+    RecurrentCache *cache = cache_create(B, T, I, H, GRU_GATES, return_sequences);
+    float *rec = (float *)malloc(B * G * sizeof(float));
+    if (!cache || !rec) {
+        free(cache);
+        free(rec);
+        return NULL;
+    }
+
+    for (size_t r = 0; r < B * T; r++) {
+        memcpy(cache->gates + r * G, bias->data, G * sizeof(float));
+    }
+    sgemm(0, 0, B * T, G, I, 1.0f, input->data, I, weights->data, G, 1.0f, cache->gates, G);
+
+    const float *W_h = weights->data + I * G;
+    const float *b_h = bias->data + G;
+
+    for (size_t t = 0; t < T; t++) {
+        for (size_t b = 0; b < B; b++) {
+            memcpy(rec + b * G, b_h, G * sizeof(float));
+        }
+        if (t > 0) {
+            sgemm(0, 0, B, G, H, 1.0f, cache->hidden + (t - 1) * H, T * H, W_h, G, 1.0f, rec, G);
+        }
+
+        for (size_t b = 0; b < B; b++) {
+            float *g = cache->gates + (b * T + t) * G;
+            const float *r = rec + b * G;
+            const float *h_prev = t > 0 ? cache->hidden + (b * T + t - 1) * H : NULL;
+            float *hn = cache->state + (b * T + t) * H;
+            float *h = cache->hidden + (b * T + t) * H;
+
+            for (size_t j = 0; j < H; j++) {
+                float r_gate = sigmoidf(g[j] + r[j]);
+                float z_gate = sigmoidf(g[H + j] + r[H + j]);
+                float n_gate = tanhf(g[2 * H + j] + r_gate * r[2 * H + j]);
+                float prev = h_prev ? h_prev[j] : 0.0f;
+
+                g[j] = r_gate;
+                g[H + j] = z_gate;
+                g[2 * H + j] = n_gate;
+                hn[j] = r[2 * H + j];
+                h[j] = (1.0f - z_gate) * n_gate + z_gate * prev;
+            }
+        }
+    }
+    free(rec);
+
+    Tensor *out = recurrent_output(cache);
+    if (!out) {
+        free(cache);
+        return NULL;
+    }
+
+    attach_graph(out, input, weights, bias, cache, "gru", backward_gru);
+    return out;
+}
+
+void backward_gru(Tensor *output) {
+    if (!output || !output->inputs || !output->extra_data) return;
+
+    Tensor *input = output->inputs[0];
+    Tensor *weights = output->inputs[1];
+    Tensor *bias = output->inputs[2];
+    RecurrentCache *cache = (RecurrentCache *)output->extra_data;
+
+    size_t B = cache->batch, T = cache->seq_len, H = cache->hidden_size;
+    size_t G = GRU_GATES * H;
+    const float *W_h = weights->data + cache->input_size * G;
+
+    float *dGx = (float *)malloc(B * T * G * sizeof(float));
+    float *dGh = (float *)malloc(B * T * G * sizeof(float));
+    float *dh_next = (float *)calloc(B * H, sizeof(float));
+
+    for (size_t t = T; t-- > 0;) {
+        for (size_t b = 0; b < B; b++) {
+            const float *g = cache->gates + (b * T + t) * G;
+            const float *hn = cache->state + (b * T + t) * H;
+            const float *h_prev = t > 0 ? cache->hidden + (b * T + t - 1) * H : NULL;
+            float *dx = dGx + (b * T + t) * G;
+            float *dr = dGh + (b * T + t) * G;
+
+            for (size_t j = 0; j < H; j++) {
+                float r_gate = g[j], z_gate = g[H + j], n_gate = g[2 * H + j];
+                float prev = h_prev ? h_prev[j] : 0.0f;
+                float dh = dh_next[b * H + j] + output_grad(output, cache, b, t, j);
+
+                float dn = dh * (1.0f - z_gate) * (1.0f - n_gate * n_gate);
+                float dz = dh * (prev - n_gate) * z_gate * (1.0f - z_gate);
+                float dreset = dn * hn[j] * r_gate * (1.0f - r_gate);
+
+                dx[j] = dreset;
+                dx[H + j] = dz;
+                dx[2 * H + j] = dn;
+                dr[j] = dreset;
+                dr[H + j] = dz;
+                dr[2 * H + j] = dn * r_gate;
+                dh_next[b * H + j] = dh * z_gate;
+            }
+        }
+
+        if (t > 0) {
+            sgemm(0, 1, B, H, G, 1.0f, dGh + t * G, T * G, W_h, G, 1.0f, dh_next, H);
+        }
+    }
+
+    float *db_x = NULL, *db_h = NULL;
+    if (bias->requires_grad) {
+        if (!bias->grad) bias->grad = (float *)buffer_calloc(bias->size, sizeof(float));
+        db_x = bias->grad;
+        db_h = bias->grad + G;
+    }
+
+    accumulate_grads(input, weights, cache, dGx, dGh, G, db_x, db_h);
+
+    free(dGx);
+    free(dGh);
+    free(dh_next);
+}
+
+// ====================================================
+// Recurrent Layers
+// ====================================================
+
+static Tensor* lstm_forward(Layer *self, Tensor *input) {
+    RecurrentParams *params = (RecurrentParams *)self->config_data;
+    return tensor_lstm(input, self->weights, self->bias, params->return_sequences);
+}
+
+static Tensor* gru_forward(Layer *self, Tensor *input) {
+    RecurrentParams *params = (RecurrentParams *)self->config_data;
+    return tensor_gru(input, self->weights, self->bias, params->return_sequences);
+}
+
+static Layer* recurrent_create(LayerConfig *config, size_t gates, size_t bias_factor, LayerForwardFn forward) {
+    RecurrentParams *params = (RecurrentParams *)config->params;
+    size_t H = params->hidden_size;
+
+    Layer *layer = malloc(sizeof(Layer));
+    layer->name = strdup(config->name);
+    layer->weights = tensor_randn((size_t[]){params->input_size + H, gates * H}, 2, 42);
+
+    float scale = 1.0f / sqrtf((float)H);
+    for (size_t i = 0; i < layer->weights->size; i++) {
+        layer->weights->data[i] *= scale;
+    }
+
+    layer->bias = tensor_zeroes((size_t[]){bias_factor * gates * H}, 1);
+    layer->output = NULL;
+    layer->parameters = malloc(2 * sizeof(Tensor*));
+    layer->parameters[0] = layer->weights;
+    layer->parameters[1] = layer->bias;
+    layer->num_parameters = 2;
+    layer->forward = forward;
+
+    layer->config_data_size = sizeof(RecurrentParams);
+    layer->config_data = malloc(layer->config_data_size);
+    memcpy(layer->config_data, params, layer->config_data_size);
+
+    return layer;
+}
+
+static Layer* lstm_create(LayerConfig *config) {
+    Layer *layer = recurrent_create(config, LSTM_GATES, 1, lstm_forward);
+
+    // Start with the forget gate open
+    size_t H = ((RecurrentParams *)config->params)->hidden_size;
+    for (size_t j = 0; j < H; j++) {
+        layer->bias->data[H + j] = 1.0f;
+    }
+    return layer;
+}
+
+static Layer* gru_create(LayerConfig *config) {
+    return recurrent_create(config, GRU_GATES, 2, gru_forward);
+}
+
+// ====================================================
+// Recurrent Registration
+// ====================================================
+
+void recurrent_register_builtins(void) {
+    register_layer("lstm", lstm_create, lstm_forward);
+    register_layer("gru", gru_create, gru_forward);
+    register_tensor_op("lstm", backward_lstm);
+    register_tensor_op("gru", backward_gru);
+}
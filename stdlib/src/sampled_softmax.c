@@ -0,0 +1,374 @@
+#include "../include/sampled_softmax.h"
+#include "../../core/include/layer.h"
+#include "../../core/include/registry.h"
+#include "../../core/include/kernels.h"
+#include "../../core/include/alloc.h"
+#include "../../core/include/threadpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define SOFTMAX_ROW_GRAIN 1
+
+// ====================================================
+// Candidate Samplers
+// ====================================================
+
+static inline uint64_t splitmix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+size_t log_uniform_sample(const CandidateSampler *self, uint64_t *state) {
+    double u = (double)(splitmix64(state) >> 11) * (1.0 / 9007199254740992.0);
+    size_t k = (size_t)exp(u * log((double)self->num_classes + 1.0)) - 1;
+    return k < self->num_classes ? k : self->num_classes - 1;
+}
+
+float log_uniform_log_prob(const CandidateSampler *self, size_t label) {
+    double p = log1p(1.0 / ((double)label + 1.0)) / log((double)self->num_classes + 1.0);
+    return (float)log(p);
+}
+
+// ====================================================
+// Shared Helpers
+// ====================================================
+
+typedef struct SoftmaxRowsTask {
+    float *data;
+    size_t cols;
+    float *row_loss;    // optional -log p[0] per row
+} SoftmaxRowsTask;
+
+static void softmax_rows(void *ctx, size_t start, size_t end) {
+    SoftmaxRowsTask *task = (SoftmaxRowsTask *)ctx;
+    size_t n = task->cols;
+
+    for (size_t r = start; r < end; r++) {
+        float *row = task->data + r * n;
+        float max_val = row[0];
+        for (size_t j = 1; j < n; j++) if (row[j] > max_val) max_val = row[j];
+
+        float first = row[0];
+        float sum = 0.0f;
+        for (size_t j = 0; j < n; j++) {
+            row[j] = expf(row[j] - max_val);
+            sum += row[j];
+        }
+        float inv = 1.0f / sum;
+        for (size_t j = 0; j < n; j++) row[j] *= inv;
+
+        if (task->row_loss) task->row_loss[r] = logf(sum) + max_val - first;
+    }
+}
+
+static void add_column_sums(float *dst, const float *src, size_t rows, size_t cols, size_t ld) {
+    for (size_t r = 0; r < rows; r++) {
+        for (size_t j = 0; j < cols; j++) dst[j] += src[r * ld + j];
+    }
+}
+
+static inline float dot(const float *a, const float *b, size_t n) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; i++) sum += a[i] * b[i];
+    return sum;
+}
+
+static inline void axpy(float *y, float alpha, const float *x, size_t n) {
+    for (size_t i = 0; i < n; i++) y[i] += alpha * x[i];
+}
+
+static int check_projection(Tensor *hidden, Tensor *weights, Tensor *bias) {
+    if (!hidden || !weights) return 0;
+    if (hidden->ndim != 2 || weights->ndim != 2) return 0;
+    if (hidden->shape[1] != weights->shape[1]) return 0;
+    if (bias && bias->size != weights->shape[0]) return 0;
+    return 1;
+}
+
+static void attach_graph(Tensor *out, Tensor *hidden, Tensor *weights, Tensor *bias, void *cache,
+                         const char *op_name, void (*backward_fn)(Tensor *)) {
+    if (tensor_grad_enabled() && (hidden->requires_grad || weights->requires_grad || (bias && bias->requires_grad))) {
+        out->requires_grad = 1;
+        out->op_name = strdup(op_name);
+        out->num_inputs = bias ? 3 : 2;
+        out->inputs = (Tensor **)malloc(out->num_inputs * sizeof(Tensor *));
+        out->inputs[0] = hidden;
+        out->inputs[1] = weights;
+        if (bias) out->inputs[2] = bias;
+        out->backward_fn = backward_fn;
+        out->extra_data = cache;
+    } else {
+        free(cache);
+    }
+}
+
+static float* ensure_grad(Tensor *T) {
+    if (!T->grad) T->grad = (float *)buffer_calloc(T->size, sizeof(float));
+    return T->grad;
+}
+
+// ====================================================
+// Full Softmax
+// ====================================================
+
+Tensor* tensor_full_softmax(Tensor *hidden, Tensor *weights, Tensor *bias) {
+    if (!check_projection(hidden, weights, bias)) return NULL;
+
+    size_t B = hidden->shape[0], D = hidden->shape[1], V = weights->shape[0];
+    Tensor *out = tensor_create((size_t[]){B, V}, 2);
+    if (!out) return NULL;
+
+    if (bias) {
+        for (size_t b = 0; b < B; b++) memcpy(out->data + b * V, bias->data, V * sizeof(float));
+    }
+    sgemm(0, 1, B, V, D, 1.0f, hidden->data, D, weights->data, D, bias ? 1.0f : 0.0f, out->data, V);
+
+    SoftmaxRowsTask task = { out->data, V, NULL };
+    threadpool_parallel_for(threadpool_default(), B, SOFTMAX_ROW_GRAIN, softmax_rows, &task);
+
+    attach_graph(out, hidden, weights, bias, NULL, "full_softmax", backward_full_softmax);
+    return out;
+}
+
+void backward_full_softmax(Tensor *output) {
+    if (!output || !output->inputs) return;
+    Tensor *hidden = output->inputs[0];
+    Tensor *weights = output->inputs[1];
+    Tensor *bias = output->num_inputs > 2 ? output->inputs[2] : NULL;
+    size_t B = hidden->shape[0], D = hidden->shape[1], V = weights->shape[0];
+
+    // dz = p * (g - sum(g * p)) per row
+    float *dz = (float *)malloc(B * V * sizeof(float));
+    if (!dz) return;
+    for (size_t b = 0; b < B; b++) {
+        const float *p = output->data + b * V;
+        const float *g = output->grad + b * V;
+        float s = dot(g, p, V);
+        for (size_t j = 0; j < V; j++) dz[b * V + j] = p[j] * (g[j] - s);
+    }
+
+    if (hidden->requires_grad) {
+        sgemm(0, 0, B, D, V, 1.0f, dz, V, weights->data, D, 1.0f, ensure_grad(hidden), D);
+    }
+    if (weights->requires_grad) {
+        sgemm(1, 0, V, D, B, 1.0f, dz, V, hidden->data, D, 1.0f, ensure_grad(weights), D);
+    }
+    if (bias && bias->requires_grad) {
+        add_column_sums(ensure_grad(bias), dz, B, V, V);
+    }
+
+    free(dz);
+}
+
+// ====================================================
+// Sampled Softmax Loss
+// ====================================================
+
+typedef struct SampledCache {
+    size_t batch, dim, num_sampled;
+    size_t *labels;     // [B]
+    size_t *samples;    // [S]
+    float *probs;       // [B, 1 + S], column 0 is the true class
+    float *gathered;    // [S, D] weight rows of the sampled classes
+} SampledCache;
+
+static SampledCache* sampled_cache_create(size_t B, size_t D, size_t S) {
+    size_t header = (sizeof(SampledCache) + 63) & ~(size_t)63;
+    size_t indices = ((B + S) * sizeof(size_t) + 63) & ~(size_t)63;
+    size_t floats = B * (1 + S) + S * D;
+    SampledCache *c = (SampledCache *)malloc(header + indices + floats * sizeof(float));
+    if (!c) return NULL;
+
+    c->batch = B;
+    c->dim = D;
+    c->num_sampled = S;
+    c->labels = (size_t *)((char *)c + header);
+    c->samples = c->labels + B;
+    c->probs = (float *)((char *)c + header + indices);
+    c->gathered = c->probs + B * (1 + S);
+    return c;
+}
+
+Tensor* tensor_sampled_softmax_loss(Tensor *hidden, Tensor *weights, Tensor *bias, Tensor *labels,
+                                    size_t num_sampled, const CandidateSampler *sampler, uint64_t *rng_state) {
+    if (!check_projection(hidden, weights, bias) || !labels || !sampler || !rng_state) return NULL;
+
+    size_t B = hidden->shape[0], D = hidden->shape[1], V = weights->shape[0], S = num_sampled;
+    if (S == 0 || labels->size != B || sampler->num_classes == 0 || sampler->num_classes > V) {
+        fprintf(stderr, "Error: Invalid sampled softmax configuration\n");
+        return NULL;
+    }
+
+    SampledCache *c = sampled_cache_create(B, D, S);
+    if (!c) return NULL;
+
+    for (size_t b = 0; b < B; b++) {
+        float label = labels->data[b];
+        if (label < 0.0f || (size_t)label >= V) {
+            fprintf(stderr, "Error: Label %g out of range for %zu classes\n", label, V);
+            free(c);
+            return NULL;
+        }
+        c->labels[b] = (size_t)label;
+    }
+
+    float *correction = (float *)malloc(S * sizeof(float));
+    float *row_loss = (float *)malloc(B * sizeof(float));
+    Tensor *loss = tensor_create((size_t[]){1}, 1);
+    if (!correction || !row_loss || !loss) {
+        free(correction);
+        free(row_loss);
+        tensor_free(loss);
+        free(c);
+        return NULL;
+    }
+
+    // Negatives are shared by the batch, so their logits are one gather + GEMM
+    float log_s = logf((float)S);
+    for (size_t s = 0; s < S; s++) {
+        size_t k = sampler->sample(sampler, rng_state);
+        c->samples[s] = k;
+        memcpy(c->gathered + s * D, weights->data + k * D, D * sizeof(float));
+        correction[s] = (bias ? bias->data[k] : 0.0f) - log_s - sampler->log_prob(sampler, k);
+    }
+
+    size_t ld = 1 + S;
+    sgemm(0, 1, B, S, D, 1.0f, hidden->data, D, c->gathered, D, 0.0f, c->probs + 1, ld);
+
+    for (size_t b = 0; b < B; b++) {
+        size_t label = c->labels[b];
+        float *row = c->probs + b * ld;
+        row[0] = dot(hidden->data + b * D, weights->data + label * D, D)
+               + (bias ? bias->data[label] : 0.0f) - log_s - sampler->log_prob(sampler, label);
+
+        for (size_t s = 0; s < S; s++) {
+            row[1 + s] = c->samples[s] == label ? -INFINITY : row[1 + s] + correction[s];
+        }
+    }
+    free(correction);
+
+    SoftmaxRowsTask task = { c->probs, ld, row_loss };
+    threadpool_parallel_for(threadpool_default(), B, SOFTMAX_ROW_GRAIN, softmax_rows, &task);
+
+    float total = 0.0f;
+    for (size_t b = 0; b < B; b++) total += row_loss[b];
+    loss->data[0] = total / (float)B;
+    free(row_loss);
+
+    attach_graph(loss, hidden, weights, bias, c, "sampled_softmax_loss", backward_sampled_softmax_loss);
+    return loss;
+}
+
+void backward_sampled_softmax_loss(Tensor *loss) {
+    if (!loss || !loss->inputs || !loss->extra_data) return;
+    Tensor *hidden = loss->inputs[0];
+    Tensor *weights = loss->inputs[1];
+    Tensor *bias = loss->num_inputs > 2 ? loss->inputs[2] : NULL;
+    SampledCache *c = (SampledCache *)loss->extra_data;
+    size_t B = c->batch, D = c->dim, S = c->num_sampled, ld = 1 + S;
+
+    // d(logits) = (p - onehot(0)) / B, scaled by the incoming gradient
+    float scale = loss->grad[0] / (float)B;
+    float *g = (float *)malloc(B * ld * sizeof(float));
+    float *d_gathered = weights->requires_grad ? (float *)malloc(S * D * sizeof(float)) : NULL;
+    if (!g || (weights->requires_grad && !d_gathered)) {
+        free(g);
+        free(d_gathered);
+        return;
+    }
+    for (size_t i = 0; i < B * ld; i++) g[i] = c->probs[i] * scale;
+    for (size_t b = 0; b < B; b++) g[b * ld] -= scale;
+
+    if (hidden->requires_grad) {
+        float *dh = ensure_grad(hidden);
+        sgemm(0, 0, B, D, S, 1.0f, g + 1, ld, c->gathered, D, 1.0f, dh, D);
+        for (size_t b = 0; b < B; b++) {
+            axpy(dh + b * D, g[b * ld], weights->data + c->labels[b] * D, D);
+        }
+    }
+
+    if (weights->requires_grad) {
+        float *dw = ensure_grad(weights);
+        sgemm(1, 0, S, D, B, 1.0f, g + 1, ld, hidden->data, D, 0.0f, d_gathered, D);
+
+        // Scatter back; repeated samples accumulate into the same row
+        for (size_t s = 0; s < S; s++) {
+            axpy(dw + c->samples[s] * D, 1.0f, d_gathered + s * D, D);
+        }
+        for (size_t b = 0; b < B; b++) {
+            axpy(dw + c->labels[b] * D, g[b * ld], hidden->data + b * D, D);
+        }
+    }
+
+    if (bias && bias->requires_grad) {
+        float *db = ensure_grad(bias);
+        for (size_t b = 0; b < B; b++) {
+            db[c->labels[b]] += g[b * ld];
+            for (size_t s = 0; s < S; s++) db[c->samples[s]] += g[b * ld + 1 + s];
+        }
+    }
+
+    free(g);
+    free(d_gathered);
+}
+
+// ====================================================
+// Sampled Softmax Layer
+// ====================================================
+
+static Tensor* sampled_softmax_forward(Layer *self, Tensor *input) {
+    return tensor_full_softmax(input, self->weights, self->bias);
+}
+
+static Layer* sampled_softmax_create(LayerConfig *config) {
+    SampledSoftmaxParams *params = (SampledSoftmaxParams *)config->params;
+
+    Layer *layer = malloc(sizeof(Layer));
+    layer->name = strdup(config->name);
+    layer->weights = tensor_randn((size_t[]){params->num_classes, params->in_features}, 2, 42);
+
+    float scale = 1.0f / sqrtf((float)params->in_features);
+    for (size_t i = 0; i < layer->weights->size; i++) {
+        layer->weights->data[i] *= scale;
+    }
+
+    layer->bias = tensor_zeroes((size_t[]){params->num_classes}, 1);
+    layer->output = NULL;
+    layer->parameters = malloc(2 * sizeof(Tensor*));
+    layer->parameters[0] = layer->weights;
+    layer->parameters[1] = layer->bias;
+    layer->num_parameters = 2;
+    layer->forward = sampled_softmax_forward;
+
+    layer->config_data_size = sizeof(SampledSoftmaxParams);
+    layer->config_data = malloc(layer->config_data_size);
+    memcpy(layer->config_data, params, layer->config_data_size);
+
+    return layer;
+}
+
+Tensor* layer_sampled_softmax_loss(Layer *layer, Tensor *hidden, Tensor *labels,
+                                   const CandidateSampler *sampler, uint64_t *rng_state) {
+    if (!layer || !layer->config_data || strcmp(layer->name, "sampled_softmax") != 0) return NULL;
+    SampledSoftmaxParams *params = (SampledSoftmaxParams *)layer->config_data;
+
+    CandidateSampler log_uniform = LOG_UNIFORM_SAMPLER(params->num_classes);
+    if (!sampler) sampler = &log_uniform;
+
+    return tensor_sampled_softmax_loss(hidden, layer->weights, layer->bias, labels,
+                                       params->num_sampled, sampler, rng_state);
+}
+
+// ====================================================
+// Sampled Softmax Registration
+// ====================================================
+
+void sampled_softmax_register_builtins(void) {
+    register_layer("sampled_softmax", sampled_softmax_create, sampled_softmax_forward);
+    register_tensor_op("full_softmax", backward_full_softmax);
+    register_tensor_op("sampled_softmax_loss", backward_sampled_softmax_loss);
+}
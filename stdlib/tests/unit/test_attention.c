@@ -0,0 +1,344 @@
+#include "../../include/basednn_stdlib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define EPSILON 1e-4f
+#define ASSERT_FLOAT_EQ(a, b) assert(fabsf((a) - (b)) < EPSILON)
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { printf("Running %s...\n", #name); test_##name(); printf("  PASSED\n"); } while(0)
+
+// ====================================================
+// Helpers
+// ====================================================
+
+static void fill_random(Tensor *T, unsigned int seed, float scale) {
+    srand(seed);
+    for (size_t i = 0; i < T->size; i++) {
+        T->data[i] = scale * ((float)rand() / RAND_MAX - 0.5f);
+    }
+}
+
+static double encoder_probe(Tensor *x, Tensor *params, size_t heads, size_t ff, const float *probe) {
+    Tensor *out = tensor_transformer_encoder(x, params, heads, ff);
+    double loss = 0.0;
+    for (size_t i = 0; i < out->size; i++) loss += (double)out->data[i] * probe[i];
+    tensor_free(out);
+    return loss;
+}
+
+// ====================================================
+// Transformer Encoder Tests
+// ====================================================
+
+TEST(transformer_encoder_gradients) {
+    size_t B = 2, S = 3, E = 4, heads = 2, F = 6;
+    Layer *layer = layer_create(TRANSFORMERENCODER(E, heads, F, 0.0f, 0.0f));
+    assert(layer != NULL);
+    Tensor *params = layer->weights;
+    fill_random(params, 11, 1.0f);
+
+    Tensor *x = tensor_create((size_t[]){B, S, E}, 3);
+    fill_random(x, 12, 2.0f);
+    tensor_set_requires_grad(x, 1);
+    tensor_set_requires_grad(params, 1);
+
+    Tensor *out = tensor_transformer_encoder(x, params, heads, F);
+    assert(out != NULL && out->ndim == 3 && out->shape[2] == E);
+
+    float *probe = malloc(out->size * sizeof(float));
+    srand(13);
+    for (size_t i = 0; i < out->size; i++) probe[i] = (float)rand() / RAND_MAX - 0.5f;
+    out->grad = malloc(out->size * sizeof(float));
+    for (size_t i = 0; i < out->size; i++) out->grad[i] = probe[i];
+    out->backward_fn(out);
+
+    Tensor *checked[2] = {x, params};
+    float h = 1e-2f;
+    for (size_t p = 0; p < 2; p++) {
+        for (size_t i = 0; i < checked[p]->size; i++) {
+            float saved = checked[p]->data[i];
+            checked[p]->data[i] = saved + h;
+            double up = encoder_probe(x, params, heads, F, probe);
+            checked[p]->data[i] = saved - h;
+            double down = encoder_probe(x, params, heads, F, probe);
+            checked[p]->data[i] = saved;
+
+            float numeric = (float)((up - down) / (2.0 * h));
+            assert(fabsf(numeric - checked[p]->grad[i]) < 5e-3f);
+        }
+    }
+
+    free(probe);
+    tensor_free(out);
+    tensor_free(x);
+    layer_free(layer);
+}
+
+TEST(transformer_encoder_output_normalized) {
+    Layer *layer = layer_create(TRANSFORMERENCODER(8, 4, 16, 0.0f, 0.0f));
+    Tensor *x = tensor_create((size_t[]){5, 8}, 2);
+    fill_random(x, 3, 4.0f);
+
+    Tensor *out = layer_forward(layer, x);
+    assert(out != NULL && out->ndim == 2);
+
+    // Fresh layer norm has unit gamma and zero beta
+    for (size_t r = 0; r < 5; r++) {
+        float mean = 0.0f, var = 0.0f;
+        for (size_t j = 0; j < 8; j++) mean += out->data[r * 8 + j];
+        mean /= 8.0f;
+        for (size_t j = 0; j < 8; j++) var += (out->data[r * 8 + j] - mean) * (out->data[r * 8 + j] - mean);
+        ASSERT_FLOAT_EQ(mean, 0.0f);
+        assert(fabsf(var / 8.0f - 1.0f) < 1e-3f);
+    }
+
+    tensor_free(out);
+    tensor_free(x);
+    layer_free(layer);
+}
+
+TEST(transformer_encoder_invalid_heads) {
+    Layer *layer = layer_create(TRANSFORMERENCODER(6, 4, 8, 0.0f, 0.0f));
+    Tensor *x = tensor_ones((size_t[]){2, 6}, 2);
+    assert(layer_forward(layer, x) == NULL);
+    tensor_free(x);
+    layer_free(layer);
+}
+
+TEST(transformer_encoder_stack_training) {
+    size_t B = 4, S = 6, E = 8;
+    Network *net = network_create();
+    for (int i = 0; i < 2; i++) {
+        network_add_layer(net, layer_create(TRANSFORMERENCODER(E, 2, 16, 0.0f, 0.0f)));
+    }
+    assert(net->num_parameters == 2);
+
+    Tensor *x = tensor_create((size_t[]){B, S, E}, 3);
+    Tensor *y = tensor_create((size_t[]){B, S, E}, 3);
+    fill_random(x, 5, 2.0f);
+    fill_random(y, 6, 2.0f);
+
+    Optimizer *opt = optimizer_create(net->parameters, net->num_parameters, ADAM(0.01f, 0.9f, 0.999f, 1e-8f));
+    float first = network_train_step(net, x, y, opt, "mse");
+    float last = first;
+    for (int i = 0; i < 100; i++) {
+        last = network_train_step(net, x, y, opt, "mse");
+    }
+    assert(last < first * 0.5f);
+
+    optimizer_free(opt);
+    tensor_free(x);
+    tensor_free(y);
+    network_free(net);
+}
+
+// A 2D batch is one sequence to the encoder, so bucketed inference has to
+// run it at its own length rather than padded to the bucket
+TEST(encoder_bucketed_forward_matches) {
+    const char *dir = "/tmp/basednn_attention_plans";
+    Network *net = network_create();
+    network_add_layer(net, layer_create(TRANSFORMERENCODER(8, 2, 16, 0.0f, 0.0f)));
+    network_add_layer(net, layer_create(LINEAR(8, 4)));
+    fill_random(net->layers[0]->weights, 31, 1.0f);
+
+    Tensor *x = tensor_create((size_t[]){5, 8}, 2);
+    fill_random(x, 32, 2.0f);
+    Tensor *expected = network_forward(net, x);
+
+    mkdir(dir, 0755);
+    assert(network_plan_cached_buckets(net, dir, 8));
+    Tensor *out = network_forward_bucketed(net, x);
+    assert(out != NULL && out->shape[0] == 5 && out->shape[1] == 4);
+    for (size_t i = 0; i < out->size; i++) ASSERT_FLOAT_EQ(out->data[i], expected->data[i]);
+
+    char path[256];
+    for (size_t bucket = 1; bucket <= 8; bucket <<= 1) {
+        snprintf(path, sizeof(path), "%s/%016llx-%zu.plan", dir, (unsigned long long)network_fingerprint(net), bucket);
+        remove(path);
+    }
+    tensor_free(out);
+    tensor_free(expected);
+    tensor_free(x);
+    network_free(net);
+}
+
+TEST(packed_encoder_matches_per_sequence) {
+    size_t E = 8, heads = 2, F = 12;
+    size_t offsets[] = { 0, 3, 3, 4, 9 };
+    size_t num_sequences = 4, N = 9;
+
+    Layer *layer = layer_create(TRANSFORMERENCODER(E, heads, F, 0.0f, 0.0f));
+    Tensor *params = layer->weights;
+    fill_random(params, 21, 1.0f);
+    tensor_set_requires_grad(params, 1);
+
+    Tensor *x = tensor_create((size_t[]){N, E}, 2);
+    fill_random(x, 22, 2.0f);
+    tensor_set_requires_grad(x, 1);
+
+    Tensor *out = tensor_transformer_encoder_packed(x, offsets, num_sequences, params, heads, F);
+    assert(out != NULL && out->shape[0] == N && out->shape[1] == E);
+
+    out->grad = malloc(out->size * sizeof(float));
+    srand(23);
+    for (size_t i = 0; i < out->size; i++) out->grad[i] = (float)rand() / RAND_MAX - 0.5f;
+    out->backward_fn(out);
+
+    // Each sequence run alone gives the same rows and gradients; parameter
+    // gradients add up across sequences
+    Tensor *ref_params = tensor_create(params->shape, 1);
+    memcpy(ref_params->data, params->data, params->size * sizeof(float));
+    tensor_set_requires_grad(ref_params, 1);
+
+    for (size_t b = 0; b < num_sequences; b++) {
+        size_t first = offsets[b], len = offsets[b + 1] - first;
+        if (len == 0) continue;
+
+        Tensor *xs = tensor_create((size_t[]){len, E}, 2);
+        memcpy(xs->data, x->data + first * E, len * E * sizeof(float));
+        tensor_set_requires_grad(xs, 1);
+
+        Tensor *ys = tensor_transformer_encoder(xs, ref_params, heads, F);
+        for (size_t i = 0; i < len * E; i++) ASSERT_FLOAT_EQ(ys->data[i], out->data[first * E + i]);
+
+        ys->grad = malloc(ys->size * sizeof(float));
+        memcpy(ys->grad, out->grad + first * E, len * E * sizeof(float));
+        ys->backward_fn(ys);
+        for (size_t i = 0; i < len * E; i++) ASSERT_FLOAT_EQ(xs->grad[i], x->grad[first * E + i]);
+
+        tensor_free(ys);
+        tensor_free(xs);
+    }
+    for (size_t i = 0; i < params->size; i++) ASSERT_FLOAT_EQ(ref_params->grad[i], params->grad[i]);
+
+    // Offsets have to cover the rows exactly
+    size_t short_offsets[] = { 0, 3, 8 };
+    assert(tensor_transformer_encoder_packed(x, short_offsets, 2, params, heads, F) == NULL);
+
+    tensor_free(ref_params);
+    tensor_free(out);
+    tensor_free(x);
+    layer_free(layer);
+}
+
+// ====================================================
+// Positional Encoding Tests
+// ====================================================
+
+TEST(positional_table_values) {
+    const float *table = positional_encoding_table(10, 6);
+    assert(table != NULL);
+
+    ASSERT_FLOAT_EQ(table[0], 0.0f);
+    ASSERT_FLOAT_EQ(table[1], 1.0f);
+    ASSERT_FLOAT_EQ(table[3 * 6 + 0], sinf(3.0f));
+    ASSERT_FLOAT_EQ(table[3 * 6 + 1], cosf(3.0f));
+    ASSERT_FLOAT_EQ(table[3 * 6 + 2], sinf(3.0f / powf(10000.0f, 2.0f / 6.0f)));
+}
+
+TEST(positional_table_shared) {
+    const float *a = positional_encoding_table(32, 8);
+    const float *b = positional_encoding_table(16, 8);
+    const float *c = positional_encoding_table(32, 8);
+    assert(a == b && a == c);
+
+    Layer *l1 = layer_create(POSITIONALENCODING(20, 8, 0.0f));
+    Layer *l2 = layer_create(POSITIONALENCODING(32, 8, 0.0f));
+    assert(l1->weights->data == a && l2->weights->data == a);
+    assert(l1->num_parameters == 0);
+
+    layer_free(l1);
+    layer_free(l2);
+}
+
+TEST(positional_encoding_forward_on_view) {
+    size_t B = 3, S = 4, E = 6;
+    Layer *layer = layer_create(POSITIONALENCODING(8, E, 0.0f));
+    Tensor *x = tensor_create((size_t[]){B, S, E}, 3);
+    fill_random(x, 9, 1.0f);
+    tensor_set_requires_grad(x, 1);
+
+    Tensor *view = tensor_slice(x, 1, 3);
+    Tensor *out = layer_forward(layer, view);
+    assert(out != NULL && out->shape[0] == 2);
+
+    const float *table = layer->weights->data;
+    for (size_t b = 0; b < 2; b++) {
+        for (size_t i = 0; i < S * E; i++) {
+            ASSERT_FLOAT_EQ(out->data[b * S * E + i], x->data[(b + 1) * S * E + i] + table[i]);
+        }
+    }
+
+    Tensor *too_long = tensor_create((size_t[]){9, E}, 2);
+    assert(layer_forward(layer, too_long) == NULL);
+
+    tensor_free(too_long);
+    tensor_free(out);
+    tensor_free(view);
+    tensor_free(x);
+    layer_free(layer);
+}
+
+TEST(positional_encoding_backward) {
+    Tensor *x = tensor_zeroes((size_t[]){2, 4}, 2);
+    tensor_set_requires_grad(x, 1);
+    Tensor *out = tensor_positional_encoding(x, positional_encoding_table(4, 4), 4);
+    tensor_backward(out);
+
+    for (size_t i = 0; i < x->size; i++) {
+        ASSERT_FLOAT_EQ(x->grad[i], 1.0f);
+    }
+
+    tensor_free(out);
+    tensor_free(x);
+}
+
+TEST(positional_encoding_packed) {
+    size_t E = 4, offsets[] = { 0, 2, 5 };
+    const float *table = positional_encoding_table(4, E);
+    Tensor *x = tensor_create((size_t[]){5, E}, 2);
+    fill_random(x, 24, 1.0f);
+
+    Tensor *out = tensor_positional_encoding_packed(x, offsets, 2, table, 4);
+    assert(out != NULL);
+    for (size_t i = 0; i < 2 * E; i++) ASSERT_FLOAT_EQ(out->data[i], x->data[i] + table[i]);
+    for (size_t i = 0; i < 3 * E; i++) ASSERT_FLOAT_EQ(out->data[2 * E + i], x->data[2 * E + i] + table[i]);
+
+    assert(tensor_positional_encoding_packed(x, offsets, 2, table, 2) == NULL);
+
+    tensor_free(out);
+    tensor_free(x);
+}
+
+// ====================================================
+// ====================================================
+
+int main() {
+    printf("=== Running Attention Tests ===\n\n");
+
+    basednn_init();
+    basednn_stdlib_init();
+
+    RUN_TEST(transformer_encoder_gradients);
+    RUN_TEST(transformer_encoder_output_normalized);
+    RUN_TEST(transformer_encoder_invalid_heads);
+    RUN_TEST(transformer_encoder_stack_training);
+    RUN_TEST(encoder_bucketed_forward_matches);
+    RUN_TEST(packed_encoder_matches_per_sequence);
+
+    RUN_TEST(positional_table_values);
+    RUN_TEST(positional_table_shared);
+    RUN_TEST(positional_encoding_forward_on_view);
+    RUN_TEST(positional_encoding_backward);
+    RUN_TEST(positional_encoding_packed);
+
+    basednn_stdlib_cleanup();
+    basednn_cleanup();
+
+    printf("\n=== All Attention Tests Passed! ===\n");
+    return 0;
+}
@@ -0,0 +1,200 @@
+#include "../../include/basednn_stdlib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+
+#define EPSILON 1e-4f
+#define ASSERT_FLOAT_EQ(a, b) assert(fabsf((a) - (b)) < EPSILON)
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { printf("Running %s...\n", #name); test_##name(); printf("  PASSED\n"); } while(0)
+
+typedef Tensor* (*RecurrentFn)(Tensor *input, Tensor *weights, Tensor *bias, int return_sequences);
+
+// ====================================================
+// Helpers
+// ====================================================
+
+static void fill_random(Tensor *T, unsigned int seed, float scale) {
+    srand(seed);
+    for (size_t i = 0; i < T->size; i++) {
+        T->data[i] = scale * ((float)rand() / RAND_MAX - 0.5f);
+    }
+}
+
+// Loss = sum(output * probe) so d(loss)/d(output) = probe
+static float probe_loss(RecurrentFn fn, Tensor *x, Tensor *w, Tensor *b, int ret_seq, const float *probe) {
+    Tensor *out = fn(x, w, b, ret_seq);
+    float loss = 0.0f;
+    for (size_t i = 0; i < out->size; i++) loss += out->data[i] * probe[i];
+    tensor_free(out);
+    return loss;
+}
+
+static void check_gradients(RecurrentFn fn, size_t gates, size_t bias_factor, int ret_seq) {
+    size_t B = 2, T = 3, I = 4, H = 3;
+    Tensor *x = tensor_create((size_t[]){B, T, I}, 3);
+    Tensor *w = tensor_create((size_t[]){I + H, gates * H}, 2);
+    Tensor *b = tensor_create((size_t[]){bias_factor * gates * H}, 1);
+    fill_random(x, 1, 2.0f);
+    fill_random(w, 2, 1.0f);
+    fill_random(b, 3, 0.5f);
+    tensor_set_requires_grad(x, 1);
+    tensor_set_requires_grad(w, 1);
+    tensor_set_requires_grad(b, 1);
+
+    Tensor *out = fn(x, w, b, ret_seq);
+    assert(out != NULL);
+    assert(out->ndim == (ret_seq ? 3u : 2u));
+
+    float *probe = malloc(out->size * sizeof(float));
+    srand(4);
+    for (size_t i = 0; i < out->size; i++) probe[i] = (float)rand() / RAND_MAX - 0.5f;
+
+    out->grad = malloc(out->size * sizeof(float));
+    for (size_t i = 0; i < out->size; i++) out->grad[i] = probe[i];
+    out->backward_fn(out);
+
+    Tensor *params[3] = {x, w, b};
+    float h = 1e-2f;
+    for (size_t p = 0; p < 3; p++) {
+        for (size_t i = 0; i < params[p]->size; i++) {
+            float saved = params[p]->data[i];
+            params[p]->data[i] = saved + h;
+            float up = probe_loss(fn, x, w, b, ret_seq, probe);
+            params[p]->data[i] = saved - h;
+            float down = probe_loss(fn, x, w, b, ret_seq, probe);
+            params[p]->data[i] = saved;
+
+            float numeric = (up - down) / (2.0f * h);
+            assert(fabsf(numeric - params[p]->grad[i]) < 2e-3f);
+        }
+    }
+
+    free(probe);
+    tensor_free(out);
+    tensor_free(x);
+    tensor_free(w);
+    tensor_free(b);
+}
+
+// ====================================================
+// Recurrent Tests
+// ====================================================
+
+TEST(lstm_gradients_sequence) {
+    check_gradients(tensor_lstm, 4, 1, 1);
+}
+
+TEST(lstm_gradients_last) {
+    check_gradients(tensor_lstm, 4, 1, 0);
+}
+
+TEST(gru_gradients_sequence) {
+    check_gradients(tensor_gru, 3, 2, 1);
+}
+
+TEST(gru_gradients_last) {
+    check_gradients(tensor_gru, 3, 2, 0);
+}
+
+TEST(lstm_single_step_values) {
+    // One step with zero state: c = i * g, h = o * tanh(c)
+    Tensor *x = tensor_ones((size_t[]){1, 1, 1}, 3);
+    Tensor *w = tensor_zeroes((size_t[]){2, 4}, 2);
+    Tensor *b = tensor_zeroes((size_t[]){4}, 1);
+    w->data[0] = 1.0f;  // input gate
+    w->data[2] = 0.5f;  // cell candidate
+    w->data[3] = -1.0f; // output gate
+
+    Tensor *out = tensor_lstm(x, w, b, 0);
+    float i = 1.0f / (1.0f + expf(-1.0f));
+    float o = 1.0f / (1.0f + expf(1.0f));
+    ASSERT_FLOAT_EQ(out->data[0], o * tanhf(i * tanhf(0.5f)));
+
+    tensor_free(out);
+    tensor_free(x);
+    tensor_free(w);
+    tensor_free(b);
+}
+
+TEST(recurrent_shape_mismatch) {
+    Tensor *x = tensor_ones((size_t[]){1, 2, 3}, 3);
+    Tensor *w = tensor_zeroes((size_t[]){4, 8}, 2);
+    Tensor *b = tensor_zeroes((size_t[]){8}, 1);
+    assert(tensor_lstm(x, w, b, 1) == NULL);
+    tensor_free(x);
+    tensor_free(w);
+    tensor_free(b);
+}
+
+TEST(lstm_layer_training) {
+    Network *net = network_create();
+    network_add_layer(net, layer_create(LSTM(2, 8, 0)));
+    network_add_layer(net, layer_create(LINEAR(8, 1)));
+    assert(net->num_layers == 2);
+    assert(net->num_parameters == 4);
+
+    // Learn to output the sum of the first feature over the sequence
+    size_t B = 16, T = 5;
+    Tensor *x = tensor_create((size_t[]){B, T, 2}, 3);
+    Tensor *y = tensor_create((size_t[]){B, 1}, 2);
+    fill_random(x, 7, 1.0f);
+    for (size_t b = 0; b < B; b++) {
+        float sum = 0.0f;
+        for (size_t t = 0; t < T; t++) sum += x->data[(b * T + t) * 2];
+        y->data[b] = sum;
+    }
+
+    Optimizer *opt = optimizer_create(net->parameters, net->num_parameters, ADAM(0.02f, 0.9f, 0.999f, 1e-8f));
+    float first = network_train_step(net, x, y, opt, "mse");
+    float last = first;
+    for (int i = 0; i < 200; i++) {
+        last = network_train_step(net, x, y, opt, "mse");
+    }
+    assert(last < first * 0.1f);
+
+    optimizer_free(opt);
+    tensor_free(x);
+    tensor_free(y);
+    network_free(net);
+}
+
+TEST(gru_layer_registered) {
+    Layer *layer = layer_create(GRU(3, 5, 1));
+    assert(layer != NULL);
+    assert(layer->weights->shape[0] == 8 && layer->weights->shape[1] == 15);
+    assert(layer->bias->size == 30);
+
+    Tensor *x = tensor_ones((size_t[]){2, 4, 3}, 3);
+    Tensor *out = layer_forward(layer, x);
+    assert(out->ndim == 3 && out->shape[2] == 5);
+
+    tensor_free(out);
+    tensor_free(x);
+    layer_free(layer);
+}
+
+// ====================================================
+// ====================================================
+
+int main() {
+    printf("=== Running Recurrent Tests ===\n\n");
+
+    basednn_init();
+    basednn_stdlib_init();
+
+    RUN_TEST(lstm_gradients_sequence);
+    RUN_TEST(lstm_gradients_last);
+    RUN_TEST(gru_gradients_sequence);
+    RUN_TEST(gru_gradients_last);
+    RUN_TEST(lstm_single_step_values);
+    RUN_TEST(recurrent_shape_mismatch);
+    RUN_TEST(lstm_layer_training);
+    RUN_TEST(gru_layer_registered);
+
+    basednn_cleanup();
+
+    printf("\n=== All Recurrent Tests Passed! ===\n");
+    return 0;
+}
@@ -0,0 +1,284 @@
+#include "../../include/basednn_stdlib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+
+#define EPSILON 1e-4f
+#define ASSERT_FLOAT_EQ(a, b) assert(fabsf((a) - (b)) < EPSILON)
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { printf("Running %s...\n", #name); test_##name(); printf("  PASSED\n"); } while(0)
+
+// ====================================================
+// Helpers
+// ====================================================
+
+static void fill_random(Tensor *T, unsigned int seed, float scale) {
+    srand(seed);
+    for (size_t i = 0; i < T->size; i++) {
+        T->data[i] = scale * ((float)rand() / RAND_MAX - 0.5f);
+    }
+}
+
+static Tensor* make_labels(size_t B, size_t V, unsigned int seed) {
+    Tensor *labels = tensor_create((size_t[]){B}, 1);
+    srand(seed);
+    for (size_t b = 0; b < B; b++) labels->data[b] = (float)(rand() % V);
+    return labels;
+}
+
+static float full_eval_loss(Layer *layer, Tensor *hidden, Tensor *labels) {
+    Tensor *probs = layer_forward(layer, hidden);
+    size_t V = probs->shape[1];
+    float loss = 0.0f;
+    for (size_t b = 0; b < labels->size; b++) {
+        loss -= logf(probs->data[b * V + (size_t)labels->data[b]]);
+    }
+    tensor_free(probs);
+    return loss / (float)labels->size;
+}
+
+static size_t always_class_zero(const CandidateSampler *self, uint64_t *state) {
+    (void)self;
+    (*state)++;
+    return 0;
+}
+
+static float uniform_log_prob(const CandidateSampler *self, size_t label) {
+    (void)label;
+    return -logf((float)self->num_classes);
+}
+
+// ====================================================
+// Sampler Tests
+// ====================================================
+
+TEST(log_uniform_distribution) {
+    size_t V = 1000;
+    CandidateSampler sampler = LOG_UNIFORM_SAMPLER(V);
+
+    double total = 0.0;
+    for (size_t k = 0; k < V; k++) total += exp(sampler.log_prob(&sampler, k));
+    assert(fabs(total - 1.0) < 1e-4);
+
+    uint64_t state = 7;
+    size_t draws = 20000, zeros = 0;
+    for (size_t i = 0; i < draws; i++) {
+        size_t k = sampler.sample(&sampler, &state);
+        assert(k < V);
+        if (k == 0) zeros++;
+    }
+    float expected = expf(sampler.log_prob(&sampler, 0));
+    assert(fabsf((float)zeros / draws - expected) < 0.01f);
+}
+
+// ====================================================
+// Full Softmax Tests
+// ====================================================
+
+TEST(full_softmax_matches_reference) {
+    size_t B = 3, D = 5, V = 7;
+    Tensor *h = tensor_create((size_t[]){B, D}, 2);
+    Tensor *w = tensor_create((size_t[]){V, D}, 2);
+    Tensor *bias = tensor_create((size_t[]){V}, 1);
+    fill_random(h, 1, 2.0f);
+    fill_random(w, 2, 2.0f);
+    fill_random(bias, 3, 1.0f);
+
+    Tensor *p = tensor_full_softmax(h, w, bias);
+    assert(p != NULL && p->shape[0] == B && p->shape[1] == V);
+
+    for (size_t b = 0; b < B; b++) {
+        float z[7], max_val = -INFINITY, sum = 0.0f;
+        for (size_t k = 0; k < V; k++) {
+            z[k] = bias->data[k];
+            for (size_t d = 0; d < D; d++) z[k] += h->data[b * D + d] * w->data[k * D + d];
+            if (z[k] > max_val) max_val = z[k];
+        }
+        for (size_t k = 0; k < V; k++) sum += expf(z[k] - max_val);
+        for (size_t k = 0; k < V; k++) {
+            ASSERT_FLOAT_EQ(p->data[b * V + k], expf(z[k] - max_val) / sum);
+        }
+    }
+
+    tensor_free(p);
+    tensor_free(h);
+    tensor_free(w);
+    tensor_free(bias);
+}
+
+TEST(full_softmax_gradients) {
+    size_t B = 2, D = 3, V = 4;
+    Tensor *h = tensor_create((size_t[]){B, D}, 2);
+    Tensor *w = tensor_create((size_t[]){V, D}, 2);
+    Tensor *bias = tensor_create((size_t[]){V}, 1);
+    fill_random(h, 4, 2.0f);
+    fill_random(w, 5, 2.0f);
+    fill_random(bias, 6, 1.0f);
+    tensor_set_requires_grad(h, 1);
+    tensor_set_requires_grad(w, 1);
+    tensor_set_requires_grad(bias, 1);
+
+    float probe[8];
+    srand(7);
+    for (size_t i = 0; i < B * V; i++) probe[i] = (float)rand() / RAND_MAX - 0.5f;
+
+    Tensor *p = tensor_full_softmax(h, w, bias);
+    p->grad = malloc(p->size * sizeof(float));
+    for (size_t i = 0; i < p->size; i++) p->grad[i] = probe[i];
+    p->backward_fn(p);
+
+    Tensor *params[3] = {h, w, bias};
+    float eps = 1e-2f;
+    for (size_t t = 0; t < 3; t++) {
+        for (size_t i = 0; i < params[t]->size; i++) {
+            float saved = params[t]->data[i];
+            float loss[2];
+            for (int side = 0; side < 2; side++) {
+                params[t]->data[i] = saved + (side ? -eps : eps);
+                Tensor *q = tensor_full_softmax(h, w, bias);
+                loss[side] = 0.0f;
+                for (size_t j = 0; j < q->size; j++) loss[side] += q->data[j] * probe[j];
+                tensor_free(q);
+            }
+            params[t]->data[i] = saved;
+            assert(fabsf((loss[0] - loss[1]) / (2.0f * eps) - params[t]->grad[i]) < 2e-3f);
+        }
+    }
+
+    tensor_free(p);
+    tensor_free(h);
+    tensor_free(w);
+    tensor_free(bias);
+}
+
+// ====================================================
+// Sampled Loss Tests
+// ====================================================
+
+TEST(sampled_loss_gradients) {
+    size_t B = 3, D = 4, V = 20, S = 6;
+    Tensor *h = tensor_create((size_t[]){B, D}, 2);
+    Tensor *w = tensor_create((size_t[]){V, D}, 2);
+    Tensor *bias = tensor_create((size_t[]){V}, 1);
+    Tensor *labels = make_labels(B, V, 8);
+    fill_random(h, 9, 2.0f);
+    fill_random(w, 10, 2.0f);
+    fill_random(bias, 11, 1.0f);
+    tensor_set_requires_grad(h, 1);
+    tensor_set_requires_grad(w, 1);
+    tensor_set_requires_grad(bias, 1);
+
+    CandidateSampler sampler = LOG_UNIFORM_SAMPLER(V);
+    uint64_t seed = 12, state = seed;
+    Tensor *loss = tensor_sampled_softmax_loss(h, w, bias, labels, S, &sampler, &state);
+    assert(loss != NULL && loss->data[0] > 0.0f);
+    assert(state != seed);
+    tensor_backward(loss);
+
+    // Re-running from the same seed draws the same negatives
+    Tensor *params[3] = {h, w, bias};
+    float eps = 1e-2f;
+    for (size_t t = 0; t < 3; t++) {
+        for (size_t i = 0; i < params[t]->size; i++) {
+            float saved = params[t]->data[i];
+            float value[2];
+            for (int side = 0; side < 2; side++) {
+                params[t]->data[i] = saved + (side ? -eps : eps);
+                state = seed;
+                Tensor *l = tensor_sampled_softmax_loss(h, w, bias, labels, S, &sampler, &state);
+                value[side] = l->data[0];
+                tensor_free(l);
+            }
+            params[t]->data[i] = saved;
+            assert(fabsf((value[0] - value[1]) / (2.0f * eps) - params[t]->grad[i]) < 2e-3f);
+        }
+    }
+
+    tensor_free(loss);
+    tensor_free(labels);
+    tensor_free(h);
+    tensor_free(w);
+    tensor_free(bias);
+}
+
+TEST(sampled_loss_masks_accidental_hits) {
+    size_t B = 2, D = 3, V = 4;
+    Tensor *h = tensor_create((size_t[]){B, D}, 2);
+    Tensor *w = tensor_create((size_t[]){V, D}, 2);
+    Tensor *labels = tensor_zeroes((size_t[]){B}, 1);
+    fill_random(h, 13, 2.0f);
+    fill_random(w, 14, 2.0f);
+
+    // Every negative equals the label, so the loss collapses to -log(1)
+    CandidateSampler sampler = { V, always_class_zero, uniform_log_prob, NULL };
+    uint64_t state = 0;
+    Tensor *loss = tensor_sampled_softmax_loss(h, w, NULL, labels, 5, &sampler, &state);
+    assert(loss != NULL);
+    ASSERT_FLOAT_EQ(loss->data[0], 0.0f);
+    assert(state == 5);
+
+    labels->data[1] = (float)V;
+    assert(tensor_sampled_softmax_loss(h, w, NULL, labels, 5, &sampler, &state) == NULL);
+
+    tensor_free(loss);
+    tensor_free(labels);
+    tensor_free(h);
+    tensor_free(w);
+}
+
+TEST(sampled_softmax_layer_training) {
+    size_t B = 32, D = 8, V = 50;
+    Layer *layer = layer_create(SAMPLEDSOFTMAX(D, V, 10));
+    assert(layer != NULL && layer->weights->shape[0] == V);
+    for (size_t i = 0; i < layer->num_parameters; i++) {
+        tensor_set_requires_grad(layer->parameters[i], 1);
+    }
+
+    Tensor *h = tensor_create((size_t[]){B, D}, 2);
+    Tensor *labels = make_labels(B, V, 15);
+    fill_random(h, 16, 4.0f);
+
+    Optimizer *opt = optimizer_create(layer->parameters, layer->num_parameters, ADAM(0.05f, 0.9f, 0.999f, 1e-8f));
+    float before = full_eval_loss(layer, h, labels);
+
+    uint64_t state = 17;
+    for (int step = 0; step < 200; step++) {
+        Tensor *loss = layer_sampled_softmax_loss(layer, h, labels, NULL, &state);
+        assert(loss != NULL);
+        layer_zero_grad(layer);
+        tensor_backward(loss);
+        optimizer_step(opt);
+        tensor_free(loss);
+    }
+
+    float after = full_eval_loss(layer, h, labels);
+    assert(after < before * 0.5f);
+
+    optimizer_free(opt);
+    tensor_free(labels);
+    tensor_free(h);
+    layer_free(layer);
+}
+
+// ====================================================
+// ====================================================
+
+int main() {
+    printf("=== Running Sampled Softmax Tests ===\n\n");
+
+    basednn_init();
+    basednn_stdlib_init();
+
+    RUN_TEST(log_uniform_distribution);
+    RUN_TEST(full_softmax_matches_reference);
+    RUN_TEST(full_softmax_gradients);
+    RUN_TEST(sampled_loss_gradients);
+    RUN_TEST(sampled_loss_masks_accidental_hits);
+    RUN_TEST(sampled_softmax_layer_training);
+
+    basednn_cleanup();
+
+    printf("\n=== All Sampled Softmax Tests Passed! ===\n");
+    return 0;
+}